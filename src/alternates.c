@@ -0,0 +1,263 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-19
+ */
+/*!~ @note realpath is posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
+#include "alternates.h"
+
+/*! @uses calloc, free, realpath. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strncmp, strlen, memcmp. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses pthread_once_t, pthread_once. */
+#include <pthread.h>
+
+/*! @uses stat, S_ISDIR. */
+#include <sys/stat.h>
+
+/*! @uses access, F_OK. */
+#include <unistd.h>
+
+/*! @uses inw_walk, inode_t. */
+#include "inw.h"
+
+/*! @uses freadls, fexistpd, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/* the alternates of the repository, read once per process. */
+internal dyna_t* alternates = 0x0;
+internal pthread_once_t alternates_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief read the alternate object stores of the repository.
+ *
+ * @return a dynamic array of allocated absolute paths (empty if there are none).
+ */
+dyna_t*
+read_alternates() {
+    dyna_t* array = dyna_create();
+    FILE* f = fopen(ALTERNATES_PATH, "r");
+    if (!f)
+        return array;
+    size_t n = 0;
+    char** lines = freadls(f, &n);
+    fclose(f);
+    for (size_t i = 0; i < n; i++) {
+        if (lines[i][0]) dyna_push(array, lines[i]);
+        else free(lines[i]);
+    }
+    free(lines);
+    return array;
+}
+
+/**
+ * @brief read the alternates of the repository (once).
+ */
+internal void
+load_alternates(void) {
+    alternates = read_alternates();
+}
+
+/**
+ * @brief add an object store to the alternates of the repository (once).
+ *
+ * @param store the path of the object store (its '.lit/objects' directory).
+ * @return true if the store exists and is an alternate of the repository.
+ */
+bool
+add_alternate(const char* store) {
+    /* assert on the store. */
+    assert(store != 0x0);
+
+    /* the store is kept by its absolute path, and cannot be the local store. */
+    struct stat st;
+    char* absolute = realpath(store, 0x0), *local = realpath(OBJECTS_PATH, 0x0);
+    if (!absolute || stat(absolute, &st) != 0 || !S_ISDIR(st.st_mode) || \
+        (local && !strcmp(absolute, local))) {
+        llog(E_LOGGER_LEVEL_ERROR, "\'%s\' is not an object store.\n", store);
+        free(absolute);
+        free(local);
+        return false;
+    }
+    free(local);
+
+    /* append it, unless it is already there. */
+    dyna_t* current = read_alternates();
+    bool found = false;
+    _foreach(current, char*, alternate)
+        if (!strcmp(alternate, absolute)) found = true;
+        free(alternate);
+    _endforeach;
+    dyna_free(current);
+    if (!found) {
+        if (fexistpd(ALTERNATES_PATH) == -1) {
+            llog(E_LOGGER_LEVEL_ERROR, "fexistpd failed; could not create parent directories.\n");
+            exit(EXIT_FAILURE);
+        }
+        FILE* f = fopen(ALTERNATES_PATH, "a");
+        if (!f) {
+            llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open alternates for writing.\n");
+            exit(EXIT_FAILURE);
+        }
+        fprintf(f, "%s\n", absolute);
+        fclose(f);
+    }
+    free(absolute);
+    return true;
+}
+
+/**
+ * @brief open an object for reading; the local store first, then each alternate store in order
+ *  (the alternates are read once per process).
+ *
+ * @param path the path of the object in the local store ('.lit/objects/...').
+ * @return the opened file, or 0x0 if the object is in none of the stores.
+ */
+FILE*
+fopen_object(const char* path) {
+    /* assert on the path. */
+    assert(path != 0x0);
+    FILE* f = fopen(path, "r");
+    size_t length = strlen(OBJECTS_PATH);
+    if (f || strncmp(path, OBJECTS_PATH, length))
+        return f;
+
+    /* the same relative path in each of the alternates. */
+    pthread_once(&alternates_once, load_alternates);
+    _foreach(alternates, const char*, alternate)
+        char fallback[1024];
+        snprintf(fallback, 1024, "%s%s", alternate, path + length);
+        if ((f = fopen(fallback, "r")))
+            return f;
+    _endforeach;
+    return 0x0;
+}
+
+/**
+ * @brief check if two files have the same content.
+ *
+ * @param a the path of the first file.
+ * @param b the path of the second file.
+ * @return true if both files exist and have the same content.
+ */
+internal bool
+same_content(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb"), *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    char ba[4096], bb[4096];
+    while (same) {
+        size_t na = fread(ba, 1, sizeof ba, fa), nb = fread(bb, 1, sizeof bb, fb);
+        if (na != nb || memcmp(ba, bb, na)) same = false;
+        if (na == 0) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+/**
+ * @brief move an object into the shared store; renamed if both are on the same filesystem,
+ *  otherwise copied in under a temporary name first (so that no repository reading the store sees
+ *  half of it) and then removed locally.
+ *
+ * @param from the path of the local object.
+ * @param to the path of the object in the shared store.
+ * @return true if the object was moved.
+ */
+internal bool
+move_object(const char* from, const char* to) {
+    if (fexistpd(to) == -1)
+        return false;
+    if (rename(from, to) == 0)
+        return true;
+
+    /* across filesystems. */
+    char temporary[1040];
+    snprintf(temporary, 1040, "%s.tmp", to);
+    FILE* in = fopen(from, "rb"), *out = in ? fopen(temporary, "wb") : 0x0;
+    bool copied = in && out;
+    char buffer[8192];
+    for (size_t n; copied && (n = fread(buffer, 1, sizeof buffer, in)) > 0;)
+        copied = fwrite(buffer, 1, n, out) == n;
+    if (in) fclose(in);
+    if (out && fclose(out) != 0) copied = false;
+    if (!copied || rename(temporary, to) != 0) {
+        remove(temporary);
+        return false;
+    }
+    return remove(from) == 0;
+}
+
+/**
+ * @brief move the local objects into an object store shared by repositories, the store is added
+ *  to the alternates first so that they can still be read.
+ *
+ * @param store the path of the shared object store (created if it does not exist).
+ * @param moved pointer to store the number of objects moved into the store.
+ * @param removed pointer to store the number of objects the store already held.
+ * @return true if the store could be used.
+ */
+bool
+dedup_objects(const char* store, size_t* moved, size_t* removed) {
+    /* assert on the store and the counts. */
+    assert(store != 0x0);
+    assert(moved != 0x0);
+    assert(removed != 0x0);
+    *moved = *removed = 0;
+
+    /* the store cannot be the objects of a repository; clear-cache there would remove the objects
+     *  only the other repositories reference. */
+    char probe[1024];
+    snprintf(probe, 1024, "%s/", store);
+    if (fexistpd(probe) == -1) {
+        llog(E_LOGGER_LEVEL_ERROR, "fexistpd failed; could not create '%s'.\n", store);
+        return false;
+    }
+    char* absolute = realpath(store, 0x0);
+    size_t length = absolute ? strlen(absolute) : 0, suffix = strlen("/" OBJECTS_PATH);
+    if (!absolute || (length >= suffix && !strcmp(absolute + length - suffix, "/" OBJECTS_PATH))) {
+        llog(E_LOGGER_LEVEL_ERROR, "'%s' is the object store of a repository, not a shared one"
+            ".\n", store);
+        free(absolute);
+        return false;
+    }
+    if (!add_alternate(absolute)) {
+        free(absolute);
+        return false;
+    }
+
+    /* only the commits and diffs are content addressed, shelved changes stay local; an object the
+     *  store holds with other content (a collision) stays local as well. */
+    const char* kinds[] = { OBJECTS_PATH "/commits", OBJECTS_PATH "/diffs" };
+    length = strlen(OBJECTS_PATH);
+    for (size_t k = 0; k < 2; k++) {
+        dyna_t* inodes = inw_walk(kinds[k], E_INW_TYPE_RECURSE);
+        _foreach(inodes, inode_t*, inode)
+            char shared[1024];
+            snprintf(shared, 1024, "%s%s", absolute, inode->path + length);
+            if (inode->type == E_INODE_TYPE_FILE) {
+                if (access(shared, F_OK) != 0) {
+                    if (move_object(inode->path, shared))
+                        (*moved)++;
+                }
+                else if (same_content(inode->path, shared) && remove(inode->path) == 0)
+                    (*removed)++;
+            }
+            free(inode->path);
+            free(inode->name);
+            free(inode);
+        _endforeach;
+        dyna_free(inodes);
+    }
+    free(absolute);
+    return true;
+}
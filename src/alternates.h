@@ -0,0 +1,62 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-19
+ */
+#ifndef ALTERNATES_H
+#define ALTERNATES_H
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses dyna_t. */
+#include "dyna.h"
+
+/*!~ @note the local object store, and the file listing the read-only object stores it falls back
+ *  to, one absolute path per line (new objects are always written to the local store). */
+#define OBJECTS_PATH ".lit/objects"
+#define ALTERNATES_PATH ".lit/objects/info/alternates"
+
+/**
+ * @brief read the alternate object stores of the repository.
+ *
+ * @return a dynamic array of allocated absolute paths (empty if there are none).
+ */
+dyna_t*
+read_alternates();
+
+/**
+ * @brief add an object store to the alternates of the repository (once).
+ *
+ * @param store the path of the object store (its '.lit/objects' directory).
+ * @return true if the store exists and is an alternate of the repository.
+ */
+bool
+add_alternate(const char* store);
+
+/**
+ * @brief open an object for reading; the local store first, then each alternate store in order
+ *  (the alternates are read once per process).
+ *
+ * @param path the path of the object in the local store ('.lit/objects/...').
+ * @return the opened file, or 0x0 if the object is in none of the stores.
+ */
+FILE*
+fopen_object(const char* path);
+
+/**
+ * @brief move the local objects into an object store shared by repositories, the store is added
+ *  to the alternates first so that they can still be read; the objects it already holds byte for
+ *  byte are removed locally. no repository collects the store (clear-cache only walks its own
+ *  objects), so it cannot be the objects directory of a repository.
+ *
+ * @param store the path of the shared object store (created if it does not exist).
+ * @param moved pointer to store the number of objects moved into the store.
+ * @param removed pointer to store the number of objects the store already held.
+ * @return true if the store could be used.
+ */
+bool
+dedup_objects(const char* store, size_t* moved, size_t* removed);
+#endif /* ALTERNATES_H */
@@ -55,8 +55,19 @@ void help_args() {
            "usage: lit [-v | version] [-h | help] [-i | init] [-c | commit]\n"
            "\t[-r | rollback <hash>] [-C | -checkout <hash>] [-l | log] [-sB | switch-branch <name>]\n"
            "\t[-dB | delete-branch <name>] [-aB | add-branch <name>] [-rB | rebase-branch <src> <dest>]\n"
+           "\t[-rA | rebase-all --onto <base> [names...]] [-S | show <commit>:<path>]\n"
+           "\t[-D | diff <commit> <commit>] [-bS | bisect <good> <bad> run <cmd>]\n"
+           "\t[-A | archive <commit> [-o <file>]] [-eT | export-tree <commit> <dir>]\n"
+           "\t[-sp | sparse [set <prefix>... | disable]] [-wT | worktree [add <dir> <branch>]]\n"
+           "\t[-aL | alternates [add <store>]] [-dO | dedup <store>]\n"
+           "\t[-pU | push <upstream> [branch]] [-pL | pull <upstream> [branch]]\n"
+           "\t[-sV | server <root> <socket> [cache-MiB]]\n"
+           "\t[-cL | clone <src> <dir> [--depth <n>]]\n"
+           "\t[-bU | bundle create <file> <branch> [--since <commit>] | unbundle <file>]\n"
+           "\t[-fI | fast-import] [-fE | fast-export [branch...]]\n"
            "\t[-a | add <path>] [-d <hash>| delete <path>] \n"
-           "\t[-aT | add-tag <hash> <name> ] [-dT | delete-tag <name>] [-cc | clear-cache]\n\n");
+           "\t[-aT | add-tag <hash> <name> ] [-dT | delete-tag <name>] [-pR | pack-refs]\n"
+           "\t[-cc | clear-cache]\n\n");
 
     /* print out the options to the user. (disable warnings in ~/.lit/config with disable_warnings=1) */
     llog(E_LOGGER_LEVEL_INFO,
@@ -68,13 +79,35 @@ void help_args() {
            "\t-c | commit\t\t\tcommit changes to the repository.\n\n"
            "\t-r | rollback <hash>\t\t*rollback to a previous commit.\n"
            "\t-C | checkout <hash>\t\t*checkout a newer commit.\n"
-           "\t-l | log\t\t\tlog data from the repository.\n\n"
+           "\t-l | log [-- <path>...]\t\tlog data from the repository (changing a path).\n"
+           "\t-S | show <commit>:<path>\tprint a file as it was at a commit.\n"
+           "\t-D | diff <commit> <commit>\tprint the changes between two commits.\n"
+           "\t-bS | bisect <good> <bad> run <cmd> find the first commit where <cmd> fails.\n"
+           "\t-A | archive <commit> [-o <file>] write the files at a commit as a tar stream.\n"
+           "\t-eT | export-tree <commit> <dir> write the files at a commit into a new directory.\n"
+           "\t-sp | sparse [set <prefix>...]\tonly check out the paths under the prefixes (or list them).\n"
+           "\t-sp | sparse disable\t\tcheck out every path again.\n"
+           "\t-wT | worktree add <dir> <branch> check out a branch into a new worktree.\n"
+           "\t-wT | worktree [list]\t\tlist the worktrees of the repository.\n"
+           "\t-aL | alternates [add <store>]\tread objects from another store (or list them).\n"
+           "\t-dO | dedup <store>\t\tmove the objects into a store shared by repositories.\n"
+           "\t-pU | push <upstream> [branch]\tsend the new commits of a branch to an upstream.\n"
+           "\t-pL | pull <upstream> [branch]\tfetch the new commits of a branch from an upstream.\n"
+           "\t-sV | server <root> <socket>\thost the repositories under <root> ('<socket>:<name>').\n"
+           "\t-cL | clone <src> <dir>\t\tclone a repository, hardlinking its objects.\n"
+           "\t-cL | clone --depth <n>\t\tclone only the last <n> commits of the active branch.\n"
+           "\t-bU | bundle create <file> <branch> write a branch (after --since <commit>) into a bundle.\n"
+           "\t-bU | bundle unbundle <file>\tverify a bundle and import its branch.\n"
+           "\t-fI | fast-import\t\timport a git fast-export stream from stdin.\n"
+           "\t-fE | fast-export [branch...]\twrite branches (all of them) as a fast-import stream.\n\n"
            "\t-aB | add-branch <name>\t\tcreate a new branch.\n"
            "\t-sB | switch-branch <name>\tswitch to a branch.\n"
            "\t-rB | rebase-branch <src> <dst> rebase a branch onto another.\n"
+           "\t-rA | rebase-all --onto <base>\trebase every (or each named) branch onto a base.\n"
            "\t-dB | delete-branch <name>\tdelete a branch.\n\n"
            "\t-aT | add-tag <hash> <name>\tadd a tag to a commit.\n"
-           "\t-dT | delete-tag <name>\t\tdelete a tag.\n\n"
+           "\t-dT | delete-tag <name>\t\tdelete a tag.\n"
+           "\t-pR | pack-refs\t\t\tpack every tag into a single sorted file.\n\n"
            "\t-cc | clear-cache\tclear any cache leftover from previous operations.\n\n"
            "any option with an asterisk (*) can produce a warning in stdout, to remove\n"
            " set disable_warnings=1 in configuration file at, \'~/.lit/config\'\n"
@@ -187,6 +220,14 @@ parse_arguments(int argc, char** argv) {
             expected_parameter_argument(2);
             goto _push;
         }
+        if (!strcmp(cli_arg, "-rA") || !strcmp(cli_arg, "rebase-all")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_REBASE_ALL;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(2);
+            goto _push;
+        }
         if (!strcmp(cli_arg, "-dB") || !strcmp(cli_arg, "delete-branch")) {
             check_if_proper_already_captured();
             parsed_arg->type = E_PROPER_ARGUMENT;
@@ -195,6 +236,160 @@ parse_arguments(int argc, char** argv) {
             expected_parameter_argument(1);
             goto _push;
         }
+        if (!strcmp(cli_arg, "-S") || !strcmp(cli_arg, "show")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_SHOW;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-D") || !strcmp(cli_arg, "diff")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_DIFF;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(2);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-bS") || !strcmp(cli_arg, "bisect")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_BISECT;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(4);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-A") || !strcmp(cli_arg, "archive")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_ARCHIVE;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-eT") || !strcmp(cli_arg, "export-tree")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_EXPORT_TREE;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(2);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-sp") || !strcmp(cli_arg, "sparse")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_SPARSE;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-wT") || !strcmp(cli_arg, "worktree")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_WORKTREE;
+            add_value_to_parsed_argument();
+
+            /* the mode is a parameter, even though 'add' is a proper argument of its own. */
+            if (i + 1 < (size_t)argc && !strcmp(argv[i + 1], "add")) {
+                dyna_push(array, parsed_arg);
+                cli_arg = argv[++i];
+                parsed_arg = calloc(1, sizeof(argument_t));
+                parsed_arg->type = E_PARAMETER_TO_ARGUMENT;
+                add_value_to_parsed_argument();
+                expected_parameter_argument(2);
+            }
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-aL") || !strcmp(cli_arg, "alternates")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_ALTERNATES;
+            add_value_to_parsed_argument();
+
+            /* the mode is a parameter, even though 'add' is a proper argument of its own. */
+            if (i + 1 < (size_t)argc && !strcmp(argv[i + 1], "add")) {
+                dyna_push(array, parsed_arg);
+                cli_arg = argv[++i];
+                parsed_arg = calloc(1, sizeof(argument_t));
+                parsed_arg->type = E_PARAMETER_TO_ARGUMENT;
+                add_value_to_parsed_argument();
+                expected_parameter_argument(1);
+            }
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-dO") || !strcmp(cli_arg, "dedup")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_DEDUP;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-pU") || !strcmp(cli_arg, "push")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_PUSH;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-pL") || !strcmp(cli_arg, "pull")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_PULL;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-sV") || !strcmp(cli_arg, "server")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_SERVER;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-cL") || !strcmp(cli_arg, "clone")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_CLONE;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(2);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-bU") || !strcmp(cli_arg, "bundle")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_BUNDLE;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(2);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-fI") || !strcmp(cli_arg, "fast-import")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_FAST_IMPORT;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-fE") || !strcmp(cli_arg, "fast-export")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_FAST_EXPORT;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "serve-upstream")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_SERVE_UPSTREAM;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-pR") || !strcmp(cli_arg, "pack-refs")) {
+            check_if_proper_already_captured();
+            parsed_arg->type = E_PROPER_ARGUMENT;
+            parsed_arg->details.proper = E_PROPER_ARG_PACK_REFS;
+            add_value_to_parsed_argument();
+            goto _push;
+        }
         if (!strcmp(cli_arg, "-cc") || !strcmp(cli_arg, "clear-cache")) {
             check_if_proper_already_captured();
             parsed_arg->type = E_PROPER_ARGUMENT;
@@ -296,6 +491,41 @@ parse_arguments(int argc, char** argv) {
             expected_parameter_argument(1);
             goto _push;
         }
+        if (!strcmp(cli_arg, "--onto")) {
+            parsed_arg->type = E_FLAG_TO_ARGUMENT;
+            parsed_arg->details.flag = E_FLAG_ARG_ONTO;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "--")) {
+            parsed_arg->type = E_FLAG_TO_ARGUMENT;
+            parsed_arg->details.flag = E_FLAG_ARG_PATHS;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "--since")) {
+            parsed_arg->type = E_FLAG_TO_ARGUMENT;
+            parsed_arg->details.flag = E_FLAG_ARG_SINCE;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "--depth")) {
+            parsed_arg->type = E_FLAG_TO_ARGUMENT;
+            parsed_arg->details.flag = E_FLAG_ARG_DEPTH;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
+        if (!strcmp(cli_arg, "-o") || !strcmp(cli_arg, "--output")) {
+            parsed_arg->type = E_FLAG_TO_ARGUMENT;
+            parsed_arg->details.flag = E_FLAG_ARG_OUTPUT;
+            add_value_to_parsed_argument();
+            expected_parameter_argument(1);
+            goto _push;
+        }
         if (!strcmp(cli_arg, "--tag")) {
             parsed_arg->type = E_FLAG_TO_ARGUMENT;
             parsed_arg->details.flag = E_FLAG_ARG_TAG;
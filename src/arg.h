@@ -32,6 +32,25 @@ typedef enum {
     E_PROPER_ARG_RESTORE = 0xf, /* restore the entire branch. */
     E_PROPER_ARG_ADD_TAG = 0x10, /* add a tag for a commit. */
     E_PROPER_ARG_DELETE_TAG = 0x11, /* delete a tag for a commit. */
+    E_PROPER_ARG_REBASE_ALL = 0x12, /* rebase many branches onto a base. */
+    E_PROPER_ARG_PACK_REFS = 0x13, /* pack every tag into the packed refs. */
+    E_PROPER_ARG_SHOW = 0x14, /* show a file at a commit. */
+    E_PROPER_ARG_DIFF = 0x15, /* show the changes between two commits. */
+    E_PROPER_ARG_BISECT = 0x16, /* find the first bad commit between two commits. */
+    E_PROPER_ARG_ARCHIVE = 0x17, /* write the tree of a commit as a tar stream. */
+    E_PROPER_ARG_EXPORT_TREE = 0x18, /* write the tree of a commit into a new directory. */
+    E_PROPER_ARG_SPARSE = 0x19, /* list, set or disable the sparse checkout prefixes. */
+    E_PROPER_ARG_WORKTREE = 0x1a, /* add or list the worktrees of the repository. */
+    E_PROPER_ARG_ALTERNATES = 0x1b, /* add or list the alternate object stores. */
+    E_PROPER_ARG_DEDUP = 0x1c, /* move the local objects into a shared object store. */
+    E_PROPER_ARG_PUSH = 0x1d, /* send a branch to an upstream. */
+    E_PROPER_ARG_PULL = 0x1e, /* fetch a branch from an upstream. */
+    E_PROPER_ARG_SERVE_UPSTREAM = 0x1f, /* serve an upstream request on stdin. */
+    E_PROPER_ARG_SERVER = 0x20, /* host the repositories under a directory on a unix socket. */
+    E_PROPER_ARG_CLONE = 0x21, /* clone a repository on the same host into a new directory. */
+    E_PROPER_ARG_BUNDLE = 0x22, /* write a branch into a bundle file, or import one. */
+    E_PROPER_ARG_FAST_IMPORT = 0x23, /* import a git fast-export stream from stdin. */
+    E_PROPER_ARG_FAST_EXPORT = 0x24, /* write branches as a git fast-import stream to stdout. */
 } e_proper_arg_ty_t;
 
 /**
@@ -52,6 +71,11 @@ typedef enum {
     E_FLAG_ARG_FROM = 0x8, /* --from flag for creation of a branch. */
     E_FLAG_ARG_MESSAGE = 0x9, /* --m | ch--message flag for creation of a commit. */
     E_FLAG_ARG_TAG = 0xa, /* --tag flag for rollback/checkout. */
+    E_FLAG_ARG_ONTO = 0xb, /* --onto flag for rebase-all with a proceeding branch name. */
+    E_FLAG_ARG_PATHS = 0xc, /* -- flag for log with proceeding paths. */
+    E_FLAG_ARG_OUTPUT = 0xd, /* -o | --output flag for archive with a proceeding file name. */
+    E_FLAG_ARG_DEPTH = 0xe, /* --depth flag for a shallow clone with a proceeding integer. */
+    E_FLAG_ARG_SINCE = 0xf, /* --since flag for an incremental bundle with a proceeding commit. */
 } e_flag_arg_ty_t;
 
 /**
@@ -0,0 +1,155 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-14
+ */
+#include "bloom.h"
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses strlen, memcpy. */
+#include <string.h>
+
+/*! @uses snprintf. */
+#include <stdio.h>
+
+/*! @uses crc32. */
+#include "hash.h"
+
+/*! @uses internal, strtoha. */
+#include "utl.h"
+
+/**
+ * @brief normalize a path for matching; a leading './' and any trailing '/' are ignored.
+ *
+ * @param path the path to be normalized.
+ * @param length pointer to store the length of the normalized path.
+ * @return a pointer to the start of the normalized path (within <path>).
+ */
+const char*
+bloom_normalize(const char* path, size_t* length) {
+    /* assert on the path. */
+    assert(path != 0x0);
+    while (path[0] == '.' && path[1] == '/')
+        path += 2;
+    *length = strlen(path);
+    while (*length > 0 && path[*length - 1] == '/')
+        (*length)--;
+    return path;
+}
+
+/**
+ * @brief compute the bit positions of a key, using double hashing (fnv-1a and crc32).
+ *
+ * @param key the start of the key.
+ * @param length the length of the key.
+ * @param positions array to store the BLOOM_PROBES bit positions.
+ */
+internal void
+bloom_positions(const char* key, size_t length, size_t positions[BLOOM_PROBES]) {
+    /* @ref[http://www.isthe.com/chongo/tech/comp/fnv/] */
+    unsigned int h1 = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        h1 ^= (unsigned char) key[i];
+        h1 *= 16777619u;
+    }
+    unsigned int h2 = crc32((const unsigned char*) key, length) | 1u;
+    for (size_t i = 0; i < BLOOM_PROBES; i++)
+        positions[i] = (h1 + (unsigned int) i * h2) % (BLOOM_BYTES * 8u);
+}
+
+/**
+ * @brief add a single key to a bloom filter.
+ *
+ * @param bloom the bloom filter.
+ * @param key the start of the key.
+ * @param length the length of the key.
+ */
+internal void
+bloom_add(bloom_t* bloom, const char* key, size_t length) {
+    size_t positions[BLOOM_PROBES];
+    bloom_positions(key, length, positions);
+    for (size_t i = 0; i < BLOOM_PROBES; i++)
+        bloom->bits[positions[i] / 8u] |= (unsigned char) (1u << (positions[i] % 8u));
+}
+
+/**
+ * @brief add a path and every one of its parent directories to a bloom filter.
+ *
+ * @param bloom the bloom filter.
+ * @param path the path to be added.
+ */
+void
+bloom_add_path(bloom_t* bloom, const char* path) {
+    /* assert on the bloom filter and path. */
+    assert(bloom != 0x0);
+    assert(path != 0x0);
+
+    /* add the path, then each prefix ending right before a '/'. */
+    size_t length = 0;
+    path = bloom_normalize(path, &length);
+    if (length == 0)
+        return;
+    bloom_add(bloom, path, length);
+    for (size_t i = length; i > 0; i--)
+        if (path[i - 1] == '/' && i > 1)
+            bloom_add(bloom, path, i - 1);
+}
+
+/**
+ * @brief test if a path (or a directory) may be in a bloom filter.
+ *
+ * @param bloom the bloom filter.
+ * @param path the path to be tested.
+ * @return false if the path is definitely not in the filter, true if it may be.
+ */
+bool
+bloom_test(const bloom_t* bloom, const char* path) {
+    /* assert on the bloom filter and path. */
+    assert(bloom != 0x0);
+    assert(path != 0x0);
+
+    /* every bit of the key must be set. */
+    size_t length = 0, positions[BLOOM_PROBES];
+    path = bloom_normalize(path, &length);
+    bloom_positions(path, length, positions);
+    for (size_t i = 0; i < BLOOM_PROBES; i++)
+        if (!(bloom->bits[positions[i] / 8u] & (1u << (positions[i] % 8u))))
+            return false;
+    return true;
+}
+
+/**
+ * @brief convert a bloom filter to a hex string representation.
+ *
+ * @param bloom the bloom filter.
+ * @return an allocated hex string.
+ */
+char*
+strbloom(const bloom_t* bloom) {
+    /* assert on the bloom filter. */
+    assert(bloom != 0x0);
+    char* str = calloc(1, BLOOM_BYTES * 2 + 1);
+    for (size_t i = 0; i < BLOOM_BYTES; i++)
+        snprintf(str + i * 2, 3, "%02x", bloom->bits[i]);
+    return str;
+}
+
+/**
+ * @brief convert a hex string representation back into a bloom filter.
+ *
+ * @param str the hex string.
+ * @param bloom the bloom filter to be filled.
+ */
+void
+strtobloom(const char* str, bloom_t* bloom) {
+    /* assert on the string and the bloom filter. */
+    assert(str != 0x0);
+    assert(bloom != 0x0);
+    unsigned char* bits = strtoha(str, BLOOM_BYTES);
+    memcpy(bloom->bits, bits, BLOOM_BYTES);
+    free(bits);
+}
@@ -0,0 +1,75 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-14
+ */
+#ifndef BLOOM_H
+#define BLOOM_H
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*!~ @note the size (in bytes) of the bloom filter of a commit, and the number of bits set per path;
+ *  small enough to live in the commit header, commits that change a lot of paths simply answer
+ *  'maybe' more often. */
+#define BLOOM_BYTES 32
+#define BLOOM_PROBES 4
+
+/**
+ * a data structure for a bloom filter of paths; a set that can answer "definitely not in the
+ *  set" or "maybe in the set", used to skip commits that did not change a path without reading
+ *  any of their diffs.
+ */
+typedef struct {
+    unsigned char bits[BLOOM_BYTES]; /* the bits of the filter. */
+} bloom_t;
+
+/**
+ * @brief add a path and every one of its parent directories to a bloom filter.
+ *
+ * @param bloom the bloom filter.
+ * @param path the path to be added.
+ */
+void
+bloom_add_path(bloom_t* bloom, const char* path);
+
+/**
+ * @brief test if a path (or a directory) may be in a bloom filter.
+ *
+ * @param bloom the bloom filter.
+ * @param path the path to be tested.
+ * @return false if the path is definitely not in the filter, true if it may be.
+ */
+bool
+bloom_test(const bloom_t* bloom, const char* path);
+
+/**
+ * @brief convert a bloom filter to a hex string representation.
+ *
+ * @param bloom the bloom filter.
+ * @return an allocated hex string.
+ */
+char*
+strbloom(const bloom_t* bloom);
+
+/**
+ * @brief convert a hex string representation back into a bloom filter.
+ *
+ * @param str the hex string.
+ * @param bloom the bloom filter to be filled.
+ */
+void
+strtobloom(const char* str, bloom_t* bloom);
+
+/**
+ * @brief normalize a path for matching; a leading './' and any trailing '/' are ignored.
+ *
+ * @param path the path to be normalized.
+ * @param length pointer to store the length of the normalized path.
+ * @return a pointer to the start of the normalized path (within <path>).
+ */
+const char*
+bloom_normalize(const char* path, size_t* length);
+#endif /* BLOOM_H */
@@ -2,6 +2,8 @@
  * @author Sean Hobeck
  * @date 2026-01-06
  */
+/*!~ @note fileno and ftruncate are posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
 #include "branch.h"
 
 /*! @uses commit_t. */
@@ -10,15 +12,21 @@
 /*! @uses assert. */
 #include <assert.h>
 
-/*! @uses calloc, free. */
+/*! @uses SIZE_MAX. */
+#include <stdint.h>
+
+/*! @uses calloc, free, strtoul. */
 #include <stdlib.h>
 
-/*! @uses strlen, strncpy. */
+/*! @uses strlen, strncpy, strncmp, strdup, strchr, strspn, memcpy. */
 #include <string.h>
 
-/*! @uses snprintf. */
+/*! @uses snprintf, fscanf, fgets, fgetc, rename, fseek, ftell, fread, fileno. */
 #include <stdio.h>
 
+/*! @uses access, ftruncate, F_OK. */
+#include <unistd.h>
+
 /*! @uses strtoha. */
 #include "utl.h"
 
@@ -26,6 +34,15 @@
  *  the file for a branch stored within the repository. */
 #define BRANCH_HEADER_FORMAT "name:%128[^\n]\nsha1:%40[^\n]\nidx:%lu\ncount:%lu\n"
 
+/*!~ @note this is the (optional) fork point written after the header, branches written before
+ *  fork points were tracked simply do not have it. */
+#define BRANCH_FORK_FORMAT "parent:%128[^\n]\nfork:%lu\n"
+
+/*!~ @note after the hashes, the ref is an append-only log of records; 'commit:<sha1>' when a commit
+ *  is pushed, and 'head:<idx>' when the head moves. once this many records have been appended,
+ *  the whole ref is written again (compacted). */
+#define BRANCH_COMPACT_RECORDS 256
+
 
 /**
  * @brief create a new branch with the given name.
@@ -62,50 +79,195 @@ create_branch(const char* name) {
 }
 
 /**
- * @brief create a folder to hold all the branch's commits and diffs.
+ * @brief write the header of a branch ref (and its fork point if it has one).
+ *
+ * @param f the ref file.
+ * @param branch the branch.
+ * @param count the number of hashes written after the header.
+ */
+internal void
+write_ref_header(FILE* f, const branch_t* branch, size_t count) {
+    char* hash = strsha1(branch->hash);
+    fprintf(f, "name:%s\nsha1:%s\nidx:%lu\ncount:%lu\n", branch->name, hash, branch->head, count);
+    free(hash);
+    if (branch->parent)
+        fprintf(f, "parent:%s\nfork:%lu\n", branch->parent, branch->fork);
+}
+
+/**
+ * @brief write (compact) the whole ref of a branch; the header, and the hash of every commit
+ *  owned by the branch.
  *
  * @param branch the branch_t structure to be written to a file.
  */
 void
-write_branch(const branch_t* branch) {
+write_branch(branch_t* branch) {
     /* assert on the branch ptr. */
     assert(branch != 0x0);
 
-    /* create a file for the branch. */
-    FILE* f = fopen(branch->path, "w");
+    /* create a temporary file for the branch, renamed over the ref once it is complete. */
+    char temporary[272];
+    snprintf(temporary, sizeof temporary, "%s.tmp", branch->path);
+    FILE* f = fopen(temporary, "w");
     if (!f) {
         fprintf(stderr,"fopen failed; could not open branch file for writing.\n");
         exit(EXIT_FAILURE); /* exit on failure. */
     }
 
     /* write the branch name and hash to the file. */
-    fprintf(f, "name:%s\nsha1:%s\nidx:%lu\ncount:%lu\n", \
-        branch->name, strsha1(branch->hash), branch->head, branch->commits->length);
+    write_ref_header(f, branch, branch->commits->length);
 
-    /* write out each respective sha1 hash for every commit. */
+    /* write out each respective sha1 hash for every owned commit (after the fork point). */
     _foreach(branch->commits, commit_t*, commit)
         fprintf(f, "%s\n", strsha1(commit->hash));
     _endforeach;
     fclose(f);
+
+    /* replace the ref atomically, a reader never sees a partially written branch. */
+    if (rename(temporary, branch->path) != 0) {
+        fprintf(stderr,"rename failed; could not replace branch file.\n");
+        exit(EXIT_FAILURE); /* exit on failure. */
+    }
+    branch->records = 0;
 }
 
 /**
- * @brief read a branch from a file in our '.lit' directory.
+ * @brief check if a line of a branch ref is a whole record; a commit record with a 40 digit hash,
+ *  or a head record with an index (a record torn by a crash while appending is neither).
  *
- * @param name the name of our branch.
- * @return a branch_t structure containing the branch information.
+ * @param line the line of the ref (without its newline).
+ * @return true if the line is a record.
  */
-branch_t*
-read_branch(const char* name) {
-    /* assert on the name. */
-    assert(name != 0x0);
+internal bool
+is_record(const char* line) {
+    if (!strncmp(line, "commit:", 7))
+        return strlen(line + 7) == 40 && strspn(line + 7, "0123456789abcdef") == 40;
+    if (!strncmp(line, "head:", 5))
+        return line[5] != '\0' && strspn(line + 5, "0123456789") == strlen(line + 5);
+    return false;
+}
 
-    /* create a temporary branch structure. */
-    branch_t* branch = calloc(1, sizeof *branch);
+/**
+ * @brief read the next record of a branch ref; lines that are not whole records are skipped, and
+ *  a last line without its newline (torn by a crash while appending) is never read.
+ *
+ * @param f the ref file, positioned at the records.
+ * @param record buffer to store the record in (without its newline).
+ * @param size the size of the buffer.
+ * @return true if a record was read.
+ */
+internal bool
+read_record(FILE* f, char* record, size_t size) {
+    while (fgets(record, (int) size, f)) {
+        char* newline = strchr(record, '\n');
+        if (!newline) {
+            /* the rest of a line too long to be a record, unless the ref ends here. */
+            int c = 0;
+            while ((c = fgetc(f)) != EOF && c != '\n');
+            if (c == EOF) return false;
+            continue;
+        }
+        *newline = '\0';
+        if (is_record(record)) return true;
+    }
+    return false;
+}
 
-    /* create the dynamic array as well. */
-    branch->commits = dyna_create();
+/**
+ * @brief open a branch ref for appending records; a last line without its newline (torn by a
+ *  crash while appending) is cut off first, so the next record starts on a line of its own.
+ *
+ * @param path the path of the ref.
+ * @return the ref file, positioned at its end.
+ */
+internal FILE*
+open_ref_append(const char* path) {
+    FILE* f = fopen(path, "r+");
+    if (!f) {
+        fprintf(stderr,"fopen failed; could not open branch file for appending.\n");
+        exit(EXIT_FAILURE); /* exit on failure. */
+    }
+
+    /* find the end of the last whole line. */
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f), position = end;
+    while (position > 0) {
+        fseek(f, position - 1, SEEK_SET);
+        if (fgetc(f) == '\n') break;
+        position--;
+    }
+    fflush(f);
+    if (position > 0 && position < end && ftruncate(fileno(f), position) != 0) {
+        fprintf(stderr,"ftruncate failed; could not cut off a torn branch record.\n");
+        exit(EXIT_FAILURE); /* exit on failure. */
+    }
+    fseek(f, 0, SEEK_END);
+    return f;
+}
+
+/**
+ * @brief append records to the ref of a branch, for the last <count> commits pushed onto it and
+ *  then its head; the ref is compacted instead once enough records have been appended.
+ *
+ * @param branch the branch_t structure to be appended to its file.
+ * @param count the number of commits pushed since the ref was last written.
+ */
+void
+append_branch(branch_t* branch, size_t count) {
+    /* assert on the branch ptr. */
+    assert(branch != 0x0);
+    assert(count <= branch->commits->length);
+    if (branch->records + count + 1 > BRANCH_COMPACT_RECORDS) {
+        write_branch(branch);
+        return;
+    }
+
+    /* open the ref for appending. */
+    FILE* f = open_ref_append(branch->path);
+
+    /* one record per commit pushed, then the head. */
+    for (size_t i = branch->commits->length - count; i < branch->commits->length; i++) {
+        char* hash = strsha1(((const commit_t*) dyna_get(branch->commits, i))->hash);
+        fprintf(f, "commit:%s\n", hash);
+        free(hash);
+    }
+    fprintf(f, "head:%lu\n", branch->head);
+    fclose(f);
+    branch->records += count + 1;
+}
+
+/**
+ * @brief read a commit owned by a branch by its hash, and push it onto the branch.
+ *
+ * @param branch the branch being read.
+ * @param hash the sha1 hash string of the commit.
+ */
+internal void
+read_owned_commit(branch_t* branch, const char* hash) {
+    /* use the first byte (2 chars) as the folder path in .lit/objects/commits/xx, and then the
+     *  rest (name+2) as the file name. */
+    char path[256];
+    snprintf(path, 256, ".lit/objects/commits/%.2s/%.38s", hash, hash + 2);
+    commit_t* commit = read_commit(path);
 
+    /* commits written before generations were tracked get their position on this branch. */
+    if (commit->generation == 0)
+        commit->generation = branch->fork + branch->commits->length + 1;
+
+    /* push to the dynamic array. */
+    dyna_push(branch->commits, commit);
+}
+
+/**
+ * @brief open the ref of a branch and read its header (and fork point if there is one).
+ *
+ * @param branch the branch to read the header into.
+ * @param name the name of the branch.
+ * @param count pointer to store the number of hashes written after the header.
+ * @return the ref file, positioned after the header.
+ */
+internal FILE*
+open_branch(branch_t* branch, const char* name, size_t* count) {
     /* create the branch path based on the cwd. */
     branch->path = calloc(1, 256);
     sprintf(branch->path, ".lit/refs/heads/%s", name);
@@ -118,40 +280,562 @@ read_branch(const char* name) {
     }
 
     /* read the branch information from the file. */
-    size_t count = 0;
     branch->name = calloc(1, 129);
     char *branch_hash = calloc(1, 41);
     int scanned = fscanf(f, BRANCH_HEADER_FORMAT, \
-        branch->name, branch_hash, &branch->head, &count);
+        branch->name, branch_hash, &branch->head, count);
     if (scanned != 4) {
         fprintf(stderr,"fscanf failed; could not read branch header.\n");
         fclose(f);
         exit(EXIT_FAILURE); /* exit on failure. */
     }
 
+    /* read the fork point if there is one, otherwise rewind to the commit hashes. */
+    long position = ftell(f);
+    char* parent = calloc(1, 129);
+    if (fscanf(f, BRANCH_FORK_FORMAT, parent, &branch->fork) == 2)
+        branch->parent = parent;
+    else {
+        free(parent);
+        branch->fork = 0;
+        fseek(f, position, SEEK_SET);
+    }
+
     /* convert to hashes. */
     unsigned char* _hash = strtoha(branch_hash, 20);
     memcpy(branch->hash, _hash, 20);
     free(_hash);
     free(branch_hash);
+    return f;
+}
+
+/**
+ * @brief read a branch from a file in our '.lit' directory.
+ *
+ * @param name the name of our branch.
+ * @return a branch_t structure containing the branch information.
+ */
+branch_t*
+read_branch(const char* name) {
+    /* assert on the name. */
+    assert(name != 0x0);
+
+    /* create a temporary branch structure. */
+    branch_t* branch = calloc(1, sizeof *branch);
+
+    /* create the dynamic array as well. */
+    branch->commits = dyna_create();
+
+    /* open the branch file for reading, and read the header. */
+    size_t count = 0;
+    FILE* f = open_branch(branch, name, &count);
 
-    /* start reading the file for the count of commits, then use the first byte (2 chars) as the
-     *  folder path in .lit/objects/commits/xx, and then the rest (name+2) as the file name. */
+    /* start reading the file for the count of commits. */
     for (size_t i = 0; i < count; i++) {
         /* allocate and scan the hash. */
         char* hash = calloc(1, 41);
         fscanf(f, "%40[^\n]\n", hash);
-
-        /* construct the file location from the hash. */
-        char path[256];
-        snprintf(path, 256, ".lit/objects/commits/%.2s/%38s", hash, hash + 2);
-        commit_t* commit = read_commit(path);
-
-        /* push to the dynamic array. */
-        dyna_push(branch->commits, commit);
+        read_owned_commit(branch, hash);
         free(hash);
     }
 
+    /* then replay the records appended since the ref was last compacted. */
+    char record[64];
+    while (read_record(f, record, sizeof record)) {
+        if (!strncmp(record, "commit:", 7))
+            read_owned_commit(branch, record + 7);
+        else if (!strncmp(record, "head:", 5))
+            branch->head = strtoul(record + 5, 0x0, 10);
+        branch->records++;
+    }
+    fclose(f);
+
     /* return the branch we have read. */
     return branch;
+}
+
+/**
+ * @brief visit the lines of a file backwards (from the last line to the first).
+ *
+ * @param f the file to be read.
+ * @param visit the function called for each non-empty line, returning false to stop.
+ * @param context pointer passed to each call of <visit>.
+ */
+internal void
+visit_lines_backwards(FILE* f, bool (*visit)(const char* line, void* context), void* context) {
+    /* a last line without its newline was torn by a crash while appending, it is never visited. */
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    bool torn = false;
+    if (end > 0) {
+        fseek(f, end - 1, SEEK_SET);
+        torn = fgetc(f) != '\n';
+    }
+
+    /* read blocks from the end, carrying the partial first line of a block into the next. */
+    char* carry = 0x0;
+    size_t carry_length = 0;
+    bool stop = false;
+    while (end > 0 && !stop) {
+        long start = end > 4096 ? end - 4096 : 0;
+        size_t length = (size_t) (end - start);
+        char* block = calloc(1, length + carry_length + 1);
+        fseek(f, start, SEEK_SET);
+        if (fread(block, 1, length, f) != length) {
+            free(block);
+            break;
+        }
+        if (carry) memcpy(block + length, carry, carry_length);
+        free(carry);
+        carry = 0x0;
+
+        /* split the lines from the end of the block. */
+        char* last = block + length + carry_length;
+        for (;;) {
+            char* newline = last;
+            while (newline > block && *(newline - 1) != '\n')
+                newline--;
+            if (newline == block && start > 0) {
+                carry_length = (size_t) (last - block);
+                carry = calloc(1, carry_length + 1);
+                memcpy(carry, block, carry_length);
+                break;
+            }
+            *last = '\0';
+            if (torn)
+                torn = false;
+            else if (*newline && !visit(newline, context)) {
+                stop = true;
+                break;
+            }
+            if (newline == block)
+                break;
+            last = newline - 1;
+        }
+        free(block);
+        end = start;
+    }
+    free(carry);
+}
+
+/**
+ * a data structure for counting the records appended to a branch ref (read backwards).
+ */
+typedef struct {
+    size_t lines; /* number of records. */
+    size_t commits; /* number of commit records. */
+    bool has_head; /* whether a head record has been read. */
+    size_t head; /* index of the head commit, from the most recent head record. */
+} records_t;
+
+/**
+ * @brief visit a single line of a branch ref (read backwards), until the records end.
+ *
+ * @param line the line of the ref.
+ * @param context pointer to the records_t.
+ * @return false once a line that is not a record is reached.
+ */
+internal bool
+visit_record_line(const char* line, void* context) {
+    records_t* records = context;
+    if ((!strncmp(line, "commit:", 7) || !strncmp(line, "head:", 5)) && !is_record(line))
+        return true; /* not a whole record, skipped. */
+    if (!strncmp(line, "commit:", 7))
+        records->commits++;
+    else if (!strncmp(line, "head:", 5)) {
+        if (!records->has_head)
+            records->head = strtoul(line + 5, 0x0, 10);
+        records->has_head = true;
+    }
+    else
+        return false;
+    records->lines++;
+    return true;
+}
+
+/**
+ * a data structure for collecting the hashes of a branch ref (read backwards).
+ */
+typedef struct {
+    dyna_t* hashes; /* hashes read so far, newest first. */
+    size_t skip; /* number of (newest) hashes still to be skipped. */
+    size_t max_count; /* maximum number of hashes to be read (0 for all). */
+} hashes_t;
+
+/**
+ * @brief visit a single line of a branch ref (read backwards), collecting the commit hashes.
+ *
+ * @param line the line of the ref.
+ * @param context pointer to the hashes_t.
+ * @return false once enough hashes have been read, or the header is reached.
+ */
+internal bool
+visit_hash_line(const char* line, void* context) {
+    hashes_t* hashes = context;
+    const char* hash = 0x0;
+    if (!strncmp(line, "commit:", 7) && !is_record(line))
+        return true; /* not a whole record, skipped. */
+    if (!strncmp(line, "commit:", 7))
+        hash = line + 7;
+    else if (strlen(line) == 40 && !strchr(line, ':'))
+        hash = line;
+    else
+        return !strncmp(line, "head:", 5); /* anything else is the header. */
+
+    /* skip the newest hashes, then collect. */
+    if (hashes->skip > 0)
+        hashes->skip--;
+    else
+        dyna_push(hashes->hashes, strdup(hash));
+    return hashes->max_count == 0 || hashes->hashes->length < hashes->max_count;
+}
+
+/**
+ * @brief read the tail of a branch ref backwards from its end, without reading any of the
+ *  commits; only the hashes of the commits owned by the branch up to <bound> in its history.
+ *
+ * @param name the name of the branch.
+ * @param bound only commits before this index in the history are read (SIZE_MAX for all).
+ * @param max_count the maximum number of hashes to be read (0 for all of them).
+ * @return the allocated tail of the branch.
+ */
+branch_tail_t*
+read_branch_tail(const char* name, size_t bound, size_t max_count) {
+    /* assert on the name. */
+    assert(name != 0x0);
+
+    /* open the branch file, and read the header. */
+    branch_t branch = {0};
+    size_t count = 0;
+    FILE* f = open_branch(&branch, name, &count);
+    branch_tail_t* tail = calloc(1, sizeof *tail);
+    tail->hashes = dyna_create();
+    tail->parent = branch.parent;
+    tail->fork = branch.fork;
+
+    /* the records are at the end (and there are only a few until the ref is compacted); they give
+     *  the head and the number of commits pushed since. */
+    records_t records = {0};
+    visit_lines_backwards(f, visit_record_line, &records);
+    tail->head = records.has_head ? records.head : branch.head;
+    tail->length = branch.fork + count + records.commits;
+
+    /* then collect the hashes newest first, skipping those after the bound. */
+    if (bound > branch.fork) {
+        hashes_t hashes = { .hashes = tail->hashes, .max_count = max_count, \
+            .skip = tail->length > bound ? tail->length - bound : 0 };
+        visit_lines_backwards(f, visit_hash_line, &hashes);
+    }
+    fclose(f);
+    free(branch.name);
+    free(branch.path);
+    return tail;
+}
+
+/**
+ * @brief free the tail of a branch ref.
+ *
+ * @param tail the tail of the branch.
+ */
+void
+free_branch_tail(branch_tail_t* tail) {
+    /* assert on the tail. */
+    assert(tail != 0x0);
+    _foreach(tail->hashes, char*, hash)
+        free(hash);
+    _endforeach;
+    dyna_free(tail->hashes);
+    free(tail->parent);
+    free(tail);
+}
+
+/**
+ * @brief open the history of a branch to be walked newest first (see @ref next_history()).
+ *
+ * @param name the name of the branch.
+ * @param max_count the maximum number of hashes to be read (0 for all of them).
+ * @return the allocated history.
+ */
+history_t*
+open_history(const char* name, size_t max_count) {
+    /* assert on the name. */
+    assert(name != 0x0);
+
+    /* start at the tail of the branch itself. */
+    history_t* history = calloc(1, sizeof *history);
+    history->tail = read_branch_tail(name, SIZE_MAX, max_count);
+    history->idx = history->length = history->tail->length;
+    history->head = history->tail->head;
+    history->bound = SIZE_MAX;
+    history->max_count = max_count;
+    return history;
+}
+
+/**
+ * @brief get the next (older) commit in the history of a branch.
+ *
+ * @param history the history being walked.
+ * @param idx pointer to store the index of the commit in the history (can be 0x0).
+ * @return the hash string of the commit (owned by the history), or 0x0 at the end.
+ */
+const char*
+next_history(history_t* history, size_t* idx) {
+    /* assert on the history. */
+    assert(history != 0x0);
+
+    /* once the tail has run out, the commits before the fork point are read from the parent. */
+    while (history->position >= history->tail->hashes->length) {
+        if (history->bound > history->tail->fork)
+            history->bound = history->tail->fork;
+        if (!history->tail->parent || history->bound == 0 || \
+            (history->max_count > 0 && history->count >= history->max_count))
+            return 0x0;
+        branch_tail_t* parent = read_branch_tail(history->tail->parent, history->bound, \
+            history->max_count ? history->max_count - history->count : 0);
+        free_branch_tail(history->tail);
+        history->tail = parent;
+        history->position = 0;
+    }
+
+    /* the hashes of a tail are newest first. */
+    history->count++;
+    history->idx--;
+    if (idx) *idx = history->idx;
+    return dyna_get(history->tail->hashes, history->position++);
+}
+
+/**
+ * @brief close and free the history of a branch.
+ *
+ * @param history the history being walked.
+ */
+void
+close_history(history_t* history) {
+    /* assert on the history. */
+    assert(history != 0x0);
+    free_branch_tail(history->tail);
+    free(history);
+}
+
+/**
+ * @brief open the ref of a branch to be read oldest first (see @ref next_ref_hash()).
+ *
+ * @param name the name of the branch.
+ * @return the allocated reader, positioned at the first owned commit.
+ */
+ref_reader_t*
+open_ref_reader(const char* name) {
+    /* assert on the name. */
+    assert(name != 0x0);
+
+    /* only the header is read, the hashes follow it oldest first. */
+    branch_t branch = {0};
+    ref_reader_t* reader = calloc(1, sizeof *reader);
+    reader->f = open_branch(&branch, name, &reader->count);
+    reader->parent = branch.parent;
+    reader->fork = branch.fork;
+    free(branch.name);
+    free(branch.path);
+    return reader;
+}
+
+/**
+ * @brief get the next (newer) commit owned by a branch; the hashes after the header, and then
+ *  the commit records appended since the ref was compacted.
+ *
+ * @param reader the reader of the ref.
+ * @return the hash string of the commit (owned by the reader), or 0x0 at the end.
+ */
+const char*
+next_ref_hash(ref_reader_t* reader) {
+    /* assert on the reader. */
+    assert(reader != 0x0);
+    if (reader->count > 0) {
+        reader->count--;
+        return fscanf(reader->f, "%40[^\n]\n", reader->hash) == 1 ? reader->hash : 0x0;
+    }
+
+    /* the records; the head records are skipped. */
+    char record[64];
+    while (read_record(reader->f, record, sizeof record))
+        if (!strncmp(record, "commit:", 7)) {
+            snprintf(reader->hash, sizeof reader->hash, "%.40s", record + 7);
+            return reader->hash;
+        }
+    return 0x0;
+}
+
+/**
+ * @brief close and free the reader of a ref.
+ *
+ * @param reader the reader of the ref.
+ */
+void
+close_ref_reader(ref_reader_t* reader) {
+    /* assert on the reader. */
+    assert(reader != 0x0);
+    fclose(reader->f);
+    free(reader->parent);
+    free(reader);
+}
+
+/**
+ * @brief append commits to the ref of a branch by their hashes alone, creating the ref if it does
+ *  not exist; none of the commits of the branch are read, and the ref is compacted from its hashes
+ *  once enough records have been appended.
+ *
+ * @param name the name of the branch.
+ * @param hashes the hash strings of the commits, oldest first.
+ * @param head the index of the head commit afterwards.
+ */
+void
+append_ref(const char* name, dyna_t* hashes, size_t head) {
+    /* assert on the name and the hashes. */
+    assert(name != 0x0);
+    assert(hashes != 0x0);
+
+    /* a ref that exists gets one record per commit and then the head, until it is compacted. */
+    char path[256];
+    snprintf(path, 256, ".lit/refs/heads/%s", name);
+    branch_t* branch = 0x0;
+    dyna_t* owned = dyna_create();
+    bool whole = true;
+    if (access(path, F_OK) == 0) {
+        branch = calloc(1, sizeof *branch);
+        size_t count = 0;
+        FILE* f = open_branch(branch, name, &count);
+        records_t records = {0};
+        visit_lines_backwards(f, visit_record_line, &records);
+        fclose(f);
+        if (records.lines + hashes->length + 1 <= BRANCH_COMPACT_RECORDS) {
+            f = open_ref_append(path);
+            _foreach(hashes, const char*, hash)
+                fprintf(f, "commit:%s\n", hash);
+            _endforeach;
+            fprintf(f, "head:%lu\n", head);
+            fclose(f);
+            whole = false;
+        }
+        else {
+            ref_reader_t* reader = open_ref_reader(name);
+            for (const char* hash; (hash = next_ref_hash(reader));)
+                dyna_push(owned, strdup(hash));
+            close_ref_reader(reader);
+        }
+    }
+    else
+        branch = create_branch(name);
+
+    /* otherwise the whole ref is written aside, and renamed over it. */
+    if (whole) {
+        char temporary[272];
+        snprintf(temporary, sizeof temporary, "%s.tmp", path);
+        FILE* f = fopen(temporary, "w");
+        if (!f) {
+            fprintf(stderr,"fopen failed; could not open branch file for writing.\n");
+            exit(EXIT_FAILURE); /* exit on failure. */
+        }
+        branch->head = head;
+        write_ref_header(f, branch, owned->length + hashes->length);
+        _foreach(owned, const char*, hash)
+            fprintf(f, "%s\n", hash);
+        _endforeach;
+        _foreach(hashes, const char*, hash)
+            fprintf(f, "%s\n", hash);
+        _endforeach;
+        fclose(f);
+        if (rename(temporary, path) != 0) {
+            fprintf(stderr,"rename failed; could not replace branch file.\n");
+            exit(EXIT_FAILURE); /* exit on failure. */
+        }
+    }
+    _foreach(owned, char*, hash)
+        free(hash);
+    _endforeach;
+    dyna_free(owned);
+    if (branch->commits) dyna_free(branch->commits);
+    free(branch->parent);
+    free(branch->name);
+    free(branch->path);
+    free(branch);
+}
+
+/**
+ * @brief get the number of commits in the history of a branch (inherited and owned).
+ *
+ * @param branch the branch.
+ * @return the number of commits.
+ */
+size_t
+branch_length(const branch_t* branch) {
+    /* assert on the branch. */
+    assert(branch != 0x0);
+    return branch->fork + branch->commits->length;
+}
+
+/**
+ * @brief get a commit in the history of a branch, reading through the parents for commits
+ *  before the fork point.
+ *
+ * @param branch the branch.
+ * @param idx the index of the commit in the history of the branch.
+ * @return the commit, or 0x0 if the index is out of bounds.
+ */
+commit_t*
+branch_commit(const branch_t* branch, size_t idx) {
+    /* assert on the branch. */
+    assert(branch != 0x0);
+
+    /* walk up to the branch that owns the commit at this index. */
+    while (idx < branch->fork && branch->base)
+        branch = branch->base;
+    if (idx < branch->fork)
+        return 0x0;
+    return dyna_get(branch->commits, idx - branch->fork);
+}
+
+/**
+ * @brief append a commit onto the end of the history of a branch (owned by the branch).
+ *
+ * @param branch the branch.
+ * @param commit the commit to be appended.
+ */
+void
+branch_push(branch_t* branch, commit_t* commit) {
+    /* assert on the branch and the commit. */
+    assert(branch != 0x0);
+    assert(commit != 0x0);
+    dyna_push(branch->commits, commit);
+}
+
+/**
+ * @brief take ownership of the commits a branch inherits from its parent that are owned by the
+ *  parent itself, and fork from the grandparent instead (before the parent is deleted or has its
+ *  history rewritten).
+ *
+ * @param branch the branch to be reparented.
+ */
+void
+reparent_branch(branch_t* branch) {
+    /* assert on the branch, there is nothing to do without a parent. */
+    assert(branch != 0x0);
+    branch_t* base = branch->base;
+    if (!base) return;
+
+    /* copy the inherited commits the parent owns in front of the commits this branch owns. */
+    size_t fork = branch->fork < base->fork ? branch->fork : base->fork;
+    dyna_t* commits = dyna_create();
+    for (size_t i = fork; i < branch->fork; i++)
+        dyna_push(commits, branch_commit(base, i));
+    _foreach(branch->commits, commit_t*, commit)
+        dyna_push(commits, commit);
+    _endforeach;
+    dyna_free(branch->commits);
+    branch->commits = commits;
+
+    /* fork from the grandparent (if there is one) at the earlier of the two fork points. */
+    free(branch->parent);
+    branch->parent = base->parent ? strdup(base->parent) : 0x0;
+    branch->base = base->base;
+    branch->fork = branch->base ? fork : 0;
 }
\ No newline at end of file
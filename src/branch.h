@@ -5,26 +5,75 @@
 #ifndef BRANCH_H
 #define BRANCH_H
 
+/*! @uses FILE. */
+#include <stdio.h>
+
 /*! @uses sha1_t, sha1, sha256_t, sha256. */
 #include "hash.h"
 
 /*! @uses dyna_t, dyna_push, _foreach... */
 #include "dyna.h"
 
+/*! @uses commit_t. */
+#include "commit.h"
+
 /**
  * a data structure representing a branch within the version control system. a branch is a
  *  specific partition of the repository containing specified changes by the user, which can be
  *  back traced to the very first commit. it includes, a name, a path, a hash, a pointer to the
- *  head (current commit), and an array of the commits itself.
+ *  head (current commit), and the fork point on its parent. branches are copy-on-write, the
+ *  commits up to the fork point are read through the parent, and only the commits after it are
+ *  owned (and stored) by the branch itself; use @ref branch_commit() and @ref branch_length().
  */
-typedef struct {
+typedef struct branch {
     char* name; /* branch name. */
     char* path; /* path to the branch directory. */
     sha1_t hash; /* hash of the branch. */
     size_t head; /* index to the head commit. */
-    dyna_t* commits; /* array of commits hashes for this branch. */
+    dyna_t* commits; /* array of commits owned by this branch (after the fork point). */
+    char* parent; /* name of the branch this branch was forked from (0x0 if none). */
+    size_t fork; /* number of commits inherited from the parent (up to the fork point). */
+    struct branch* base; /* the parent branch, resolved once every branch has been read. */
+    size_t records; /* number of records appended to the ref since it was last compacted. */
 } branch_t;
 
+/**
+ * a data structure for the tail of a branch ref, read without reading any of its commits; used to
+ *  stream the history of a branch newest first.
+ */
+typedef struct {
+    dyna_t* hashes; /* hash strings of the commits read (owned by the branch), newest first. */
+    size_t head; /* index to the head commit. */
+    size_t length; /* number of commits in the history of the branch (inherited and owned). */
+    char* parent; /* name of the branch this branch was forked from (0x0 if none). */
+    size_t fork; /* number of commits inherited from the parent (up to the fork point). */
+} branch_tail_t;
+
+/**
+ * a data structure for walking the history of a branch newest first straight from the refs (no
+ *  commits are read); the branch, and then each of its parents up to the fork point.
+ */
+typedef struct {
+    branch_tail_t* tail; /* tail of the branch currently being walked. */
+    size_t position; /* position of the next hash in the tail. */
+    size_t idx; /* index in the history of the last hash returned. */
+    size_t bound; /* every commit of the tail is before this index in the history. */
+    size_t max_count, count; /* maximum number of hashes to be read (0 for all), and read so far. */
+    size_t head, length; /* index to the head commit, and length of the history of the branch. */
+} history_t;
+
+/**
+ * a data structure for reading the ref of a branch oldest first, one hash at a time (no commits
+ *  are read, and none of the hashes are kept); only the commits owned by the branch.
+ */
+typedef struct {
+    FILE* f; /* ref file, positioned at the next hash (or record). */
+    size_t count; /* number of hashes left before the records. */
+    char* parent; /* name of the branch this branch was forked from (0x0 if none). */
+    size_t fork; /* number of commits inherited from the parent (up to the fork point). */
+    char hash[41]; /* hash string of the last commit read. */
+} ref_reader_t;
+
 /**
  * @brief create a new branch with the given name.
  *
@@ -35,12 +84,23 @@ branch_t*
 create_branch(const char* name);
 
 /**
- * @brief create a folder to hold all the branch's commits and diffs.
+ * @brief write (compact) the whole ref of a branch; the header, and the hash of every commit
+ *  owned by the branch.
  *
  * @param branch the branch_t structure to be written to a file.
  */
 void
-write_branch(const branch_t* branch);
+write_branch(branch_t* branch);
+
+/**
+ * @brief append records to the ref of a branch, for the last <count> commits pushed onto it and
+ *  then its head; the ref is compacted instead once enough records have been appended.
+ *
+ * @param branch the branch_t structure to be appended to its file.
+ * @param count the number of commits pushed since the ref was last written.
+ */
+void
+append_branch(branch_t* branch, size_t count);
 
 /**
  * @brief read a branch from a file in our '.lit' directory.
@@ -50,4 +110,143 @@ write_branch(const branch_t* branch);
  */
 branch_t*
 read_branch(const char* name);
+
+/**
+ * @brief read the tail of a branch ref backwards from its end, without reading any of the
+ *  commits; only the hashes of the commits owned by the branch up to <bound> in its history.
+ *
+ * @param name the name of the branch.
+ * @param bound only commits before this index in the history are read (SIZE_MAX for all).
+ * @param max_count the maximum number of hashes to be read (0 for all of them).
+ * @return the allocated tail of the branch.
+ */
+branch_tail_t*
+read_branch_tail(const char* name, size_t bound, size_t max_count);
+
+/**
+ * @brief free the tail of a branch ref.
+ *
+ * @param tail the tail of the branch.
+ */
+void
+free_branch_tail(branch_tail_t* tail);
+
+/**
+ * @brief open the history of a branch to be walked newest first (see @ref next_history()).
+ *
+ * @param name the name of the branch.
+ * @param max_count the maximum number of hashes to be read (0 for all of them).
+ * @return the allocated history.
+ */
+history_t*
+open_history(const char* name, size_t max_count);
+
+/**
+ * @brief get the next (older) commit in the history of a branch.
+ *
+ * @param history the history being walked.
+ * @param idx pointer to store the index of the commit in the history (can be 0x0).
+ * @return the hash string of the commit (owned by the history), or 0x0 at the end.
+ */
+const char*
+next_history(history_t* history, size_t* idx);
+
+/**
+ * @brief close and free the history of a branch.
+ *
+ * @param history the history being walked.
+ */
+void
+close_history(history_t* history);
+
+/**
+ * @brief open the ref of a branch to be read oldest first (see @ref next_ref_hash()).
+ *
+ * @param name the name of the branch.
+ * @return the allocated reader, positioned at the first owned commit.
+ */
+ref_reader_t*
+open_ref_reader(const char* name);
+
+/**
+ * @brief get the next (newer) commit owned by a branch; the hashes after the header, and then
+ *  the commit records appended since the ref was compacted.
+ *
+ * @param reader the reader of the ref.
+ * @return the hash string of the commit (owned by the reader), or 0x0 at the end.
+ */
+const char*
+next_ref_hash(ref_reader_t* reader);
+
+/**
+ * @brief close and free the reader of a ref.
+ *
+ * @param reader the reader of the ref.
+ */
+void
+close_ref_reader(ref_reader_t* reader);
+
+/**
+ * @brief append commits to the ref of a branch by their hashes alone, creating the ref if it does
+ *  not exist; none of the commits of the branch are read, and the ref is compacted from its hashes
+ *  once enough records have been appended.
+ *
+ * @param name the name of the branch.
+ * @param hashes the hash strings of the commits, oldest first.
+ * @param head the index of the head commit afterwards.
+ */
+void
+append_ref(const char* name, dyna_t* hashes, size_t head);
+
+/**
+ * @brief get the number of commits in the history of a branch (inherited and owned).
+ *
+ * @param branch the branch.
+ * @return the number of commits.
+ */
+size_t
+branch_length(const branch_t* branch);
+
+/**
+ * @brief get a commit in the history of a branch, reading through the parents for commits
+ *  before the fork point.
+ *
+ * @param branch the branch.
+ * @param idx the index of the commit in the history of the branch.
+ * @return the commit, or 0x0 if the index is out of bounds.
+ */
+commit_t*
+branch_commit(const branch_t* branch, size_t idx);
+
+/**
+ * @brief append a commit onto the end of the history of a branch (owned by the branch).
+ *
+ * @param branch the branch.
+ * @param commit the commit to be appended.
+ */
+void
+branch_push(branch_t* branch, commit_t* commit);
+
+/**
+ * @brief take ownership of the commits a branch inherits from its parent that are owned by the
+ *  parent itself, and fork from the grandparent instead (before the parent is deleted or has its
+ *  history rewritten).
+ *
+ * @param branch the branch to be reparented.
+ */
+void
+reparent_branch(branch_t* branch);
+
+/* starting an iteration over the history of a branch. */
+#define _branch_foreach_it(branch, type, var, iter) \
+    for (size_t iter = 0, _length = branch_length(branch); iter < _length; iter++) { \
+        type var = (type) branch_commit(branch, iter);
+
+/* starting an iteration over the history of a branch. */
+#define _branch_foreach(branch, type, var) _branch_foreach_it(branch, type, var, i)
+
+/* starting an iteration over the history of a branch, backwards. */
+#define _branch_inv_foreach_it(branch, type, var, iter) \
+    for (size_t iter = branch_length(branch); iter != 0; iter--) { \
+        type var = (type) branch_commit(branch, iter - 1);
 #endif /* BRANCH_H */
\ No newline at end of file
@@ -0,0 +1,262 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-24
+ */
+#include "bundle.h"
+
+/*! @uses FILE, fopen, fclose, fread, fgets, fprintf, fseek, ftell, rename, remove. */
+#include <stdio.h>
+
+/*! @uses free. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strncmp, strlen, memset, memcmp. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses crc32_append, strsha1. */
+#include "hash.h"
+
+/*! @uses shallow_offset. */
+#include "shallow.h"
+
+/*! @uses internal. */
+#include "utl.h"
+
+/*!~ @note the size of the blocks a bundle is read in while verifying its checksum. */
+#define BUNDLE_BLOCK_SIZE 65536
+
+/**
+ * @brief find a branch of a repository by name.
+ *
+ * @param repository the repository.
+ * @param name the name of the branch.
+ * @return the branch, or 0x0 if it does not exist.
+ */
+internal branch_t*
+find_bundle_branch(const repository_t* repository, const char* name) {
+    if (!repository->branches)
+        return 0x0;
+    _foreach(repository->branches, branch_t*, branch)
+        if (!strcmp(branch->name, name)) return branch;
+    _endforeach;
+    return 0x0;
+}
+
+/**
+ * @brief continue a crc32 over a range of a file, read in fixed size blocks.
+ *
+ * @param f the file, positioned at the start of the range.
+ * @param size the size of the range.
+ * @param crc pointer to the crc32 to be continued.
+ * @return true if the whole range was read.
+ */
+internal bool
+crc32_file(FILE* f, size_t size, ucrc32_t* crc) {
+    unsigned char* block = calloc(1, BUNDLE_BLOCK_SIZE);
+    size_t n = 0;
+    while (size > 0 && (n = fread(block, 1, size < BUNDLE_BLOCK_SIZE ? size : \
+        BUNDLE_BLOCK_SIZE, f)) > 0) {
+        *crc = crc32_append(*crc, block, n);
+        size -= n;
+    }
+    free(block);
+    return size == 0;
+}
+
+/**
+ * @brief write a bundle of a branch to a file; every commit after the first <prerequisites>
+ *  commits of the branch (all of them if there are none), and the objects of their diffs.
+ *
+ * @param path the path of the bundle.
+ * @param branch the branch to be bundled.
+ * @param prerequisites the number of commits of the branch the other side already has.
+ * @param sent pointer to store the number of commits bundled.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the bundle was not written.
+ * @return true if the bundle was written.
+ */
+bool
+create_bundle(const char* path, const branch_t* branch, size_t prerequisites, size_t* sent, \
+    char* reason) {
+    /* assert on the path, the branch, the count and the reason. */
+    assert(path != 0x0 && branch != 0x0);
+    assert(sent != 0x0 && reason != 0x0);
+    *sent = 0;
+
+    /* the indices are those of the complete history; the synthetic base of a shallow branch can
+     *  neither be sent nor be had by the other side. */
+    size_t offset = shallow_offset(branch), length = branch_length(branch);
+    if (length == 0 || prerequisites > length) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "the branch does not have the commits to bundle.");
+        return false;
+    }
+    if (offset > 0 && prerequisites < 2) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "the history before the shallow boundary is not " \
+            "here; the bundle has to start after the base.");
+        return false;
+    }
+
+    /* the header, then the pack, written aside. */
+    char temporary[1024];
+    snprintf(temporary, 1024, "%s.tmp", path);
+    FILE* f = fopen(temporary, "wb");
+    if (!f) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "fopen failed; could not open the bundle for " \
+            "writing.");
+        return false;
+    }
+    char* hash = strsha1(branch_commit(branch, length - 1)->hash);
+    fprintf(f, BUNDLE_SIGNATURE "\nbranch %s\ntip %lu %s\n", branch->name, length + offset, hash);
+    free(hash);
+    if (prerequisites > 0) {
+        hash = strsha1(branch_commit(branch, prerequisites - 1)->hash);
+        fprintf(f, "prerequisite %lu %s\n", prerequisites + offset, hash);
+        free(hash);
+    }
+    bool written = send_pack(f, branch, prerequisites + offset, sent, reason);
+    written = fclose(f) == 0 && written;
+
+    /* then the checksum of everything written, appended as the last line. */
+    ucrc32_t crc = 0;
+    f = written ? fopen(temporary, "rb") : 0x0;
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        size_t size = (size_t) ftell(f);
+        fseek(f, 0, SEEK_SET);
+        written = crc32_file(f, size, &crc);
+        fclose(f);
+    }
+    f = written ? fopen(temporary, "ab") : 0x0;
+    written = f && fprintf(f, BUNDLE_CHECKSUM_FORMAT, crc) > 0;
+    if (f) written = fclose(f) == 0 && written;
+    if (!written || rename(temporary, path) != 0) {
+        if (reason[0] == '\0')
+            snprintf(reason, UPSTREAM_REASON_SIZE, "the bundle could not be written.");
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief verify the checksum of a bundle, reading it once in fixed size blocks.
+ *
+ * @param path the path of the bundle.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the bundle is not valid.
+ * @return true if the bundle is intact.
+ */
+bool
+verify_bundle(const char* path, char* reason) {
+    /* assert on the path and the reason. */
+    assert(path != 0x0 && reason != 0x0);
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "fopen failed; could not open the bundle.");
+        return false;
+    }
+
+    /* the signature first, then the checksum on the last line. */
+    char line[32] = {0}, tail[32] = {0};
+    bool signed_bundle = fgets(line, sizeof line, f) && !strcmp(line, BUNDLE_SIGNATURE "\n");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f), trailer = size - (long) (sizeof tail - 1);
+    if (trailer < 0) trailer = 0;
+    fseek(f, trailer, SEEK_SET);
+    size_t n = fread(tail, 1, sizeof tail - 1, f);
+    char* last = 0x0;
+    for (size_t i = n > 1 ? n - 1 : 0; i > 0 && !last; i--)
+        if (tail[i - 1] == '\n') last = tail + i;
+    ucrc32_t expected = 0, crc = 0;
+    if (!signed_bundle || !last || sscanf(last, BUNDLE_CHECKSUM_FORMAT, &expected) != 1) {
+        fclose(f);
+        snprintf(reason, UPSTREAM_REASON_SIZE, "not a bundle, or it was cut short.");
+        return false;
+    }
+
+    /* everything before the checksum line, in blocks. */
+    fseek(f, 0, SEEK_SET);
+    bool read = crc32_file(f, (size_t) (trailer + (last - tail)), &crc);
+    fclose(f);
+    if (!read || crc != expected) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "the checksum does not match (%08x, expected " \
+            "%08x); the bundle is corrupt.", crc, expected);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief verify a bundle, then import it into a repository; the objects are written as they are
+ *  read, and the branch is appended to (or created) only once all of them were.
+ *
+ * @param path the path of the bundle.
+ * @param repository the repository the bundle is imported into.
+ * @param move_head if the head is moved to the new tip (only if it was at the old tip).
+ * @param name buffer of 129 to store the name of the branch of the bundle.
+ * @param result pointer to store how far the branch moved.
+ * @return true if the bundle was imported (or its branch was already up to date).
+ */
+bool
+unbundle(const char* path, repository_t* repository, bool move_head, char* name, \
+    received_t* result) {
+    /* assert on the path, the repository, the name and the result. */
+    assert(path != 0x0 && repository != 0x0);
+    assert(name != 0x0 && result != 0x0);
+    memset(result, 0, sizeof *result);
+    if (!verify_bundle(path, result->reason))
+        return false;
+
+    /* the header; the branch, its tip, and the commit the bundle starts after (if any). */
+    FILE* f = fopen(path, "rb");
+    char line[512] = {0}, tip[41] = {0}, prerequisite[41] = {0};
+    size_t tip_length = 0, prerequisites = 0;
+    bool header = f && fgets(line, sizeof line, f) && fgets(line, sizeof line, f) && \
+        sscanf(line, "branch %128s", name) == 1 && fgets(line, sizeof line, f) && \
+        sscanf(line, "tip %lu %40s", &tip_length, tip) == 2;
+    long position = f ? ftell(f) : 0;
+    if (header && fgets(line, sizeof line, f) && \
+        sscanf(line, "prerequisite %lu %40s", &prerequisites, prerequisite) == 2)
+        position = ftell(f);
+    if (!header) {
+        if (f) fclose(f);
+        snprintf(result->reason, UPSTREAM_REASON_SIZE, "the header of the bundle is malformed.");
+        return false;
+    }
+    fseek(f, position, SEEK_SET);
+
+    /* the branch has to end at the prerequisite, or already have the tip. */
+    branch_t* branch = find_bundle_branch(repository, name);
+    size_t offset = shallow_offset(branch), length = branch ? branch_length(branch) + offset : 0;
+    bool has_tip = false, has_prerequisite = prerequisites == 0;
+    if (length >= tip_length && tip_length > offset + (offset > 0)) {
+        char* hash = strsha1(branch_commit(branch, tip_length - 1 - offset)->hash);
+        has_tip = !strcmp(hash, tip);
+        free(hash);
+    }
+    if (prerequisites > 0 && length >= prerequisites && prerequisites > offset + (offset > 0)) {
+        char* hash = strsha1(branch_commit(branch, prerequisites - 1 - offset)->hash);
+        has_prerequisite = !strcmp(hash, prerequisite);
+        free(hash);
+    }
+    if (has_tip) {
+        fclose(f);
+        return true;
+    }
+    if (!has_prerequisite)
+        snprintf(result->reason, UPSTREAM_REASON_SIZE, "the bundle needs commit '%s' of '%s', " \
+            "which is not here.", prerequisite, name);
+    else if (length != prerequisites)
+        snprintf(result->reason, UPSTREAM_REASON_SIZE, "not a fast-forward, '%s' has %lu " \
+            "commit(s) after the start of the bundle.", name, length - prerequisites);
+    if (!has_prerequisite || length != prerequisites) {
+        fclose(f);
+        return false;
+    }
+
+    /* then the pack, read and written one object at a time. */
+    bool received = receive_pack(f, name, move_head, result);
+    fclose(f);
+    return received;
+}
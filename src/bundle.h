@@ -0,0 +1,65 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-24
+ */
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses repository_t, branch_t. */
+#include "repo.h"
+
+/*! @uses received_t, UPSTREAM_REASON_SIZE. */
+#include "upstream.h"
+
+/*!~ @note the first line of every bundle, followed by the name of its branch, the length and hash
+ *  of the tip of the branch, and the commit it has to be applied on top of (if it is incremental);
+ *  then the pack of an upstream, and the checksum of everything before it on the last line. */
+#define BUNDLE_SIGNATURE "lit-bundle 1"
+#define BUNDLE_CHECKSUM_FORMAT "checksum %08x\n"
+
+/**
+ * @brief write a bundle of a branch to a file; every commit after the first <prerequisites>
+ *  commits of the branch (all of them if there are none), and the objects of their diffs.
+ *
+ * @param path the path of the bundle.
+ * @param branch the branch to be bundled.
+ * @param prerequisites the number of commits of the branch the other side already has.
+ * @param sent pointer to store the number of commits bundled.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the bundle was not written.
+ * @return true if the bundle was written.
+ */
+bool
+create_bundle(const char* path, const branch_t* branch, size_t prerequisites, size_t* sent, \
+    char* reason);
+
+/**
+ * @brief verify the checksum of a bundle, reading it once in fixed size blocks.
+ *
+ * @param path the path of the bundle.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the bundle is not valid.
+ * @return true if the bundle is intact.
+ */
+bool
+verify_bundle(const char* path, char* reason);
+
+/**
+ * @brief verify a bundle, then import it into a repository; the objects are written as they are
+ *  read, and the branch is appended to (or created) only once all of them were.
+ *
+ * @param path the path of the bundle.
+ * @param repository the repository the bundle is imported into.
+ * @param move_head if the head is moved to the new tip (only if it was at the old tip).
+ * @param name buffer of 129 to store the name of the branch of the bundle.
+ * @param result pointer to store how far the branch moved.
+ * @return true if the bundle was imported (or its branch was already up to date).
+ */
+bool
+unbundle(const char* path, repository_t* repository, bool move_head, char* name, \
+    received_t* result);
+#endif /* BUNDLE_H */
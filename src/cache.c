@@ -32,8 +32,8 @@
 #include "log.h"
 
 /**
- * @brief scan the .lit/objects folder for unrelated objects to any current branches,
- *  if any are found, remove them.
+ * @brief scan the commits and diffs of the .lit/objects folder for unrelated objects to any current
+ *  branches, if any are found, remove them.
  *
  * @param repository the repository read in the cwd.
  * @return the result enum of scanning the .lit/objects folder for unrelated objects.
@@ -45,13 +45,22 @@ scan_object_cache(const repository_t* repository) {
     if (!repository)
         return result;
 
-    /* scan the .lit/objects directory recursively to find all the objects. then we look through
-     * each one of the inodes, if it is not found in there, we then remove it as it isn't necessary
-     * (cache). */
-    dyna_t* objects = inw_walk(".lit/objects", E_INW_TYPE_RECURSE);
-    if (!objects) {
-        fprintf(stderr, "failed to collect objects from the .lit/objects directory.\n");
-        exit(EXIT_FAILURE); /* exit on failure. */
+    /* scan the commits and diffs of .lit/objects recursively to find all the objects. then we look
+     * through each one of the inodes, if it is not found in there, we then remove it as it isn't
+     * necessary (cache). nothing else in there is content addressed, the shelved changes and the
+     * files in .lit/objects/info (alternates, the shallow boundary) are never collected. */
+    dyna_t* objects = dyna_create();
+    const char* kinds[] = { ".lit/objects/commits", ".lit/objects/diffs" };
+    for (size_t k = 0; k < 2; k++) {
+        dyna_t* inodes = inw_walk(kinds[k], E_INW_TYPE_RECURSE);
+        if (!inodes) {
+            fprintf(stderr, "failed to collect objects from the .lit/objects directory.\n");
+            exit(EXIT_FAILURE); /* exit on failure. */
+        }
+        _foreach(inodes, inode_t*, node)
+            dyna_push(objects, node);
+        _endforeach;
+        dyna_free(inodes);
     }
 
     /* the count of how many objects have been removed. */
@@ -68,7 +77,7 @@ scan_object_cache(const repository_t* repository) {
          * complexity. */
         bool is_referenced = false;
         _foreach_it(repository->branches, const branch_t*, branch, j)
-            _foreach_it(branch->commits, commit_t*, commit, k)
+            _branch_foreach_it(branch, commit_t*, commit, k)
                 /* if the paths are equal. */
                 if (!strcmp(commit->path, node->path)) {
                     is_referenced = true;
@@ -16,8 +16,8 @@ typedef enum {
 } e_cache_result_t;
 
 /**
- * @brief scan the .lit/objects folder for unrelated objects to any current branches,
- *  if any are found, remove them.
+ * @brief scan the commits and diffs of the .lit/objects folder for unrelated objects to any current
+ *  branches, if any are found, remove them.
  *
  * @param repository the repository read in the cwd.
  * @return the result enum of scanning the .lit/objects folder for unrelated objects.
@@ -10,12 +10,21 @@
 /*! @uses mkdir, remove */
 #include <sys/stat.h>
 
-/*! @uses time_t */
+/*! @uses WIFEXITED, WEXITSTATUS. */
+#include <sys/wait.h>
+
+/*! @uses time_t, clock_gettime, CLOCK_MONOTONIC. */
 #include <time.h>
 
+/*! @uses opendir, readdir, closedir. */
+#include <dirent.h>
+
 /*! @uses bool, true, false */
 #include <stdbool.h>
 
+/*! @uses SIZE_MAX. */
+#include <stdint.h>
+
 /*! @uses diff_create, diff_write, diff_read. */
 #include "diff.h"
 
@@ -46,6 +55,42 @@
 /*! @uses config_t, read_config */
 #include "conf.h"
 
+/*! @uses write_tar_file, finish_tar. */
+#include "tar.h"
+
+/*! @uses read_sparse, write_sparse, sparse_includes. */
+#include "sparse.h"
+
+/*! @uses create_worktree, read_worktrees, find_checked_out, lock_worktrees. */
+#include "worktree.h"
+
+/*! @uses read_alternates, add_alternate, dedup_objects. */
+#include "alternates.h"
+
+/*! @uses connect_upstream, send_branch, receive_branch, serve_upstream_fd, lock_upstream. */
+#include "upstream.h"
+
+/*! @uses run_server, SERVER_CACHE_SIZE. */
+#include "server.h"
+
+/*! @uses clone_repository, clone_shallow. */
+#include "clone.h"
+
+/*! @uses shallow_t, read_shallow, shallow_offset. */
+#include "shallow.h"
+
+/*! @uses create_bundle, unbundle. */
+#include "bundle.h"
+
+/*! @uses import_stats_t, fast_import. */
+#include "import.h"
+
+/*! @uses export_stats_t, fast_export. */
+#include "export.h"
+
+/*! @uses chdir, access, F_OK. */
+#include <unistd.h>
+
 /*! @uses log, E_LOG_... */
 #include "log.h"
 
@@ -65,18 +110,7 @@ internal bool all = false, no_recurse = false, hard = false, graph = false, \
 #define _llog(level, format, ...) if (!quiet) llog(level, format, ##__VA_ARGS__);
 
 internal void
-setup(dyna_t* array) {
-    /* read our repository from disk. */
-    repository = read_repository();
-    assert(repository != 0x0);
-
-    /* get the active branch. */
-    active_branch = dyna_get(repository->branches, repository->idx);
-    assert(active_branch != 0x0);
-
-    /* read the config file. */
-    config = read_config();
-
+parse_flags(dyna_t* array) {
     /* parse for flag arguments. */
     _foreach(array, argument_t*, argument)
         if (argument->type == E_FLAG_TO_ARGUMENT) {
@@ -124,6 +158,23 @@ setup(dyna_t* array) {
     _endforeach
 }
 
+internal void
+setup(dyna_t* array) {
+    /* read our repository from disk. */
+    repository = read_repository();
+    assert(repository != 0x0);
+
+    /* get the active branch. */
+    active_branch = dyna_get(repository->branches, repository->idx);
+    assert(active_branch != 0x0);
+
+    /* read the config file. */
+    config = read_config();
+
+    /* parse for flag arguments. */
+    parse_flags(array);
+}
+
 internal int
 handle_init() {
     /* create the repository, unless it has already been made. */
@@ -135,37 +186,949 @@ handle_init() {
     return 0;
 }
 
+internal bool
+log_changes(const commit_t* header, const char* path, dyna_t* paths) {
+    /* check the bloom filter first, and only read the diffs if it may have changed a path. */
+    bool may_change = false;
+    _foreach(paths, const char*, prefix)
+        if (commit_may_change(header, prefix)) may_change = true;
+    _endforeach;
+    if (!may_change)
+        return false;
+
+    /* read the whole commit to rule out false positives. */
+    commit_t* commit = read_commit(path);
+    bool changes = false;
+    _foreach(paths, const char*, prefix)
+        if (commit_changes(commit, prefix)) changes = true;
+    _endforeach;
+    free_commit(commit);
+    return changes;
+}
+
 internal int
-handle_log() {
+handle_log(dyna_t* argument_array) {
+    /* the history is streamed from the refs (newest first), so only the flags are parsed and
+     *  nothing is read until it is printed. */
+    parse_flags(argument_array);
+    size_t count = 0;
+    dyna_t* paths = dyna_create();
+    bool after_paths = false;
+    _foreach_it(argument_array, const argument_t*, argument, i)
+        if (argument->type == E_FLAG_TO_ARGUMENT && argument->details.flag == E_FLAG_ARG_MAX_COUNT) {
+            const argument_t* next = _get(argument_array, argument_t*, i + 1);
+            count = strtoul(next->value, 0x0, 10);
+        }
+        else if (argument->type == E_FLAG_TO_ARGUMENT && argument->details.flag == E_FLAG_ARG_PATHS)
+            after_paths = true;
+        else if (argument->type == E_PARAMETER_TO_ARGUMENT && after_paths) {
+            const argument_t* previous = _get(argument_array, argument_t*, i - 1);
+            if (previous->type != E_FLAG_TO_ARGUMENT || previous->details.flag != E_FLAG_ARG_MAX_COUNT)
+                dyna_push(paths, argument->value);
+        }
+    _endforeach;
+
     /* inode walk to collect all shelved files. */
-    dyna_t* shelved_array = collect_shelved(active_branch->name);
+    bool readonly = false;
+    char* branch_name = read_active_branch_name(&readonly);
+    dyna_t* shelved_array = collect_shelved(branch_name);
 
-    /* print out the active branch name and the number of diffs shelved. */
+    /* print out the active branch name and the number of diffs shelved; when limited to paths, we
+     *  cannot know how many hashes are needed for <count> commits up front. */
+    history_t* history = open_history(branch_name, paths->length > 0 ? 0 : count);
     printf("current branch: \'%s\', %lu change(s) shelved, with %lu commit(s), %s.\n", \
-        active_branch->name, shelved_array->length, active_branch->commits->length,
-        repository->readonly ? "in read-only " : "in read-write");
-
-    /* iterate through each object. */
-    _foreach(active_branch->commits, const commit_t*, commit)
-        if (i == active_branch->head) printf("\t    ->  ");
+        branch_name, shelved_array->length, history->length,
+        readonly ? "in read-only " : "in read-write");
+
+    /* the tags that decorate the commits are only indexed once the first commit is printed. */
+    hmap_t* tag_index = 0x0;
+
+    /* walk up the branch and its parents, reading only the header of each commit printed. */
+    size_t idx = 0, printed = 0;
+    for (const char* hash; (count == 0 || printed < count) && (hash = next_history(history, &idx));) {
+        char path[256];
+        snprintf(path, 256, ".lit/objects/commits/%.2s/%.38s", hash, hash + 2);
+        commit_t* commit = read_commit_header(path);
+
+        /* when limited to paths, the bloom filter skips almost every commit that did not change
+         *  any of them, only the rest have their diffs read to be sure. */
+        if (paths->length > 0 && !log_changes(commit, path, paths)) {
+            free_commit(commit);
+            continue;
+        }
+        if (idx == history->head) printf("\t    ->  ");
         else printf("\t\t");
 
-        /* print the information about the commits. */
-        char* _hash = strsha1(commit->hash);
-        printf("%s : %s @ %s\n", strtrm(_hash, 60), \
-            strtrm(commit->message, 32), commit->timestamp);
-        free(_hash);
+        /* print the information about the commits, and their tags. */
+        if (!tag_index)
+            tag_index = index_tag_names();
+        dyna_t* commit_tags = hmap_get(tag_index, hash);
+        printf("%s : %s @ %s", hash, strtrm(commit->message, 32), commit->timestamp);
+        if (commit_tags) {
+            printf(" (tag: ");
+            _foreach_it(commit_tags, const char*, name, k)
+                printf("%s%s", k ? ", " : "", name);
+            _endforeach;
+            printf(")");
+        }
+        printf("\n");
+        free_commit(commit);
+        printed++;
+    }
+    if (tag_index)
+        free_tag_names(tag_index);
+    close_history(history);
+    free(branch_name);
+    dyna_free(paths);
+    return 0;
+}
+
+internal bool
+resolve_commit(const char* revision, branch_t** branch, size_t* idx) {
+    /* a tag can be given in place of the hash (or the start of the hash) of a commit. */
+    char* prefix = strdup(revision);
+    tag_t* tag = read_tag(revision);
+    if (tag) {
+        free(prefix);
+        prefix = strsha1(tag->commit_hash);
+        free(tag->name);
+        free(tag);
+    }
+
+    /* search the active branch first, then every other branch. */
+    size_t length = strlen(prefix);
+    for (size_t b = 0; b <= repository->branches->length; b++) {
+        branch_t* candidate = b == 0 ? active_branch : dyna_get(repository->branches, b - 1);
+        if (b > 0 && candidate == active_branch) continue;
+        _branch_inv_foreach_it(candidate, const commit_t*, commit, i)
+            char* hash = strsha1(commit->hash);
+            bool found = !strncmp(hash, prefix, length);
+            free(hash);
+            if (found) {
+                *branch = candidate;
+                *idx = i - 1;
+                free(prefix);
+                return true;
+            }
+        _endforeach;
+    }
+    free(prefix);
+    return false;
+}
+
+internal int
+handle_show(dyna_t* argument_array) {
+    /* nothing is read from the repository, apart from the history up to the commit. */
+    parse_flags(argument_array);
+    const char* spec = 0x0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT)
+            spec = argument->value;
+    _endforeach;
+    const char* separator = spec ? strchr(spec, ':') : 0x0;
+    if (!separator || separator == spec || !separator[1]) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected a commit and a path (<commit>:<path>).\n");
+        return -1;
+    }
+    char* revision = calloc(1, (size_t) (separator - spec) + 1);
+    memcpy(revision, spec, (size_t) (separator - spec));
+    const char* path = separator + 1;
+
+    /* a tag can be given in place of the hash (or the start of the hash) of a commit. */
+    char* prefix = revision;
+    tag_t* tag = read_tag(revision);
+    if (tag) {
+        prefix = strsha1(tag->commit_hash);
+        free(tag->name);
+        free(tag);
+    }
+
+    /* find the commit in the history of the active branch first, streamed from the refs. */
+    bool readonly = false;
+    char* branch_name = read_active_branch_name(&readonly);
+    history_t* history = open_history(branch_name, 0);
+    const char* hash = 0x0;
+    while ((hash = next_history(history, 0x0)))
+        if (!strncmp(hash, prefix, strlen(prefix)))
+            break;
+    bool found = hash != 0x0;
+    size_t n = 0;
+    char** lines = found ? reconstruct_history_op(history, hash, path, &n) : 0x0;
+    close_history(history);
+    if (prefix != revision) free(prefix);
+    free(branch_name);
+
+    /* then on every other branch, which needs the whole repository to be read. */
+    if (!found) {
+        setup(argument_array);
+        branch_t* branch = 0x0;
+        size_t idx = 0;
+        found = resolve_commit(revision, &branch, &idx);
+        if (found) lines = reconstruct_op(branch, idx, path, &n);
+    }
+    if (!found || !lines) {
+        if (!found) llog(E_LOGGER_LEVEL_ERROR, "commit \'%s\' not found.\n", revision);
+        else llog(E_LOGGER_LEVEL_ERROR, "path \'%s\' does not exist at \'%s\'.\n", path, \
+            revision);
+        free(revision);
+        return -1;
+    }
+
+    /* stream the file out. */
+    for (size_t i = 0; i < n; i++) {
+        fputs(lines[i], stdout);
+        fputc('\n', stdout);
+        free(lines[i]);
+    }
+    free(lines);
+    free(revision);
+    return 0;
+}
+
+internal int
+handle_diff(dyna_t* argument_array) {
+    /* gather both commits, from the old to the new one. */
+    const char* revisions[2] = { 0x0, 0x0 };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 2)
+            revisions[count++] = argument->value;
+    _endforeach;
+    if (count < 2) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected two commits to compare.\n");
+        return -1;
+    }
+    branch_t* branches[2];
+    size_t indices[2];
+    for (size_t k = 0; k < 2; k++)
+        if (!resolve_commit(revisions[k], &branches[k], &indices[k])) {
+            llog(E_LOGGER_LEVEL_ERROR, "commit \'%s\' not found.\n", revisions[k]);
+            return -1;
+        }
+
+    /* both histories are the same up to their common ancestor (or the older commit on it). */
+    long base = -1;
+    if (branches[0] == branches[1])
+        base = (long) (indices[0] < indices[1] ? indices[0] : indices[1]);
+    else {
+        commit_t* ancestor = find_common_ancestor(branches[0], branches[1]);
+        if (ancestor) base = find_index_commit(branches[0], ancestor);
+        if (base > (long) indices[0]) base = (long) indices[0];
+        if (base > (long) indices[1]) base = (long) indices[1];
+    }
+
+    /* compose the deltas in memory and print them as unified diffs. */
+    dyna_t* deltas = delta_op(branches[0], indices[0], branches[1], indices[1], base);
+    _foreach(deltas, delta_t*, delta)
+        printf("--- %s%s\n+++ %s%s\n", delta->existed ? "a/" : "", \
+            delta->existed ? delta->path : "/dev/null", delta->exists ? "b/" : "", \
+            delta->exists ? delta->path : "/dev/null");
+        _foreach_it(delta->lines, const char*, line, j)
+            printf("%s\n", line);
+        _endforeach;
+        free_delta(delta);
+    _endforeach;
+    dyna_free(deltas);
+    return 0;
+}
+
+internal int
+handle_bisect(dyna_t* argument_array) {
+    /* gather the good and bad commits, then the command after 'run'. */
+    const char* revisions[2] = { 0x0, 0x0 }, *command = 0x0;
+    size_t count = 0;
+    bool run = false;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type != E_PARAMETER_TO_ARGUMENT) continue;
+        if (run && !command) command = argument->value;
+        else if (!run && !strcmp(argument->value, "run")) run = true;
+        else if (!run && count < 2) revisions[count++] = argument->value;
+    _endforeach;
+    if (count < 2 || !command) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected a good and a bad commit, and a command to run "
+                                   "(bisect <good> <bad> run <cmd>).\n");
+        return -1;
+    }
+
+    /* both commits must be on the active branch, the good one before the bad one. */
+    branch_t* branches[2];
+    size_t indices[2];
+    for (size_t k = 0; k < 2; k++)
+        if (!resolve_commit(revisions[k], &branches[k], &indices[k]) || \
+            branches[k] != active_branch) {
+            llog(E_LOGGER_LEVEL_ERROR, "commit \'%s\' not found on branch \'%s\'.\n", \
+                revisions[k], active_branch->name);
+            return -1;
+        }
+    if (indices[0] >= indices[1]) {
+        llog(E_LOGGER_LEVEL_ERROR, "the good commit must be older than the bad commit.\n");
+        return -1;
+    }
+
+    /* every probe rewrites the working tree, so nothing may be shelved on it. */
+    dyna_t* shelved_array = collect_shelved(active_branch->name);
+    size_t shelved = shelved_array->length;
+    dyna_free(shelved_array);
+    if (shelved > 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "cannot bisect with %lu change(s) shelved; commit them " \
+            "first.\n", shelved);
+        return -1;
+    }
+
+    /* binary search by index, each probe moves the working tree in one coalesced transition from
+     *  the last probe, so only the paths changed between the two are rewritten. */
+    size_t good = indices[0], bad = indices[1], current = active_branch->head, probes = 0;
+    bool* skipped = calloc(bad - good + 1, sizeof(bool)), aborted = false;
+    while (bad - good > 1) {
+        /* the middle, or the closest commit to it that has not been skipped. */
+        size_t middle = good + (bad - good) / 2, probe = 0;
+        for (size_t d = 0; !probe && d < bad - good; d++) {
+            if (middle + d < bad && !skipped[middle + d - indices[0]]) probe = middle + d;
+            else if (d < middle - good && !skipped[middle - d - indices[0]]) probe = middle - d;
+        }
+        if (!probe)
+            break;
+        char* hash = strsha1(branch_commit(active_branch, probe)->hash);
+        _llog(E_LOGGER_LEVEL_INFO, "bisecting: %lu commit(s) left to test, probing '%s'.\n", \
+            bad - good - 1, strtrm(hash, 12));
+        free(hash);
+        transition_op(active_branch, current, probe);
+        current = probe;
+        probes++;
+
+        /* the command exits with 0 when the probe is good, 125 when it cannot be tested, and any
+         *  other status below 128 when it is bad; a signal (or 128 and above) aborts. */
+        fflush(stdout);
+        int status = system(command);
+        if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) >= 128) {
+            llog(E_LOGGER_LEVEL_ERROR, "'%s' failed to run or was killed (status %d); " \
+                "bisect aborted.\n", command, status);
+            aborted = true;
+            break;
+        }
+        if (WEXITSTATUS(status) == 125) skipped[probe - indices[0]] = true;
+        else if (WEXITSTATUS(status) == 0) good = probe;
+        else bad = probe;
+    }
+    free(skipped);
+
+    /* restore the working tree to the original head. */
+    transition_op(active_branch, current, active_branch->head);
+    if (aborted)
+        return -1;
+    if (bad - good > 1) {
+        char* _good = strsha1(branch_commit(active_branch, good)->hash), \
+            *_bad = strsha1(branch_commit(active_branch, bad)->hash);
+        llog(E_LOGGER_LEVEL_ERROR, "only skipped commits are left to test; the first bad commit " \
+            "is after \'%.12s\', up to \'%.12s\'.\n", _good, _bad);
+        free(_good);
+        free(_bad);
+        return -1;
+    }
+    const commit_t* first = branch_commit(active_branch, bad);
+    char* hash = strsha1(first->hash);
+    printf("\'%s\' is the first bad commit (%s), found in %lu probe(s).\n", hash, \
+        strtrm(first->message, 32), probes);
+    free(hash);
+    return 0;
+}
+
+internal int
+handle_archive(dyna_t* argument_array) {
+    /* gather the commit, and the file to write to (stdout otherwise). */
+    const char* revision = 0x0, *output = 0x0;
+    _foreach_it(argument_array, const argument_t*, argument, i)
+        if (argument->type == E_FLAG_TO_ARGUMENT && argument->details.flag == E_FLAG_ARG_OUTPUT) {
+            const argument_t* next = _get(argument_array, argument_t*, i + 1);
+            output = next->value;
+        }
+        else if (argument->type == E_PARAMETER_TO_ARGUMENT && !revision) {
+            const argument_t* previous = _get(argument_array, argument_t*, i - 1);
+            if (previous->type != E_FLAG_TO_ARGUMENT || previous->details.flag != E_FLAG_ARG_OUTPUT)
+                revision = argument->value;
+        }
+    _endforeach;
+    branch_t* branch = 0x0;
+    size_t idx = 0;
+    if (!revision || !resolve_commit(revision, &branch, &idx)) {
+        llog(E_LOGGER_LEVEL_ERROR, "commit \'%s\' not found.\n", revision ? revision : "");
+        return -1;
+    }
+    FILE* f = output ? fopen(output, "wb") : stdout;
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open \'%s\' for writing.\n", output);
+        return -1;
+    }
+
+    /* reconstruct every file in parallel, then write them out in order of their paths. */
+    const commit_t* commit = branch_commit(branch, idx);
+    dyna_t* entries = tree_op(branch, idx);
+    size_t written = 0;
+    _foreach(entries, tree_entry_t*, entry)
+        if (write_tar_file(f, entry->path, entry->lines, entry->n, commit->rawtime))
+            written++;
+        free_tree_entry(entry);
+    _endforeach;
+    finish_tar(f);
+    if (output) fclose(f);
+    else fflush(f);
+    if (output)
+        _llog(E_LOGGER_LEVEL_INFO, "archived %lu file(s) into \'%s\'.\n", written, output);
+    bool complete = written == entries->length;
+    dyna_free(entries);
+    return complete ? 0 : 1;
+}
+
+internal bool
+create_empty_dir(const char* root) {
+    /* an existing directory must be empty, otherwise it is created (with its parents). */
+    DIR* dir = opendir(root);
+    if (dir) {
+        struct dirent* entry;
+        bool empty = true;
+        while ((entry = readdir(dir)))
+            if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+                empty = false;
+        closedir(dir);
+        if (!empty)
+            llog(E_LOGGER_LEVEL_ERROR, "directory \'%s\' is not empty.\n", root);
+        return empty;
+    }
+    if (fexistpd(root) == -1 || mkdir(root, MKDIR_MOWNER) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "mkdir failed; could not create directory \'%s\'.\n", root);
+        return false;
+    }
+    return true;
+}
+
+internal int
+handle_export_tree(dyna_t* argument_array) {
+    /* gather the commit and the directory. */
+    const char* parameters[2] = { 0x0, 0x0 };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 2)
+            parameters[count++] = argument->value;
+    _endforeach;
+    branch_t* branch = 0x0;
+    size_t idx = 0;
+    if (count < 2 || !resolve_commit(parameters[0], &branch, &idx)) {
+        llog(E_LOGGER_LEVEL_ERROR, "commit \'%s\' not found.\n", parameters[0]);
+        return -1;
+    }
+
+    /* the directory must be new (or empty), nothing in it is ever overwritten. */
+    const char* root = parameters[1];
+    if (!create_empty_dir(root))
+        return -1;
+
+    /* reconstruct and write every file in parallel, the working tree is never locked. */
+    size_t written = export_op(branch, idx, root);
+    _llog(E_LOGGER_LEVEL_INFO, "exported %lu file(s) into \'%s\'.\n", written, root);
+    return 0;
+}
+
+internal int
+handle_sparse(dyna_t* argument_array) {
+    /* gather the mode, and the prefixes after 'set'. */
+    const char* mode = 0x0;
+    dyna_t* prefixes = dyna_create();
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type != E_PARAMETER_TO_ARGUMENT) continue;
+        if (!mode) mode = argument->value;
+        else dyna_push(prefixes, strdup(argument->value));
+    _endforeach;
+
+    /* without a mode, list the prefixes. */
+    if (!mode) {
+        dyna_t* current = read_sparse();
+        if (current->length == 0)
+            printf("sparse checkout is disabled, every path is checked out.\n");
+        _foreach(current, char*, prefix)
+            printf("%s\n", prefix);
+            free(prefix);
+        _endforeach;
+        dyna_free(current);
+        dyna_free(prefixes);
+        return 0;
+    }
+    if ((strcmp(mode, "set") || prefixes->length == 0) && strcmp(mode, "disable")) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected \'set <prefix>...\' or \'disable\'.\n");
+        return -1;
+    }
+
+    /* remember which files at the head were checked out before the prefixes change. */
+    dyna_t* entries = tree_op(active_branch, active_branch->head);
+    bool* included = calloc(entries->length + 1, sizeof *included);
+    _foreach_it(entries, const tree_entry_t*, entry, i)
+        included[i] = sparse_includes(entry->path);
+    _endforeach;
+    if (!strcmp(mode, "disable")) {
+        _foreach(prefixes, char*, prefix)
+            free(prefix);
+        _endforeach;
+        prefixes->length = 0;
+    }
+    write_sparse(prefixes);
+
+    /* then write the files that came into the checkout, and remove the ones that left it. */
+    size_t written = 0, removed = 0;
+    _foreach_it(entries, tree_entry_t*, entry, i)
+        bool include = sparse_includes(entry->path);
+        if (include && !included[i]) {
+            fwritels(entry->path, entry->lines, entry->n);
+            written++;
+        }
+        else if (!include && included[i]) {
+            remove(entry->path);
+            removed++;
+        }
+        free_tree_entry(entry);
+    _endforeach;
+    _llog(E_LOGGER_LEVEL_INFO, "checked out %lu file(s), removed %lu file(s).\n", written, removed);
+    free(included);
+    dyna_free(entries);
+    _foreach(prefixes, char*, prefix)
+        free(prefix);
+    _endforeach;
+    dyna_free(prefixes);
+    return 0;
+}
+
+internal int
+handle_worktree(dyna_t* argument_array) {
+    /* gather the mode, then the directory and branch after 'add'. */
+    const char* parameters[3] = { 0x0, 0x0, 0x0 };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 3)
+            parameters[count++] = argument->value;
+    _endforeach;
+
+    /* without a mode (or with 'list'), list every worktree and its branch. */
+    if (count == 0 || !strcmp(parameters[0], "list")) {
+        dyna_t* worktrees = read_worktrees();
+        _foreach(worktrees, worktree_t*, worktree)
+            printf("%s\t[%s]\n", worktree->root, worktree->branch);
+            free_worktree(worktree);
+        _endforeach;
+        dyna_free(worktrees);
+        return 0;
+    }
+    if (strcmp(parameters[0], "add") || count < 3) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected \'add <dir> <branch>\' or \'list\'.\n");
+        return -1;
+    }
+
+    /* a branch can only be checked out in one worktree at a time. */
+    const char* root = parameters[1], *branch_name = parameters[2];
+    branch_t* branch = get_branch_repository(repository, branch_name);
+    lock_worktrees();
+    char* where = branch == active_branch ? strdup(".") : find_checked_out(branch_name);
+    if (where) {
+        llog(E_LOGGER_LEVEL_ERROR, "branch \'%s\' is already checked out at \'%s\'.\n", \
+            branch_name, where);
+        free(where);
+        return -1;
+    }
+    if (!create_empty_dir(root))
+        return -1;
+
+    /* share the objects and refs, then write the files at the head of the branch. */
+    size_t idx = 0;
+    _foreach_it(repository->branches, const branch_t*, _branch, i)
+        if (_branch == branch) idx = i;
+    _endforeach;
+    if (!create_worktree(root, repository->branches, idx))
+        return -1;
+    size_t written = branch_length(branch) > 0 ? export_op(branch, branch->head, root) : 0;
+    _llog(E_LOGGER_LEVEL_INFO, "added worktree \'%s\' on branch \'%s\' with %lu file(s).\n", \
+        root, branch_name, written);
+    return 0;
+}
+
+internal int
+handle_alternates(dyna_t* argument_array) {
+    /* gather the mode, then the store after 'add'. */
+    const char* parameters[2] = { 0x0, 0x0 };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 2)
+            parameters[count++] = argument->value;
+    _endforeach;
+
+    /* without a mode (or with 'list'), list every alternate object store. */
+    if (count == 0 || !strcmp(parameters[0], "list")) {
+        dyna_t* alternates = read_alternates();
+        _foreach(alternates, char*, alternate)
+            printf("%s\n", alternate);
+            free(alternate);
+        _endforeach;
+        dyna_free(alternates);
+        return 0;
+    }
+    if (strcmp(parameters[0], "add") || count < 2) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected \'add <store>\' or \'list\'.\n");
+        return -1;
+    }
+    if (!add_alternate(parameters[1]))
+        return -1;
+    _llog(E_LOGGER_LEVEL_INFO, "objects missing locally are now read from \'%s\'.\n", \
+        parameters[1]);
+    return 0;
+}
+
+internal int
+handle_dedup(dyna_t* argument_array) {
+    /* the store is the only parameter. */
+    const argument_t* store = 0x0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT) store = argument;
+    _endforeach;
+    if (!store) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected a shared object store to deduplicate into.\n");
+        return -1;
+    }
+
+    /* every object is read from the shared store from now on. */
+    size_t moved = 0, removed = 0;
+    if (!dedup_objects(store->value, &moved, &removed))
+        return -1;
+    _llog(E_LOGGER_LEVEL_INFO, "moved %lu object(s) into \'%s\', removed %lu it already held.\n", \
+        moved, store->value, removed);
+    return 0;
+}
+
+internal int
+handle_push(dyna_t* argument_array) {
+    /* gather the upstream, and the branch (the active one by default); none are read. */
+    bool readonly = false;
+    char* active = read_active_branch_name(&readonly), path[256];
+    const char* parameters[2] = { 0x0, active };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 2)
+            parameters[count++] = argument->value;
+    _endforeach;
+    if (count == 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected an upstream to push to.\n");
+        free(active);
+        return -1;
+    }
+    snprintf(path, 256, ".lit/refs/heads/%s", parameters[1]);
+    if (access(path, F_OK) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "target branch \'%s\' not found.\n", parameters[1]);
+        free(active);
+        return -1;
+    }
+
+    /* the upstream tells us what it has, and we send only the commits after it. */
+    upstream_t* upstream = connect_upstream(parameters[0]);
+    if (!upstream) {
+        free(active);
+        return -1;
+    }
+    fprintf(upstream->out, UPSTREAM_PROTOCOL " receive %s\n", parameters[1]);
+    fflush(upstream->out);
+    size_t sent = 0, received = 0;
+    int moved = 0;
+    char reason[UPSTREAM_REASON_SIZE] = {0}, line[UPSTREAM_REASON_SIZE + 16] = {0};
+    bool pushed = send_branch(upstream->in, upstream->out, parameters[1], &sent, reason);
+    if (pushed && (!fgets(line, sizeof line, upstream->in) || \
+        sscanf(line, "ok %lu %d", &received, &moved) != 2)) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "%s", !strncmp(line, "reject ", 7) ? line + 7 : \
+            "the upstream closed the connection.");
+        reason[strcspn(reason, "\n")] = '\0';
+        pushed = false;
+    }
+    close_upstream(upstream);
+    if (!pushed)
+        llog(E_LOGGER_LEVEL_ERROR, "could not push '%s'; %s\n", parameters[1], reason);
+    else if (sent == 0) {
+        _llog(E_LOGGER_LEVEL_INFO, "\'%s\' is already up to date.\n", parameters[1]);
+    }
+    else {
+        _llog(E_LOGGER_LEVEL_INFO, "pushed %lu commit(s) of \'%s\' to \'%s\'%s.\n", sent, \
+            parameters[1], parameters[0], moved ? "" : " (its head was left as it was)");
+    }
+    free(active);
+    return pushed ? 0 : -1;
+}
+
+internal void
+follow_received(const char* name, const received_t* result) {
+    /* the working tree follows the active branch, if its head followed the tip. */
+    bool readonly = false;
+    char* active = read_active_branch_name(&readonly);
+    bool follow = !result->created && result->moved && !strcmp(active, name);
+    free(active);
+    if (!follow)
+        return;
+
+    /* the head was at the old tip, so only the commits received are applied, oldest first. */
+    dyna_t* hashes = dyna_create(), *commits = dyna_create();
+    history_t* history = open_history(name, result->received);
+    for (const char* hash; (hash = next_history(history, 0x0));)
+        dyna_push(hashes, strdup(hash));
+    close_history(history);
+    transition_t* transition = create_transition();
+    for (size_t i = hashes->length; i > 0; i--) {
+        const char* hash = dyna_get(hashes, i - 1);
+        char path[256];
+        snprintf(path, 256, ".lit/objects/commits/%.2s/%.38s", hash, hash + 2);
+        commit_t* commit = read_commit(path);
+        forward_transition(transition, commit);
+        dyna_push(commits, commit);
+    }
+    apply_transition(transition);
+    _foreach(commits, commit_t*, commit)
+        free_commit(commit);
+    _endforeach;
+    _foreach(hashes, char*, hash)
+        free(hash);
+    _endforeach;
+    dyna_free(commits);
+    dyna_free(hashes);
+}
+
+internal int
+handle_pull(dyna_t* argument_array) {
+    /* if we are in read-only mode, we cannot receive commits. */
+    bool readonly = false;
+    char* active = read_active_branch_name(&readonly);
+    if (readonly) {
+        llog(E_LOGGER_LEVEL_ERROR, "cannot pull changes in read-only mode.\n");
+        free(active);
+        return -1;
+    }
+
+    /* gather the upstream, and the branch (the active one by default). */
+    const char* parameters[2] = { 0x0, active };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 2)
+            parameters[count++] = argument->value;
+    _endforeach;
+    if (count == 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected an upstream to pull from.\n");
+        free(active);
+        return -1;
+    }
+
+    /* we tell the upstream what we have, and it sends only the commits after it. */
+    upstream_t* upstream = connect_upstream(parameters[0]);
+    if (!upstream) {
+        free(active);
+        return -1;
+    }
+    fprintf(upstream->out, UPSTREAM_PROTOCOL " upload %s\n", parameters[1]);
+    fflush(upstream->out);
+    received_t result;
+    bool pulled = receive_branch(upstream->in, upstream->out, parameters[1], true, &result);
+    close_upstream(upstream);
+    if (!pulled)
+        llog(E_LOGGER_LEVEL_ERROR, "could not pull '%s'; %s\n", parameters[1], result.reason);
+    else if (result.received == 0) {
+        _llog(E_LOGGER_LEVEL_INFO, "'%s' is already up to date.\n", parameters[1]);
+    }
+    else {
+        follow_received(parameters[1], &result);
+        _llog(E_LOGGER_LEVEL_INFO, "pulled %lu commit(s) of '%s' from '%s'.\n", \
+            result.received, parameters[1], parameters[0]);
+    }
+    free(active);
+    return pulled ? 0 : -1;
+}
+
+internal int
+handle_bundle(dyna_t* argument_array) {
+    /* gather the mode, the file, the branch (the active one by default) and where to start. */
+    const char* parameters[3] = { 0x0, 0x0, active_branch->name }, *since = 0x0;
+    size_t count = 0;
+    _foreach_it(argument_array, const argument_t*, argument, i)
+        if (argument->type == E_FLAG_TO_ARGUMENT && argument->details.flag == E_FLAG_ARG_SINCE) {
+            const argument_t* next = _get(argument_array, argument_t*, i + 1);
+            since = next->value;
+        }
+        else if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 3) {
+            const argument_t* previous = _get(argument_array, argument_t*, i - 1);
+            if (previous->type != E_FLAG_TO_ARGUMENT || previous->details.flag != E_FLAG_ARG_SINCE)
+                parameters[count++] = argument->value;
+        }
     _endforeach;
+    char reason[UPSTREAM_REASON_SIZE] = {0};
+
+    /* create; the commits after the one given (all of them otherwise) into a single file. */
+    if (count >= 2 && !strcmp(parameters[0], "create")) {
+        branch_t* branch = get_branch_repository(repository, parameters[2]), *found = 0x0;
+        size_t idx = 0, sent = 0;
+        if (since && (!resolve_commit(since, &found, &idx) || idx >= branch_length(branch) || \
+            memcmp(branch_commit(found, idx)->hash, branch_commit(branch, idx)->hash, 20))) {
+            llog(E_LOGGER_LEVEL_ERROR, "commit '%s' not found on branch '%s'.\n", since, \
+                parameters[2]);
+            return -1;
+        }
+        if (!create_bundle(parameters[1], branch, since ? idx + 1 : 0, &sent, reason)) {
+            llog(E_LOGGER_LEVEL_ERROR, "could not bundle '%s'; %s\n", parameters[2], reason);
+            return -1;
+        }
+        _llog(E_LOGGER_LEVEL_INFO, "bundled %lu commit(s) of '%s' into '%s'.\n", sent, \
+            parameters[2], parameters[1]);
+        return 0;
+    }
+
+    /* unbundle; verified before anything is written, then imported like a pull. */
+    if (count >= 2 && !strcmp(parameters[0], "unbundle")) {
+        if (repository->readonly) {
+            llog(E_LOGGER_LEVEL_ERROR, "cannot unbundle changes in read-only mode.\n");
+            return -1;
+        }
+        char name[129] = {0};
+        received_t result;
+        if (!unbundle(parameters[1], repository, true, name, &result)) {
+            llog(E_LOGGER_LEVEL_ERROR, "could not unbundle '%s'; %s\n", parameters[1], \
+                result.reason);
+            return -1;
+        }
+        if (result.received == 0) {
+            _llog(E_LOGGER_LEVEL_INFO, "'%s' is already up to date.\n", name);
+            return 0;
+        }
+        follow_received(name, &result);
+        _llog(E_LOGGER_LEVEL_INFO, "unbundled %lu commit(s) of '%s' from '%s'.\n", \
+            result.received, name, parameters[1]);
+        return 0;
+    }
+    llog(E_LOGGER_LEVEL_ERROR, "expected 'create <file> <branch>' or 'unbundle <file>'.\n");
+    return -1;
+}
+
+internal int
+handle_fast_import() {
+    /* if we are in read-only mode, we cannot import anything. */
+    if (repository->readonly) {
+        llog(E_LOGGER_LEVEL_ERROR, "cannot import changes in read-only mode.\n");
+        return -1;
+    }
 
-    /* print out all the tags (on this branch). */
-    dyna_t* tags = read_tags();
-    tags = filter_tags(active_branch->hash, tags);
-    if (tags->length > 0) {
-        printf("\ntag(s):\n");
-        _foreach(tags, tag_t*, tag)
-            printf("\t\t%s -> %s\n", tag->name, strsha1(tag->commit_hash));
+    /* the stream comes in on stdin; the objects are written as it is read, the refs at the end. */
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    import_stats_t stats;
+    bool imported = fast_import(stdin, repository, &stats);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double) (end.tv_sec - start.tv_sec) + \
+        (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+    _llog(E_LOGGER_LEVEL_INFO, "imported %lu commit(s) and %lu blob(s) onto %lu branch(es), " \
+        "with %lu tag(s), in %.2f s (%.0f commit(s) per minute).\n", stats.commits, stats.blobs, \
+        stats.branches, stats.tags, seconds, seconds > 0 ? stats.commits * 60.0 / seconds : 0.0);
+    if (stats.altered > 0)
+        llog(E_LOGGER_LEVEL_WARNING, "%lu blob(s) were not imported byte for byte (see above).\n", \
+            stats.altered);
+    return imported ? 0 : -1;
+}
+
+internal int
+handle_fast_export(dyna_t* argument_array) {
+    /* the history is streamed from the refs, so nothing is read up front; every branch unless
+     *  some are named. */
+    dyna_t* branches = read_branch_names(), *names = dyna_create();
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT)
+            dyna_push(names, argument->value);
+    _endforeach;
+    _foreach(names, const char*, name)
+        bool found = false;
+        _foreach_it(branches, const char*, branch, j)
+            if (!strcmp(branch, name)) found = true;
         _endforeach;
+        if (!found) {
+            llog(E_LOGGER_LEVEL_ERROR, "branch '%s' not found.\n", name);
+            return -1;
+        }
+    _endforeach;
+
+    /* the stream goes out on stdout, so the counts go to stderr. */
+    export_stats_t stats;
+    bool exported = fast_export(stdout, names->length > 0 ? names : branches, &stats);
+    if (exported)
+        fprintf(stderr, "exported %lu commit(s) and %lu blob(s) of %lu branch(es), with %lu " \
+            "tag(s).\n", stats.commits, stats.blobs, stats.branches, stats.tags);
+    _foreach(branches, char*, branch)
+        free(branch);
+    _endforeach;
+    dyna_free(branches);
+    dyna_free(names);
+    return exported ? 0 : -1;
+}
+
+internal int
+handle_serve_upstream() {
+    /* the request comes in on stdin (a socket), and the replies go back over the same socket. */
+    return serve_upstream_fd(0) ? 0 : -1;
+}
+
+internal int
+handle_server(dyna_t* argument_array) {
+    /* gather the root, the socket and the memory cap of the cache (in MiB). */
+    const char* parameters[3] = { 0x0, 0x0, 0x0 };
+    size_t count = 0;
+    _foreach(argument_array, const argument_t*, argument)
+        if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 3)
+            parameters[count++] = argument->value;
+    _endforeach;
+    if (count < 2) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected a root directory and a socket to serve on.\n");
+        return -1;
+    }
+    size_t cache_size = count > 2 ? strtoul(parameters[2], 0x0, 10) << 20 : SERVER_CACHE_SIZE;
+    return run_server(parameters[0], parameters[1], cache_size);
+}
+
+internal int
+handle_clone(dyna_t* argument_array) {
+    /* gather the source, the directory and the depth (if the clone is shallow). */
+    const char* parameters[2] = { 0x0, 0x0 };
+    size_t count = 0, depth = 0;
+    bool shallow = false;
+    _foreach_it(argument_array, const argument_t*, argument, i)
+        if (argument->type == E_FLAG_TO_ARGUMENT && argument->details.flag == E_FLAG_ARG_DEPTH) {
+            const argument_t* next = _get(argument_array, argument_t*, i + 1);
+            depth = strtoul(next->value, 0x0, 10);
+            shallow = true;
+        }
+        else if (argument->type == E_PARAMETER_TO_ARGUMENT && count < 2) {
+            const argument_t* previous = _get(argument_array, argument_t*, i - 1);
+            if (previous->type != E_FLAG_TO_ARGUMENT || previous->details.flag != E_FLAG_ARG_DEPTH)
+                parameters[count++] = argument->value;
+        }
+    _endforeach;
+    if (count < 2) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected a repository and a directory to clone into.\n");
+        return -1;
+    }
+    if (shallow && depth == 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "the depth of a shallow clone has to be at least one commit.\n");
+        return -1;
     }
+
+    /* link the objects and copy the refs (or build the shallow base), nothing is checked out yet. */
+    size_t linked = 0, copied = 0;
+    if (!create_empty_dir(parameters[1]) || (shallow ? \
+        !clone_shallow(parameters[0], parameters[1], depth, &linked, &copied) : \
+        !clone_repository(parameters[0], parameters[1], &linked, &copied)))
+        return -1;
+
+    /* then check out the head of the active branch from within the clone, in parallel. */
+    if (chdir(parameters[1]) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "chdir failed; could not enter '%s'.\n", parameters[1]);
+        return -1;
+    }
+    setup(argument_array);
+    size_t written = branch_length(active_branch) > 0 ? \
+        export_op(active_branch, active_branch->head, ".") : 0;
+    _llog(E_LOGGER_LEVEL_INFO, "cloned '%s' into '%s'; %lu object(s) linked, %lu copied, " \
+        "%lu file(s) checked out.\n", parameters[0], parameters[1], linked, copied, written);
     return 0;
 }
 
@@ -213,12 +1176,13 @@ handle_commit(dyna_t* argument_array) {
     dyna_free(shelved_array);
 
     /* add the commit to the active branch history. */
-    dyna_push(active_branch->commits, commit);
+    commit->generation = branch_length(active_branch) + 1;
+    branch_push(active_branch, commit);
     write_commit(commit);
 
-    /* set the active|head commit index to the new commit and write. */
-    active_branch->head = active_branch->commits->length - 1;
-    write_branch(active_branch);
+    /* set the active|head commit index to the new commit and append it to the ref. */
+    active_branch->head = branch_length(active_branch) - 1;
+    append_branch(active_branch, 1);
 
     /* remove the staging directory. */
     char path[256];
@@ -233,9 +1197,6 @@ handle_commit(dyna_t* argument_array) {
 
 internal int
 handle_cr_move(dyna_t* argument_array) {
-    /* read all the tags in the repository. */
-    dyna_t* tags = read_tags();
-
     /* gather the hash or the tag. */
     sha1_t hash = {0};
     _foreach_it(argument_array, const argument_t*, argument, i)
@@ -244,20 +1205,15 @@ handle_cr_move(dyna_t* argument_array) {
             if (argument->details.flag == E_FLAG_ARG_TAG) {
                 const argument_t* next = _get(argument_array, const argument_t*, i + 1);
 
-                /* check if there are any tags. */
-                if (tags->length == 0) {
-                    llog(E_LOGGER_LEVEL_ERROR, "no tags exist in the repository.\n");
+                /* get the tag that matches the value of the parameter. */
+                tag_t* tag = read_tag(next->value);
+                if (!tag) {
+                    llog(E_LOGGER_LEVEL_ERROR, "tag \'%s\' not found.\n", next->value);
                     return -1;
                 }
-
-                /* get the tag that matches the value of the parameter. */
-                _foreach_it(tags, tag_t*, tag, j)
-                    if (!strcmp(tag->name, next->value)) {
-                        memcpy(hash, tag->commit_hash, 20);
-                        break;
-                    }
-                _endforeach;
-                dyna_free(tags);
+                memcpy(hash, tag->commit_hash, 20);
+                free(tag->name);
+                free(tag);
                 break;
             }
         }
@@ -271,7 +1227,7 @@ handle_cr_move(dyna_t* argument_array) {
     /* gather the specific commit ptr. */
     commit_t* target_commit = 0x0;
     size_t target_idx = 0;
-    _foreach_it(active_branch->commits, commit_t*, commit, i)
+    _branch_foreach_it(active_branch, commit_t*, commit, i)
         /* compare the hashes of the commit to see if they match. */
         if (!memcmp(commit->hash, hash, 20)) {
             target_commit = commit;
@@ -280,7 +1236,15 @@ handle_cr_move(dyna_t* argument_array) {
         }
     _endforeach;
 
-    /* if the commit was not found, report the error and return. */
+    /* if the commit was not found, report the error and return; in a shallow repository it may
+     *  only be beyond the boundary. */
+    shallow_t shallow = {0};
+    if (target_commit == 0x0 && shallow_offset(active_branch) > 0 && read_shallow(&shallow)) {
+        llog(E_LOGGER_LEVEL_ERROR, "commit '%s' not found; the history is shallow, it starts " \
+            "at the base '%s' (standing in for %lu earlier commit(s)).\n", strsha1(hash), \
+            strsha1(shallow.base), shallow.offset + 1);
+        return -1;
+    }
     if (target_commit == 0x0) {
         llog(E_LOGGER_LEVEL_ERROR, "commit '%s' not found.\n", strsha1(hash));
         return -1;
@@ -323,12 +1287,12 @@ handle_cr_move(dyna_t* argument_array) {
         }
     }
 
-    /* write and leave. */
+    /* append the moved head to the ref and leave. */
     active_branch->head = target_idx;
-    write_branch(active_branch);
+    append_branch(active_branch, 0);
 
     /* if we are not on the latest commit, set the repository to read-only. */
-    repository->readonly = target_idx != active_branch->commits->length - 1;
+    repository->readonly = target_idx != branch_length(active_branch) - 1;
     write_repository(repository);
 
     /* log a warning if verbose. */
@@ -382,7 +1346,7 @@ internal diff_t*
 find_recent_commit(const char* filename) {
     /* iterate through all commits in this branch. */
     diff_t* recent_commit = 0x0;
-    _inv_foreach_it(active_branch->commits, const commit_t*, commit, i)
+    _branch_inv_foreach_it(active_branch, const commit_t*, commit, i)
         /* search for the file in the commit using its new_path first. */
         _foreach_it(commit->changes, diff_t*, change, j)
             /* if the new_path on a diff is the original file we are looking for, then we need to re-construct it. */
@@ -505,6 +1469,9 @@ handle_add(dyna_t* argument_array) {
 
                 /* iterate through each inode and add it. */
                 _foreach_it(inodes, inode_t*, inode, j)
+                    /* paths outside of a sparse checkout are ignored. */
+                    if (!sparse_includes(inode->path)) continue;
+
                     /* we then need to check if there are any commits before that contain this inode at all. */
                     bool is_new_file = find_recent_commit(inode->name) != 0x0;
                     if (is_new_file) {
@@ -530,6 +1497,10 @@ handle_add(dyna_t* argument_array) {
         /* we add the single folder and we are done. */
         if (filename == 0x0)
             return -1;
+        if (!sparse_includes(filename)) {
+            llog(E_LOGGER_LEVEL_ERROR, "path \'%s\' is outside of the sparse checkout.\n", filename);
+            return -1;
+        }
         diff_t* diff = find_recent_commit(filename);
         bool is_new_file = diff != 0x0;
         if (is_new_file) {
@@ -597,8 +1568,11 @@ handle_create_branch(dyna_t* argument_array) {
                 from_branch_name = strdup(next->value);
             }
         }
-        else if (argument->type == E_PARAMETER_TO_ARGUMENT) {
-            branch_name = strdup(argument->value);
+        else if (argument->type == E_PARAMETER_TO_ARGUMENT && !branch_name) {
+            /* the parameter following --from is the branch name to fork from. */
+            const argument_t* previous = _get(argument_array, argument_t*, i - 1);
+            if (previous->type != E_FLAG_TO_ARGUMENT || previous->details.flag != E_FLAG_ARG_FROM)
+                branch_name = strdup(argument->value);
         }
     _endforeach;
 
@@ -623,6 +1597,15 @@ handle_delete_branch(dyna_t* argument_array) {
         }
     _endforeach;
 
+    /* a branch checked out in another worktree cannot be deleted. */
+    lock_worktrees();
+    char* where = find_checked_out(branch_name);
+    if (where) {
+        llog(E_LOGGER_LEVEL_ERROR, "branch \'%s\' is checked out at \'%s\'.\n", branch_name, where);
+        free(where);
+        return -1;
+    }
+
     /* run the operation. */
     delete_branch_repository(repository, branch_name);
 
@@ -649,6 +1632,16 @@ handle_switch_branch(dyna_t* argument_array) {
         }
     _endforeach;
 
+    /* a branch can only be checked out in one worktree at a time. */
+    lock_worktrees();
+    char* where = find_checked_out(branch_name);
+    if (where) {
+        llog(E_LOGGER_LEVEL_ERROR, "branch \'%s\' is already checked out at \'%s\'.\n", \
+            branch_name, where);
+        free(where);
+        return -1;
+    }
+
     /* run the operation. */
     switch_branch_repository(repository, branch_name);
     _llog(E_LOGGER_LEVEL_INFO, "switched to branch '%s'.\n", branch_name);
@@ -680,6 +1673,33 @@ handle_rebase_branch(dyna_t* argument_array) {
         source_branch_name) == E_REBASE_RESULT_SUCCESS ? 0 : 1;
 }
 
+internal int
+handle_rebase_all(dyna_t* argument_array) {
+    /* find the --onto branch name, every other parameter is a branch to be rebased. */
+    char* onto_branch_name = 0x0;
+    dyna_t* branch_names = dyna_create();
+    _foreach_it(argument_array, const argument_t*, argument, i)
+        if (argument->type == E_FLAG_TO_ARGUMENT && argument->details.flag == E_FLAG_ARG_ONTO) {
+            const argument_t* next = _get(argument_array, argument_t*, i + 1);
+            onto_branch_name = strdup(next->value);
+        }
+        else if (argument->type == E_PARAMETER_TO_ARGUMENT) {
+            const argument_t* previous = _get(argument_array, argument_t*, i - 1);
+            if (previous->type != E_FLAG_TO_ARGUMENT || previous->details.flag != E_FLAG_ARG_ONTO)
+                dyna_push(branch_names, argument->value);
+        }
+    _endforeach;
+    if (onto_branch_name == 0x0) {
+        llog(E_LOGGER_LEVEL_ERROR, "base branch not specified (--onto <name>).\n");
+        exit(-1);
+    }
+
+    /* rebase every branch onto the base provided. */
+    e_rebase_result_t result = branch_rebase_all(repository, onto_branch_name, branch_names);
+    dyna_free(branch_names);
+    return result == E_REBASE_RESULT_SUCCESS ? 0 : 1;
+}
+
 internal int
 handle_clear_cache() {
     /* scan the object cache and clear it. */
@@ -691,8 +1711,8 @@ handle_restore() {
     /* get the current branch we are on, then simply rollback to the first commit
      * and checkout the most recent. */
     commit_t* first, *head;
-    first = dyna_get(active_branch->commits, 0);
-    head = dyna_get(active_branch->commits, active_branch->head);
+    first = branch_commit(active_branch, 0);
+    head = branch_commit(active_branch, active_branch->head);
     rollback_op(active_branch, first);
     checkout_op(active_branch, head);
     return 0;
@@ -715,7 +1735,7 @@ handle_add_tag(dyna_t* argument_array) {
 
     /* iterate over the changes. */
     commit_t* commit = 0x0;
-    _foreach(active_branch->commits, commit_t*, _commit)
+    _branch_foreach(active_branch, commit_t*, _commit)
         /* memcmp the sha1 hashes. */
         if (memcmp(hash, _commit->hash, 20) == 0) {
             commit = _commit;
@@ -739,9 +1759,6 @@ handle_add_tag(dyna_t* argument_array) {
 
 internal int
 handle_delete_tag(dyna_t* argument_array) {
-    /* read all the tags. */
-    dyna_t* tag_array = read_tags();
-
     /* find the tag name */
     char* tag_name = 0x0;
     _foreach(argument_array, const argument_t*, argument)
@@ -756,29 +1773,25 @@ handle_delete_tag(dyna_t* argument_array) {
         return -1;
     }
 
-    /* check if the tag exists. */
-    bool found = false;
-    _foreach(tag_array, const tag_t*, tag)
-        if (!strcmp(tag->name, tag_name))
-            found = true;
-    _endforeach;
-
-    /* if we did not find the tag. */
-    if (!found) {
+    /* remove the tag (loose and packed), if we did not find the tag report it. */
+    if (!delete_tag(tag_name)) {
         llog(E_LOGGER_LEVEL_ERROR, "tag \'%s\' not found.\n", tag_name);
         return -1;
     }
 
-    /* remove the path. */
-    char path[256];
-    snprintf(path, 256, ".lit/refs/tags/%s", tag_name);
-    remove(path);
-
     /* log and return. */
     _llog(E_LOGGER_LEVEL_INFO, "deleted tag \'%s\' from the repository.\n", tag_name);
     return 0;
 }
 
+internal int
+handle_pack_refs() {
+    /* pack every tag into the sorted packed refs. */
+    size_t count = pack_tags();
+    _llog(E_LOGGER_LEVEL_INFO, "packed %lu tag(s) into the repository.\n", count);
+    return 0;
+}
+
 /**
  * @brief handle the arguments passed by the user as a cli (command-line interface) tool.
  *
@@ -803,8 +1816,7 @@ cli_handle(dyna_t* argument_array) {
         }
         /* -l | log to show the status of the repository. */
         case E_PROPER_ARG_LOG: {
-            setup(argument_array);
-            return handle_log();
+            return handle_log(argument_array);
         }
         /* -c | commit to add changes to the repository. */
         case E_PROPER_ARG_COMMIT: {
@@ -848,6 +1860,11 @@ cli_handle(dyna_t* argument_array) {
             setup(argument_array);
             return handle_rebase_branch(argument_array);
         }
+        /* -rA | rebase-all to rebase many branches onto a base in one go. */
+        case E_PROPER_ARG_REBASE_ALL: {
+            setup(argument_array);
+            return handle_rebase_all(argument_array);
+        }
         /* -cc | clear-cache to clear any caches leftover. */
         case E_PROPER_ARG_CLEAR_CACHE: {
             setup(argument_array);
@@ -867,6 +1884,96 @@ cli_handle(dyna_t* argument_array) {
         case E_PROPER_ARG_DELETE_TAG: {
             return handle_delete_tag(argument_array);
         }
+        /* -S | show to print a file as it was at a commit (without moving the working tree). */
+        case E_PROPER_ARG_SHOW: {
+            return handle_show(argument_array);
+        }
+        /* -D | diff to print the changes between two commits (without moving the working tree). */
+        case E_PROPER_ARG_DIFF: {
+            setup(argument_array);
+            return handle_diff(argument_array);
+        }
+        /* -bS | bisect to find the first bad commit by running a command on each probe. */
+        case E_PROPER_ARG_BISECT: {
+            setup(argument_array);
+            return handle_bisect(argument_array);
+        }
+        /* -A | archive to write the files at a commit as a tar stream (the working tree is untouched). */
+        case E_PROPER_ARG_ARCHIVE: {
+            setup(argument_array);
+            return handle_archive(argument_array);
+        }
+        /* -eT | export-tree to write the files at a commit into a new directory. */
+        case E_PROPER_ARG_EXPORT_TREE: {
+            setup(argument_array);
+            return handle_export_tree(argument_array);
+        }
+        /* -sp | sparse to list, set or disable the sparse checkout prefixes. */
+        case E_PROPER_ARG_SPARSE: {
+            setup(argument_array);
+            return handle_sparse(argument_array);
+        }
+        /* -wT | worktree to add or list the worktrees sharing this repository. */
+        case E_PROPER_ARG_WORKTREE: {
+            setup(argument_array);
+            return handle_worktree(argument_array);
+        }
+        /* -aL | alternates to add or list the object stores read from when an object is missing. */
+        case E_PROPER_ARG_ALTERNATES: {
+            setup(argument_array);
+            return handle_alternates(argument_array);
+        }
+        /* -dO | dedup to move the local objects into an object store shared by repositories. */
+        case E_PROPER_ARG_DEDUP: {
+            setup(argument_array);
+            return handle_dedup(argument_array);
+        }
+        /* -pU | push to send the commits of a branch that an upstream does not have yet (straight
+         *  from the refs). */
+        case E_PROPER_ARG_PUSH: {
+            parse_flags(argument_array);
+            return handle_push(argument_array);
+        }
+        /* -pL | pull to fetch the commits of a branch that we do not have yet from an upstream
+         *  (straight into the refs). */
+        case E_PROPER_ARG_PULL: {
+            lock_upstream(true);
+            parse_flags(argument_array);
+            return handle_pull(argument_array);
+        }
+        /* -bU | bundle to write a branch into a bundle file, or to import one (like a pull). */
+        case E_PROPER_ARG_BUNDLE: {
+            lock_upstream(true);
+            setup(argument_array);
+            return handle_bundle(argument_array);
+        }
+        /* -fI | fast-import to import a git fast-export stream (no working tree is written). */
+        case E_PROPER_ARG_FAST_IMPORT: {
+            lock_upstream(true);
+            setup(argument_array);
+            return handle_fast_import();
+        }
+        /* -fE | fast-export to write branches as a git fast-import stream (straight from the refs). */
+        case E_PROPER_ARG_FAST_EXPORT: {
+            return handle_fast_export(argument_array);
+        }
+        /* -sV | server to host every repository under a directory (outside of any repository). */
+        case E_PROPER_ARG_SERVER: {
+            return handle_server(argument_array);
+        }
+        /* -cL | clone to clone a repository on the same host (outside of any repository). */
+        case E_PROPER_ARG_CLONE: {
+            return handle_clone(argument_array);
+        }
+        /* serve-upstream to serve the push or pull of another repository (started by it). */
+        case E_PROPER_ARG_SERVE_UPSTREAM: {
+            return handle_serve_upstream();
+        }
+        /* -pR | pack-refs to pack every tag into the sorted packed refs. */
+        case E_PROPER_ARG_PACK_REFS: {
+            setup(argument_array);
+            return handle_pack_refs();
+        }
         default: {}
     }
     return 0;
@@ -0,0 +1,315 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-22
+ */
+/*!~ @note link and realpath are posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
+#include "clone.h"
+
+/*! @uses fopen, fread, fwrite, fclose, snprintf. */
+#include <stdio.h>
+
+/*! @uses free, realpath. */
+#include <stdlib.h>
+
+/*! @uses strlen, strcmp, strrchr, memcpy. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses stat, mkdir. */
+#include <sys/stat.h>
+
+/*! @uses link, access, chdir, getcwd. */
+#include <unistd.h>
+
+/*! @uses inw_walk, inode_t. */
+#include "inw.h"
+
+/*! @uses WORKTREE_POINTER_PATH. */
+#include "worktree.h"
+
+/*! @uses ALTERNATES_PATH. */
+#include "alternates.h"
+
+/*! @uses shallow_t, write_shallow, SHALLOW_PATH. */
+#include "shallow.h"
+
+/*! @uses repository_t, read_repository, write_repository. */
+#include "repo.h"
+
+/*! @uses tree_op, tree_entry_t, free_tree_entry. */
+#include "ops.h"
+
+/*! @uses create_lines_file_diff. */
+#include "diff.h"
+
+/*! @uses freadls, ffreels, MKDIR_MOWNER, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * @brief copy a file byte for byte.
+ *
+ * @param from the path of the file to be copied.
+ * @param to the path of the copy.
+ * @return true if the file was copied.
+ */
+internal bool
+copy_file(const char* from, const char* to) {
+    FILE* in = fopen(from, "rb"), *out = in ? fopen(to, "wb") : 0x0;
+    bool copied = in && out;
+    char buffer[8192];
+    for (size_t n; copied && (n = fread(buffer, 1, sizeof buffer, in)) > 0;)
+        copied = fwrite(buffer, 1, n, out) == n;
+    if (in) fclose(in);
+    if (out) fclose(out);
+    return copied;
+}
+
+/**
+ * @brief mirror every file under a directory into another, creating the directories on the way;
+ *  each file is hardlinked if <link_files> is set (falling back to a copy), or copied.
+ *
+ * @param from the directory to be mirrored.
+ * @param to the directory to mirror into (it has to exist).
+ * @param link_files if files are hardlinked rather than copied.
+ * @param linked pointer to increment for every file hardlinked.
+ * @param copied pointer to increment for every file copied.
+ * @return true if every file was mirrored.
+ */
+internal bool
+mirror_dir(const char* from, const char* to, bool link_files, size_t* linked, size_t* copied) {
+    /* the walk returns every directory before the files under it. */
+    dyna_t* inodes = inw_walk(from, E_INW_TYPE_RECURSE);
+    size_t length = strlen(from);
+    bool mirrored = true;
+    _foreach(inodes, inode_t*, inode)
+        char path[1024];
+        snprintf(path, 1024, "%s%s", to, inode->path + length);
+        if (inode->type == E_INODE_TYPE_FOLDER)
+            mkdir(path, MKDIR_MOWNER);
+        else if (link_files && link(inode->path, path) == 0)
+            (*linked)++;
+        else if (copy_file(inode->path, path))
+            (*copied)++;
+        else
+            mirrored = false;
+        free(inode->path);
+        free(inode->name);
+        free(inode);
+    _endforeach;
+    dyna_free(inodes);
+    return mirrored;
+}
+
+/**
+ * @brief clone the repository at a path into an empty directory on the same host; the objects are
+ *  immutable, so each one is hardlinked (or copied if it cannot be, across filesystems), while the
+ *  refs, the index and the alternates are copied. the working tree is not written.
+ *
+ * @param source the path of the repository to be cloned.
+ * @param destination the path of the (empty) directory to clone into.
+ * @param linked pointer to store the number of objects hardlinked.
+ * @param copied pointer to store the number of objects copied.
+ * @return true if the repository was cloned.
+ */
+bool
+clone_repository(const char* source, const char* destination, size_t* linked, size_t* copied) {
+    /* assert on the paths and the counts. */
+    assert(source != 0x0 && destination != 0x0);
+    assert(linked != 0x0 && copied != 0x0);
+    *linked = *copied = 0;
+
+    /* a worktree shares its objects and refs through symlinks, and its branches through the
+     *  index of its repository. */
+    char from[1024], to[1024], index[1024];
+    snprintf(index, 1024, "%s/" WORKTREE_POINTER_PATH, source);
+    FILE* pointer = fopen(index, "r");
+    snprintf(index, 1024, "%s/.lit/index", source);
+    if (pointer) {
+        size_t n = 0;
+        char** lines = freadls(pointer, &n);
+        fclose(pointer);
+        if (n > 0) snprintf(index, 1024, "%s/index", lines[0]);
+        ffreels(lines, n);
+    }
+    if (access(index, F_OK) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "\'%s\' is not a repository.\n", source);
+        return false;
+    }
+
+    /* the layout of a new repository. */
+    const char* directories[] = { ".lit", ".lit/objects", ".lit/objects/commits", \
+        ".lit/objects/diffs", ".lit/objects/info", ".lit/refs" };
+    for (size_t i = 0; i < sizeof directories / sizeof *directories; i++) {
+        snprintf(to, 1024, "%s/%s", destination, directories[i]);
+        mkdir(to, MKDIR_MOWNER);
+    }
+
+    /* hardlink the objects, then copy everything that can change. */
+    bool cloned = true;
+    const char* objects[] = { ".lit/objects/commits", ".lit/objects/diffs" };
+    for (size_t i = 0; i < 2; i++) {
+        snprintf(from, 1024, "%s/%s", source, objects[i]);
+        snprintf(to, 1024, "%s/%s", destination, objects[i]);
+        cloned = mirror_dir(from, to, true, linked, copied) && cloned;
+    }
+    size_t _linked = 0, _copied = 0;
+    snprintf(from, 1024, "%s/.lit/refs", source);
+    snprintf(to, 1024, "%s/.lit/refs", destination);
+    cloned = mirror_dir(from, to, false, &_linked, &_copied) && cloned;
+    snprintf(to, 1024, "%s/.lit/index", destination);
+    cloned = copy_file(index, to) && cloned;
+    const char* info[] = { ALTERNATES_PATH, SHALLOW_PATH };
+    for (size_t i = 0; i < 2; i++) {
+        snprintf(from, 1024, "%s/%s", source, info[i]);
+        snprintf(to, 1024, "%s/%s", destination, info[i]);
+        if (access(from, F_OK) == 0)
+            cloned = copy_file(from, to) && cloned;
+    }
+    if (!cloned)
+        llog(E_LOGGER_LEVEL_ERROR, "could not clone every file of \'%s\'.\n", source);
+    return cloned;
+}
+
+/**
+ * @brief hardlink (or copy) a single object of one repository into another, creating the
+ *  directory it is under; an object that is not in the local store of the source is read from
+ *  its alternates, which the clone shares.
+ *
+ * @param source the absolute path of the source repository.
+ * @param destination the absolute path of the clone.
+ * @param path the path of the object, relative to the repositories.
+ * @param linked pointer to increment if the object was hardlinked.
+ * @param copied pointer to increment if the object was copied.
+ * @return true if the object was mirrored (or is in an alternate store).
+ */
+internal bool
+mirror_object(const char* source, const char* destination, const char* path, size_t* linked, \
+    size_t* copied) {
+    char from[1024], to[1024];
+    snprintf(from, 1024, "%s/%s", source, path);
+    snprintf(to, 1024, "%s/%s", destination, path);
+    if (access(from, F_OK) != 0 || access(to, F_OK) == 0)
+        return true;
+    char* slash = strrchr(to, '/');
+    *slash = '\0';
+    mkdir(to, MKDIR_MOWNER);
+    *slash = '/';
+    if (link(from, to) == 0)
+        (*linked)++;
+    else if (copy_file(from, to))
+        (*copied)++;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief clone only the last commits of the active branch of a repository into an empty
+ *  directory; the commits before them are replaced by a single synthetic base commit holding the
+ *  full content of the tree at the newest of them, which is recorded as the shallow boundary.
+ *  the other branches and the tags are not cloned, and the working tree is not written.
+ *
+ * @param source the path of the repository to be cloned.
+ * @param destination the path of the (empty) directory to clone into.
+ * @param depth the number of commits to be cloned (the whole history if there are not more).
+ * @param linked pointer to store the number of objects hardlinked.
+ * @param copied pointer to store the number of objects copied.
+ * @return true if the repository was cloned.
+ */
+bool
+clone_shallow(const char* source, const char* destination, size_t depth, size_t* linked, \
+    size_t* copied) {
+    /* assert on the paths and the counts. */
+    assert(source != 0x0 && destination != 0x0);
+    assert(linked != 0x0 && copied != 0x0);
+    *linked = *copied = 0;
+
+    /* the source is read from within it and the clone written from within it, by absolute path. */
+    char cwd[1024], path[1024];
+    char* from = realpath(source, 0x0), *to = realpath(destination, 0x0);
+    snprintf(path, 1024, "%s/.lit/index", from ? from : source);
+    if (!from || !to || !getcwd(cwd, 1024) || access(path, F_OK) != 0 || chdir(from) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "\'%s\' is not a repository.\n", source);
+        free(from);
+        free(to);
+        return false;
+    }
+    repository_t* repository = read_repository();
+    branch_t* branch = _get(repository->branches, branch_t*, repository->idx);
+    size_t length = branch_length(branch);
+
+    /* a history no longer than the depth is cloned whole. */
+    if (depth >= length) {
+        free(from);
+        free(to);
+        return chdir(cwd) == 0 && clone_repository(source, destination, linked, copied);
+    }
+
+    /* the tree at the boundary, then every object of the commits after it. */
+    size_t boundary = length - depth - 1;
+    dyna_t* entries = tree_op(branch, boundary);
+    const char* directories[] = { ".lit", ".lit/objects", ".lit/objects/commits", \
+        ".lit/objects/diffs", ".lit/objects/info", ".lit/refs", ".lit/refs/heads", ".lit/refs/tags" };
+    for (size_t i = 0; i < sizeof directories / sizeof *directories; i++) {
+        snprintf(path, 1024, "%s/%s", to, directories[i]);
+        mkdir(path, MKDIR_MOWNER);
+    }
+    bool cloned = true;
+    for (size_t i = boundary + 1; i < length; i++) {
+        const commit_t* commit = branch_commit(branch, i);
+        cloned = mirror_object(from, to, commit->path, linked, copied) && cloned;
+        _foreach(commit->changes, const diff_t*, change)
+            char name[16];
+            snprintf(name, 16, "%04u", change->crc);
+            snprintf(path, 1024, ".lit/objects/diffs/%.2s/%s", name, name + 2);
+            cloned = mirror_object(from, to, path, linked, copied) && cloned;
+        _endforeach;
+    }
+    if (access(ALTERNATES_PATH, F_OK) == 0) {
+        snprintf(path, 1024, "%s/" ALTERNATES_PATH, to);
+        cloned = copy_file(ALTERNATES_PATH, path) && cloned;
+    }
+    if (!cloned || chdir(to) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "could not clone every file of \'%s\'.\n", source);
+        free(from);
+        free(to);
+        return false;
+    }
+
+    /* the synthetic base; a new file for every path of the tree at the boundary. */
+    char* hash = strsha1(branch_commit(branch, boundary)->hash);
+    snprintf(path, 1024, "shallow base at %s.", hash);
+    free(hash);
+    commit_t* base = create_commit(path, branch->name);
+    _foreach(entries, tree_entry_t*, entry)
+        dyna_push(base->changes, create_lines_file_diff(entry->path, E_DIFF_FILE_NEW, \
+            entry->lines, entry->n));
+        free_tree_entry(entry);
+    _endforeach;
+    dyna_free(entries);
+    base->generation = branch_commit(branch, boundary)->generation;
+    write_commit(base);
+
+    /* the branch of the clone starts at the base, with the head where it was (or at the base). */
+    branch_t* shallow_branch = create_branch(branch->name);
+    branch_push(shallow_branch, base);
+    for (size_t i = boundary + 1; i < length; i++)
+        branch_push(shallow_branch, read_commit(branch_commit(branch, i)->path));
+    shallow_branch->head = branch->head > boundary ? branch->head - boundary : 0;
+    write_branch(shallow_branch);
+    repository_t clone = { .readonly = repository->readonly, .idx = 0, .branches = dyna_create() };
+    dyna_push(clone.branches, shallow_branch);
+    write_repository(&clone);
+    shallow_t shallow = { .offset = boundary };
+    memcpy(shallow.base, base->hash, 20);
+    write_shallow(&shallow);
+    free(from);
+    free(to);
+    return chdir(cwd) == 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-22
+ */
+#ifndef CLONE_H
+#define CLONE_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/**
+ * @brief clone the repository at a path into an empty directory on the same host; the objects are
+ *  immutable, so each one is hardlinked (or copied if it cannot be, across filesystems), while the
+ *  refs, the index and the alternates are copied. the working tree is not written.
+ *
+ * @param source the path of the repository to be cloned.
+ * @param destination the path of the (empty) directory to clone into.
+ * @param linked pointer to store the number of objects hardlinked.
+ * @param copied pointer to store the number of objects copied.
+ * @return true if the repository was cloned.
+ */
+bool
+clone_repository(const char* source, const char* destination, size_t* linked, size_t* copied);
+
+/**
+ * @brief clone only the last commits of the active branch of a repository into an empty
+ *  directory; the commits before them are replaced by a single synthetic base commit holding the
+ *  full content of the tree at the newest of them, which is recorded as the shallow boundary.
+ *  the other branches and the tags are not cloned, and the working tree is not written.
+ *
+ * @param source the path of the repository to be cloned.
+ * @param destination the path of the (empty) directory to clone into.
+ * @param depth the number of commits to be cloned (the whole history if there are not more).
+ * @param linked pointer to store the number of objects hardlinked.
+ * @param copied pointer to store the number of objects copied.
+ * @return true if the repository was cloned.
+ */
+bool
+clone_shallow(const char* source, const char* destination, size_t depth, size_t* linked, \
+    size_t* copied);
+#endif /* CLONE_H */
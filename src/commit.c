@@ -16,9 +16,12 @@
 /*! @uses time_t, struct tm, time, localtime, strftime. */
 #include <time.h>
 
-/*! @uses strcpy. */
+/*! @uses strcpy, strrchr. */
 #include <string.h>
 
+/*! @uses rmdir. */
+#include <unistd.h>
+
 /*! @uses assert. */
 #include <assert.h>
 
@@ -31,10 +34,25 @@
 /*! @uses llog, E_LOGGER_LEVEL_INFO. */
 #include "log.h"
 
+/*! @uses fopen_object. */
+#include "alternates.h"
+
 /*!~ @note this is a format for the main parts of data that are written at the start (header) of
  *  the file for a commit, stored within a branch, within the repository. */
 #define COMMIT_HEADER_FORMAT "message:%1024[^\n]\ntimestamp:%80[^\n]\nsha1:%40[^\n]\ncount:%lu\nrawtime:%lu\n"
 
+/*!~ @note the generation is optional in the header, commits written before generations were
+ *  tracked do not have it (and are given their position on the branch when read). */
+#define COMMIT_GENERATION_FORMAT "generation:%lu\n"
+
+/*!~ @note the bloom filter of changed paths is optional as well (after the generation), commits
+ *  written before it existed always have to have their diffs read. */
+#define COMMIT_BLOOM_FORMAT "bloom:%64[0-9a-f]\n"
+
+/*!~ @note a commit rewritten by a rebase records the original it was rewritten from (after the
+ *  bloom filter), so that rebasing the same branch again does not replay it a second time. */
+#define COMMIT_REBASED_FORMAT "rebased:%40[0-9a-f]\n"
+
 /**
  * @brief create a new commit with the given message, snapshotting the current state
  *  of your working directory and storing the diffs in the commit.
@@ -69,9 +87,33 @@ create_commit(const char* message, const char* branch_name) {
     unsigned char* data = calloc(1, 2049);
     snprintf((char*)data, 2049, "commit\nmessage=%s\ntimestamp=%s\ndiff count=%p\nrawtime=%lu",
         commit->message, commit->timestamp, &commit->changes, commit->rawtime);
-    sha1(data, 128, commit->hash);
+    hash_commit(commit, data, 128);
     free(data);
 
+    /* return our new commit. */
+    return commit;
+}
+
+/**
+ * @brief set the hash of a commit from some data, and the path it is stored at; the directory of
+ *  a previous path is removed if nothing was stored in it.
+ *
+ * @param commit the commit.
+ * @param data the data the hash is calculated over.
+ * @param n the number of bytes of the data.
+ */
+void
+hash_commit(commit_t* commit, const unsigned char* data, size_t n) {
+    /* assert on the commit and the data. */
+    assert(commit != 0x0);
+    assert(data != 0x0);
+    sha1(data, n, commit->hash);
+    if (commit->path) {
+        *strrchr(commit->path, '/') = '\0';
+        rmdir(commit->path);
+        free(commit->path);
+    }
+
     /* create a directory under our current branch, store all of our diffs
      * in there as well as a commit file. */
     char* path = calloc(1, 257);
@@ -83,9 +125,6 @@ create_commit(const char* message, const char* branch_name) {
     strncpy(commit->path, path, 256);
     free(path);
     free(hash);
-
-    /* return our new commit. */
-    return commit;
 }
 
 /**
@@ -121,10 +160,25 @@ write_commit(const commit_t* commit) {
         exit(EXIT_FAILURE); /* exit on failure. */
     }
 
+    /* the bloom filter of every path changed by the commit. */
+    bloom_t bloom = {0};
+    _foreach(commit->changes, const diff_t*, change)
+        if (change->stored_path) bloom_add_path(&bloom, change->stored_path);
+        if (change->new_path) bloom_add_path(&bloom, change->new_path);
+    _endforeach;
+    char* _bloom = strbloom(&bloom);
+
     /* write the commit information to the file. */
-    fprintf(f, "message:%s\ntimestamp:%s\nsha1:%s\ncount:%lu\nrawtime:%lu\n", \
+    fprintf(f, "message:%s\ntimestamp:%s\nsha1:%s\ncount:%lu\nrawtime:%lu\ngeneration:%lu\n", \
         commit->message, commit->timestamp, strsha1(commit->hash), commit->changes->length,
-        commit->rawtime);
+        commit->rawtime, commit->generation);
+    fprintf(f, "bloom:%s\n", _bloom);
+    free(_bloom);
+    if (commit->has_rebased) {
+        char* rebased = strsha1(commit->rebased);
+        fprintf(f, "rebased:%s\n", rebased);
+        free(rebased);
+    }
 
     /* for each diff in this commit, write out the respective crc32 hash. */
     _foreach(commit->changes, const diff_t*, change)
@@ -134,18 +188,20 @@ write_commit(const commit_t* commit) {
 }
 
 /**
- * @brief read a commit from a file in our '.lit' directory under our current branch.
+ * @brief open a commit file and read its header (and generation if there is one).
  *
  * @param path the path to the commit file.
- * @return a commit_t structure containing the commit information.
+ * @param commit_ptr pointer to store the allocated commit (without any diffs).
+ * @param count pointer to store the number of diffs in the commit.
+ * @return the commit file, positioned after the header.
  */
-commit_t*
-read_commit(const char* path) {
+internal FILE*
+open_commit(const char* path, commit_t** commit_ptr, size_t* count) {
     /* create a temporary commit structure. */
     commit_t* commit = calloc(1 , sizeof *commit);
 
-    /* open the file for reading. */
-    FILE* f = fopen(path, "r");
+    /* open the file for reading, from the local or an alternate object store. */
+    FILE* f = fopen_object(path);
     if (!f) {
         llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open commit file for reading.\n");
         exit(EXIT_FAILURE);
@@ -158,20 +214,159 @@ read_commit(const char* path) {
     char* hash = calloc(1, 41);
     commit->message = calloc(1, 1025);
     commit->timestamp = calloc(1, 81);
-    size_t count = 0;
     int scanned = fscanf(f, COMMIT_HEADER_FORMAT, \
-        commit->message, commit->timestamp, hash, &count, &commit->rawtime);
+        commit->message, commit->timestamp, hash, count, &commit->rawtime);
     if (scanned != 5) {
         llog(E_LOGGER_LEVEL_ERROR,"fscanf failed; could not read commit header.\n");
         exit(EXIT_FAILURE); /* exit on failure. */
     }
     commit->path = strdup(path);
 
+    /* read the generation if there is one, otherwise rewind to the diff hashes. */
+    long position = ftell(f);
+    if (fscanf(f, COMMIT_GENERATION_FORMAT, &commit->generation) != 1) {
+        commit->generation = 0;
+        fseek(f, position, SEEK_SET);
+    }
+
+    /* read the bloom filter if there is one, otherwise rewind to the diff hashes. */
+    position = ftell(f);
+    char bloom[BLOOM_BYTES * 2 + 1] = {0};
+    commit->has_bloom = fscanf(f, COMMIT_BLOOM_FORMAT, bloom) == 1 && \
+        strlen(bloom) == BLOOM_BYTES * 2;
+    if (commit->has_bloom)
+        strtobloom(bloom, &commit->bloom);
+    else
+        fseek(f, position, SEEK_SET);
+
+    /* read the original of a rebased commit if there is one, otherwise rewind again. */
+    position = ftell(f);
+    char rebased[41] = {0};
+    commit->has_rebased = fscanf(f, COMMIT_REBASED_FORMAT, rebased) == 1 && strlen(rebased) == 40;
+    if (commit->has_rebased) {
+        unsigned char* _rebased = strtoha(rebased, 20);
+        memcpy(commit->rebased, _rebased, 20);
+        free(_rebased);
+    }
+    else
+        fseek(f, position, SEEK_SET);
+
     /* this needs to be reversed into a character list based on the values of each char. */
     unsigned char* _hash = strtoha(hash, 20);
     memcpy(commit->hash, _hash, 20);
     free(_hash);
     free(hash);
+    *commit_ptr = commit;
+    return f;
+}
+
+/**
+ * @brief check if a commit may have changed a path (or anything under a directory), from its
+ *  bloom filter alone; commits written without one always may have.
+ *
+ * @param commit the commit (only the header is needed).
+ * @param path the path or directory.
+ * @return false if the commit definitely did not change the path.
+ */
+bool
+commit_may_change(const commit_t* commit, const char* path) {
+    /* assert on the commit and the path. */
+    assert(commit != 0x0);
+    assert(path != 0x0);
+    return !commit->has_bloom || bloom_test(&commit->bloom, path);
+}
+
+/**
+ * @brief check if a path is, or is under, another path.
+ *
+ * @param path the path to be checked.
+ * @param prefix the path or directory.
+ * @return true if <path> is <prefix> or is under it.
+ */
+internal bool
+path_under(const char* path, const char* prefix) {
+    size_t path_length = 0, prefix_length = 0;
+    path = bloom_normalize(path, &path_length);
+    prefix = bloom_normalize(prefix, &prefix_length);
+    if (prefix_length == 0)
+        return true;
+    return path_length >= prefix_length && !strncmp(path, prefix, prefix_length) && \
+        (path_length == prefix_length || path[prefix_length] == '/');
+}
+
+/**
+ * @brief check if a commit changed a path (or anything under a directory), from its diffs.
+ *
+ * @param commit the commit (with its diffs read).
+ * @param path the path or directory.
+ * @return true if one of the diffs of the commit is on the path.
+ */
+bool
+commit_changes(const commit_t* commit, const char* path) {
+    /* assert on the commit and the path. */
+    assert(commit != 0x0);
+    assert(path != 0x0);
+    _foreach(commit->changes, const diff_t*, change)
+        if ((change->stored_path && path_under(change->stored_path, path)) || \
+            (change->new_path && path_under(change->new_path, path)))
+            return true;
+    _endforeach;
+    return false;
+}
+
+/**
+ * @brief free a commit read from disk, including its diffs (if they were read).
+ *
+ * @param commit the commit to be freed.
+ */
+void
+free_commit(commit_t* commit) {
+    /* assert on the commit. */
+    assert(commit != 0x0);
+    _foreach(commit->changes, diff_t*, change)
+        _foreach_it(change->lines, char*, line, j)
+            free(line);
+        _endforeach;
+        dyna_free(change->lines);
+        free(change->stored_path);
+        free(change->new_path);
+        free(change);
+    _endforeach;
+    dyna_free(commit->changes);
+    free(commit->message);
+    free(commit->timestamp);
+    free(commit->path);
+    free(commit);
+}
+
+/**
+ * @brief read only the header of a commit (no diffs are read), for listing commits.
+ *
+ * @param path the path to the commit file.
+ * @return a commit_t structure containing the commit information, with no changes.
+ */
+commit_t*
+read_commit_header(const char* path) {
+    /* open the file, read the header and close. */
+    size_t count = 0;
+    commit_t* commit = 0x0;
+    FILE* f = open_commit(path, &commit, &count);
+    fclose(f);
+    return commit;
+}
+
+/**
+ * @brief read a commit from a file in our '.lit' directory under our current branch.
+ *
+ * @param path the path to the commit file.
+ * @return a commit_t structure containing the commit information.
+ */
+commit_t*
+read_commit(const char* path) {
+    /* open the file and read the header. */
+    size_t count = 0;
+    commit_t* commit = 0x0;
+    FILE* f = open_commit(path, &commit, &count);
 
     /* start reading the file for the count of diffs, then use
      *  the first two chars of the crc32 as the folder and then the
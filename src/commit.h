@@ -17,6 +17,9 @@
 /*! @uses bool, true, false. */
 #include <stdbool.h>
 
+/*! @uses bloom_t. */
+#include "bloom.h"
+
 /**
  * a data structure containing information on a commit, think a list of changes made on disk that
  *  can be tracked to a specific unique identifier; all changes being tracked in one singular
@@ -30,6 +33,11 @@ typedef struct {
     char* path; /* path to the commit directory. */
     char* message; /* commit message. */
     sha1_t hash; /* sha1 hash of the commit. */
+    size_t generation; /* number of commits in the history up to and including this one. */
+    bloom_t bloom; /* bloom filter of the paths changed (and their parent directories). */
+    bool has_bloom; /* whether the commit was written with a bloom filter. */
+    sha1_t rebased; /* hash of the original commit this one was rewritten from by a rebase. */
+    bool has_rebased; /* whether the commit was rewritten by a rebase. */
 } commit_t;
 
 /**
@@ -43,6 +51,17 @@ typedef struct {
 commit_t*
 create_commit(const char* message, const char* branch_name);
 
+/**
+ * @brief set the hash of a commit from some data, and the path it is stored at; the directory of
+ *  a previous path is removed if nothing was stored in it.
+ *
+ * @param commit the commit.
+ * @param data the data the hash is calculated over.
+ * @param n the number of bytes of the data.
+ */
+void
+hash_commit(commit_t* commit, const unsigned char* data, size_t n);
+
 /**
  * @brief write the commit to a file in our '.lit' directory under our current branch.
  *
@@ -59,4 +78,42 @@ write_commit(const commit_t* commit);
  */
 commit_t*
 read_commit(const char* path);
+
+/**
+ * @brief check if a commit may have changed a path (or anything under a directory), from its
+ *  bloom filter alone; commits written without one always may have.
+ *
+ * @param commit the commit (only the header is needed).
+ * @param path the path or directory.
+ * @return false if the commit definitely did not change the path.
+ */
+bool
+commit_may_change(const commit_t* commit, const char* path);
+
+/**
+ * @brief check if a commit changed a path (or anything under a directory), from its diffs.
+ *
+ * @param commit the commit (with its diffs read).
+ * @param path the path or directory.
+ * @return true if one of the diffs of the commit is on the path.
+ */
+bool
+commit_changes(const commit_t* commit, const char* path);
+
+/**
+ * @brief free a commit read from disk, including its diffs (if they were read).
+ *
+ * @param commit the commit to be freed.
+ */
+void
+free_commit(commit_t* commit);
+
+/**
+ * @brief read only the header of a commit (no diffs are read), for listing commits.
+ *
+ * @param path the path to the commit file.
+ * @return a commit_t structure containing the commit information, with no changes.
+ */
+commit_t*
+read_commit_header(const char* path);
 #endif /* COMMIT_H */
\ No newline at end of file
@@ -28,59 +28,15 @@
 /*! @uses llog, E_LOGGER_LEVEL_INFO. */
 #include "log.h"
 
-/*!~ @note this is a format for the main parts of data that are written at the start (header) of
- *  the file for a diff., stored within a commit, stored within a branch, within the repository. */
-#define DIFF_HEADER_FORMAT "type:%d\nstored:%127[^\n]\nnew:%127[^\n]\ncrc32:%u\n"
-
-/**
- * @brief calculate the crc32 hash of a file based on its contents.
- *
- * @param path the path to the file to be hashed.
- * @return a crc32 hash for the file.
- */
-internal ucrc32_t
-file_crc32(const char* path) {
-    /* assert on the path. */
-    assert(path != 0x0);
+/*! @uses compute_hunks, hunk_t. */
+#include "merge.h"
 
-    /* read the file in. */
-    FILE* file = fopen(path, "rb");
-    if (!file) {
-        llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open file for hashing");
-        return 0;
-    }
+/*! @uses fopen_object. */
+#include "alternates.h"
 
-    /* get file size. */
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    if (file_size <= 0) {
-        fclose(file);
-        return 0;
-    }
-
-    /* allocate buffer for file contents. */
-    unsigned char* buffer = calloc(1, file_size);
-    if (!buffer) {
-        llog(E_LOGGER_LEVEL_ERROR,"calloc failed; could not allocate buffer for file.");
-        fclose(file);
-        return 0;
-    }
-
-    /* read file contents. */
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    fclose(file);
-    if (bytes_read != (size_t)file_size) {
-        llog(E_LOGGER_LEVEL_ERROR, "fread; could not read entire file.\n");
-        free(buffer);
-        return 0;
-    }
-
-    /* calculate crc32. */
-    ucrc32_t hash = crc32(buffer, file_size);
-    free(buffer);
-    return hash;
-}
+/*!~ @note this is a format for the main parts of data that are written at the start (header) of
+ *  the file for a diff., stored within a commit, stored within a branch, within the repository. */
+#define DIFF_HEADER_FORMAT "type:%d\nstored:%127[^\n]\nnew:%127[^\n]\ncrc32:%u"
 
 /**
  * @brief create the crc32 hash for a diff given its information
@@ -93,22 +49,28 @@ create_crc32(diff_t* diff) {
     /* assert on the diff ptr. */
     assert(diff != 0x0);
 
-    /* allocate the file and open it. */
-    char* tmp = calloc(1, 256);
-    sprintf(tmp, "%lu.tmp", time(0x0));
-    FILE* ftmp = fopen(tmp, "w");
-
-    /* iterate through each line. */
-    _foreach(diff->lines, char*, line)
-        fprintf(ftmp, "%s\n", line);
-    _endforeach;
-
     /* at the end add some of the diffs data for uniqueness. */
-    fprintf(ftmp, "type:%d\nstored:%s\nnew:%s\nmtime:%lu\n", \
+    char trailer[MAX_LINE_LEN * 2 + 128];
+    int trailer_len = snprintf(trailer, sizeof trailer, "type:%d\nstored:%s\nnew:%s\nmtime:%lu\n", \
         diff->type, diff->stored_path, diff->new_path, time(0x0));
-    fclose(ftmp);
-    diff->crc = file_crc32(tmp);
-    remove(tmp);
+    if (trailer_len >= (int) sizeof trailer)
+        trailer_len = (int) sizeof trailer - 1;
+
+    /* hash the lines in memory, the same bytes as if they were written out line by line. */
+    size_t size = (size_t) trailer_len;
+    _foreach(diff->lines, const char*, line)
+        size += strlen(line) + 1;
+    _endforeach;
+    unsigned char* buffer = calloc(1, size), *p = buffer;
+    _foreach(diff->lines, const char*, line)
+        size_t len = strlen(line);
+        memcpy(p, line, len);
+        p[len] = '\n';
+        p += len + 1;
+    _endforeach;
+    memcpy(p, trailer, trailer_len);
+    diff->crc = crc32(buffer, size);
+    free(buffer);
 }
 
 /**
@@ -136,62 +98,37 @@ append_to_diff(diff_t* diff, const char* fmt, ...) {
 }
 
 /**
- * @brief calculate the longest common subsequence (lcs) between two strings.
+ * @brief calculate the longest common subsequence (lcs) between two files and append the
+ *  unchanged (' '), removed ('- ') and added ('+ ') lines to the diff.
  *
- * @param a the first string.
- * @param m the length of the first string.
- * @param b the second string.
- * @param n the length of the second string.
+ * @param a the lines of the first file.
+ * @param m the number of lines in the first file.
+ * @param b the lines of the second file.
+ * @param n the number of lines in the second file.
  * @param diff the diff_t structure to store the differences.
  */
 internal void
-lcs(char** a, const int m, char** b, const int n, diff_t* diff) {
-    /* assert on all the ptrs. */
-    assert(a != 0x0);
-    assert(b != 0x0);
+lcs(char** a, const size_t m, char** b, const size_t n, diff_t* diff) {
+    /* assert on the diff. */
     assert(diff != 0x0);
 
-    /* @ref[https://en.wikipedia.org/wiki/Longest_common_subsequence] */
-    int **dp = malloc((m+1) * sizeof(int*));
-    for (int i = 0; i <= m; i++)
-        dp[i] = calloc(n+1, sizeof(int));
-
-    /* fill dp table. */
-    for (int i = m-1; i > 0; i--) {
-        for (int j = n-1; j > 0; j--) {
-            if (strcmp(a[i], b[j]) == 0)
-                dp[i][j] = 1 + dp[i+1][j+1];
-            else
-                dp[i][j] = dp[i+1][j] > dp[i][j+1] ? dp[i+1][j] : dp[i][j+1];
-        }
-    }
-
-    /* backtrack to generate diff. */
-    int i = 0, j = 0;
-    while (i < m && j < n) {
-        if (strcmp(a[i], b[j]) == 0) {
-            append_to_diff(diff, "%s", a[i]);
-            i++; j++;
-        } else if (dp[i + 1][j] >= dp[i][j + 1u]) {
-            append_to_diff(diff, "- %s", a[i]);
-            i++;
-        } else {
-            append_to_diff(diff, "+ %s", b[j]);
-            j++;
-        }
-    }
+    /* interleave the hunks with the unchanged lines between them. */
+    dyna_t* hunks = compute_hunks(a, m, b, n);
+    size_t pos = 0;
+    _foreach(hunks, const hunk_t*, hunk)
+        while (pos < hunk->base_start) append_to_diff(diff, " %s", a[pos++]);
+        for (size_t k = 0; k < hunk->base_count; k++)
+            append_to_diff(diff, "- %s", a[hunk->base_start + k]);
+        for (size_t k = 0; k < hunk->other_count; k++)
+            append_to_diff(diff, "+ %s", b[hunk->other_start + k]);
+        pos = hunk->base_start + hunk->base_count;
+    _endforeach;
 
     /* remaining lines. */
-    while (i < m) append_to_diff(diff, "- %s", a[i++]);
-    while (j < n) append_to_diff(diff, "+ %s", b[j++]);
-
-    /* cleanup. */
-    for (int k = 0; k <= m; k++)
-        free(dp[k]);
-    free(dp);
+    while (pos < m) append_to_diff(diff, " %s", a[pos++]);
+    free_hunks(hunks);
 }
 
-
 /**
  * @brief create a file diff between two files (modified only + renaming).
  *
@@ -248,7 +185,7 @@ create_file_modified_diff(const char* old_path, const char* new_path) {
     }
 
     /* use lcs to find the differences and store them in the diff structure. */
-    lcs(old_data, (int) old_size, new_data, (int) new_size, diff);
+    lcs(old_data, old_size, new_data, new_size, diff);
 
     /* write out to a temp file and read the hash, then close and remove it. */
     create_crc32(diff);
@@ -265,6 +202,63 @@ create_file_modified_diff(const char* old_path, const char* new_path) {
     return diff;
 }
 
+/**
+ * @brief create a file diff between two in-memory versions of a file (modified only + renaming).
+ *
+ * @param stored_path the path of the old version of the file.
+ * @param new_path the path of the new version of the file.
+ * @param old_lines the lines of the old version.
+ * @param m the number of lines in the old version.
+ * @param new_lines the lines of the new version.
+ * @param n the number of lines in the new version.
+ * @return a diff_t structure containing the differences between the two versions.
+ */
+diff_t*
+create_lines_modified_diff(const char* stored_path, const char* new_path, char** old_lines, \
+    size_t m, char** new_lines, size_t n) {
+    /* assert on the paths. */
+    assert(stored_path != 0x0);
+    assert(new_path != 0x0);
+
+    /* creating our diff., with the names of the new and old path. */
+    diff_t* diff = calloc(1, sizeof *diff);
+    diff->type = E_DIFF_FILE_MODIFIED;
+    diff->lines = dyna_create();
+    diff->stored_path = strdup(stored_path);
+    diff->new_path = strdup(new_path);
+
+    /* use lcs to find the differences, then hash the diff. */
+    lcs(old_lines, m, new_lines, n, diff);
+    create_crc32(diff);
+    return diff;
+}
+
+/**
+ * @brief create a file diff for a new/deleted file from its in-memory lines.
+ *
+ * @param path the path of the file we are adding/deleting.
+ * @param type enum diff type for either adding or deleting.
+ * @param lines the lines of the file.
+ * @param n the number of lines.
+ * @return a diff_t structure adding (or removing) every line of the file.
+ */
+diff_t*
+create_lines_file_diff(const char* path, e_diff_ty_t type, char** lines, size_t n) {
+    /* assert on the path. */
+    assert(path != 0x0);
+
+    /* creating our diff., every line is added (or removed). */
+    diff_t* diff = calloc(1, sizeof *diff);
+    diff->type = type;
+    diff->lines = dyna_create();
+    diff->stored_path = strdup(path);
+    diff->new_path = strdup(path);
+    for (size_t i = 0; i < n; i++)
+        append_to_diff(diff, type == E_DIFF_FILE_DELETED ? "- %s" : "+ %s", lines[i]);
+    create_crc32(diff);
+    return diff;
+}
+
 /**
  * @brief create a file diff for a new/deleted file.
  *
@@ -346,8 +340,11 @@ write_diff(const diff_t* diff, const char* path) {
     assert(diff != 0x0);
     assert(path != 0x0);
 
-    /* open the file for writing. */
-    FILE* f = fopen(path, "w");
+    /* open a temporary file for writing; it replaces the diff once it is complete, so that an
+     *  object hardlinked into a clone is never written through. */
+    char temporary[272];
+    snprintf(temporary, sizeof temporary, "%s.tmp", path);
+    FILE* f = fopen(temporary, "w");
     if (!f) {
         llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open file for writing.\n");
         exit(EXIT_FAILURE); /* exit on failure. */
@@ -359,17 +356,18 @@ write_diff(const diff_t* diff, const char* path) {
 
     /* if the type is none, or something to do with the folder,
        we haven't written anything, and it can be ignored. */
-    if (diff->type == E_DIFF_TYPE_NONE || diff->type == E_DIFF_FOLDER_NEW || \
-        diff->type == E_DIFF_FOLDER_MODIFIED || diff->type == E_DIFF_FOLDER_DELETED) {
-        fclose(f);
-        return;
+    if (!(diff->type == E_DIFF_TYPE_NONE || diff->type == E_DIFF_FOLDER_NEW || \
+        diff->type == E_DIFF_FOLDER_MODIFIED || diff->type == E_DIFF_FOLDER_DELETED)) {
+        /* then continuously write the lines. */
+        _foreach(diff->lines, char*, line)
+            fprintf(f, "%s\n", line);
+        _endforeach;
     }
-
-    /* then continuously write the lines. */
-    _foreach(diff->lines, char*, line)
-        fprintf(f, "%s\n", line);
-    _endforeach;
     fclose(f);
+    if (rename(temporary, path) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR,"rename failed; could not replace the diff file.\n");
+        exit(EXIT_FAILURE); /* exit on failure. */
+    }
 }
 
 /**
@@ -386,8 +384,8 @@ read_diff(const char* path) {
     /* create a temporary diff structure. */
     diff_t* diff = calloc(1, sizeof *diff);
 
-    /* open the file for reading. */
-    FILE* f = fopen(path, "r");
+    /* open the file for reading, from the local or an alternate object store. */
+    FILE* f = fopen_object(path);
     if (!f) {
         llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open file for reading.\n");
         exit(EXIT_FAILURE); /* exit on failure. */
@@ -413,10 +411,18 @@ read_diff(const char* path) {
         exit(EXIT_FAILURE); /* exit on failure. */
     }
 
+    /* consume the end of the header and the blank line by hand, a trailing '\n' in the format
+     *  would also swallow the leading whitespace of the first line. */
+    int ch = fgetc(f);
+    if (ch != '\n' && ch != EOF) ungetc(ch, f);
+    ch = fgetc(f);
+    if (ch != '\n' && ch != EOF) ungetc(ch, f);
+
     /* if the type is none, or something to do with the folder,
        we haven't written anything, and it can be ignored. */
     if (diff->type == E_DIFF_TYPE_NONE || diff->type == E_DIFF_FOLDER_NEW || \
         diff->type == E_DIFF_FOLDER_MODIFIED || diff->type == E_DIFF_FOLDER_DELETED) {
+        fclose(f);
         return diff;
     }
 
@@ -48,6 +48,33 @@ typedef struct {
 diff_t*
 create_file_modified_diff(const char* old_path, const char* new_path);
 
+/**
+ * @brief create a file diff between two in-memory versions of a file (modified only + renaming).
+ *
+ * @param stored_path the path of the old version of the file.
+ * @param new_path the path of the new version of the file.
+ * @param old_lines the lines of the old version.
+ * @param m the number of lines in the old version.
+ * @param new_lines the lines of the new version.
+ * @param n the number of lines in the new version.
+ * @return a diff_t structure containing the differences between the two versions.
+ */
+diff_t*
+create_lines_modified_diff(const char* stored_path, const char* new_path, char** old_lines, \
+    size_t m, char** new_lines, size_t n);
+
+/**
+ * @brief create a file diff for a new/deleted file from its in-memory lines.
+ *
+ * @param path the path of the file we are adding/deleting.
+ * @param type enum diff type for either adding or deleting.
+ * @param lines the lines of the file.
+ * @param n the number of lines.
+ * @return a diff_t structure adding (or removing) every line of the file.
+ */
+diff_t*
+create_lines_file_diff(const char* path, e_diff_ty_t type, char** lines, size_t n);
+
 /**
  * @brief create a file diff for a new/deleted file.
  *
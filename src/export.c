@@ -0,0 +1,357 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-26
+ */
+#include "export.h"
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strlen, strcspn, strdup, memset. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses SIZE_MAX. */
+#include <stdint.h>
+
+/*! @uses ref_reader_t, open_ref_reader, next_ref_hash, close_ref_reader. */
+#include "branch.h"
+
+/*! @uses commit_t, read_commit, free_commit. */
+#include "commit.h"
+
+/*! @uses diff_t, E_DIFF_FILE_NEW, E_DIFF_FILE_MODIFIED, ... */
+#include "diff.h"
+
+/*! @uses tag_t, read_tags, index_tags. */
+#include "tag.h"
+
+/*! @uses hmap_t, hmap_create, hmap_put, hmap_get, hmap_free. */
+#include "hmap.h"
+
+/*! @uses fforwardls, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * a data structure for a run of commits of a branch that were given consecutive marks.
+ */
+typedef struct {
+    size_t start; /* index of the first commit of the run in the history of the branch. */
+    size_t count; /* number of commits in the run. */
+    size_t mark; /* mark of the first commit of the run. */
+} export_run_t;
+
+/**
+ * a data structure for a branch being exported; read from the header of its ref only.
+ */
+typedef struct {
+    char* name; /* name of the branch. */
+    char* parent; /* name of the branch this branch was forked from (0x0 if none). */
+    size_t fork; /* number of commits inherited from the parent (up to the fork point). */
+    size_t end; /* every owned commit before this index in the history has been exported. */
+    dyna_t* runs; /* array of export_run_t, for the owned commits that have been exported. */
+} export_branch_t;
+
+/**
+ * a data structure for the state of an export; only the branches and the tags are kept, never
+ *  any of the commits.
+ */
+typedef struct {
+    FILE* out; /* stream the commands are written to. */
+    hmap_t* branches; /* hashed map of branch names to export_branch_t. */
+    hmap_t* tags; /* hashed map of commit hash strings to dynamic arrays of tags. */
+    size_t mark; /* last mark given to a commit. */
+    export_stats_t* stats; /* counts of the export. */
+} exporter_t;
+
+/**
+ * @brief find a branch of the export by name, reading the header of its ref the first time.
+ *
+ * @param exporter the state of the export.
+ * @param name the name of the branch.
+ * @return the branch.
+ */
+internal export_branch_t*
+find_branch(exporter_t* exporter, const char* name) {
+    export_branch_t* branch = hmap_get(exporter->branches, name);
+    if (branch)
+        return branch;
+    ref_reader_t* reader = open_ref_reader(name);
+    branch = calloc(1, sizeof *branch);
+    branch->name = strdup(name);
+    branch->parent = reader->parent ? strdup(reader->parent) : 0x0;
+    branch->fork = branch->end = reader->fork;
+    branch->runs = dyna_create();
+    close_ref_reader(reader);
+    hmap_put(exporter->branches, name, branch);
+    return branch;
+}
+
+/**
+ * @brief get the mark of a commit in the history of a branch, looking through the parents for
+ *  commits before the fork point.
+ *
+ * @param exporter the state of the export.
+ * @param branch the branch.
+ * @param idx the index of the commit in the history of the branch.
+ * @return the mark of the commit, or 0 if it has not been exported.
+ */
+internal size_t
+branch_mark(exporter_t* exporter, const export_branch_t* branch, size_t idx) {
+    for (;;) {
+        _foreach(branch->runs, const export_run_t*, run)
+            if (idx >= run->start && idx < run->start + run->count)
+                return run->mark + (idx - run->start);
+        _endforeach;
+        if (idx >= branch->fork || !branch->parent)
+            return 0;
+        branch = find_branch(exporter, branch->parent);
+    }
+}
+
+/**
+ * @brief write a path of a file command, quoted (c-style) if it could not be read back as is;
+ *  the trailing slash of a folder is dropped.
+ *
+ * @param out the stream to write to.
+ * @param path the path.
+ */
+internal void
+write_path(FILE* out, const char* path) {
+    size_t n = strlen(path);
+    while (n > 1 && path[n - 1] == '/')
+        n--;
+    if (path[0] != '"' && strcspn(path, " \"\\\t\n") >= n) {
+        fprintf(out, "%.*s", (int) n, path);
+        return;
+    }
+    fputc('"', out);
+    for (size_t i = 0; i < n; i++)
+        switch (path[i]) {
+            case ('\n'): fputs("\\n", out); break;
+            case ('\t'): fputs("\\t", out); break;
+            case ('"'):
+            case ('\\'): fputc('\\', out); /* fallthrough */
+            default: fputc(path[i], out);
+        }
+    fputc('"', out);
+}
+
+/**
+ * @brief write the version of a file that a diff writes, inline; every line of the diff is
+ *  kept, apart from the removed ones.
+ *
+ * @param exporter the state of the export.
+ * @param diff the diff that writes the file.
+ */
+internal void
+write_version(exporter_t* exporter, const diff_t* diff) {
+    size_t n = 0, size = 0;
+    char** lines = diff->lines->length > 0 ? \
+        fforwardls((char**) diff->lines->data, diff->lines->length, &n) : 0x0;
+    for (size_t i = 0; i < n; i++)
+        size += strlen(lines[i]) + 1;
+    fputs("M 100644 inline ", exporter->out);
+    write_path(exporter->out, diff->new_path);
+    fprintf(exporter->out, "\ndata %lu\n", size);
+    for (size_t i = 0; i < n; i++) {
+        fprintf(exporter->out, "%s\n", lines[i]);
+        free(lines[i]);
+    }
+    free(lines); /* not ffreels, a diff that only removes lines leaves none. */
+    exporter->stats->blobs++;
+}
+
+/**
+ * @brief write a single commit, and the tags on it; the commit is read, written, and freed.
+ *
+ * @param exporter the state of the export.
+ * @param hash the hash string of the commit.
+ * @param ref the ref the commit is written under.
+ * @param from the mark of the commit before it (0 if it is the first commit of a history).
+ * @return the mark given to the commit.
+ */
+internal size_t
+export_commit(exporter_t* exporter, const char* hash, const char* ref, size_t from) {
+    char path[256];
+    snprintf(path, 256, ".lit/objects/commits/%.2s/%.38s", hash, hash + 2);
+    commit_t* commit = read_commit(path);
+    size_t mark = ++exporter->mark;
+    FILE* out = exporter->out;
+
+    /* the header; a commit without a parent starts the ref over. */
+    if (from == 0)
+        fprintf(out, "reset %s\n", ref);
+    fprintf(out, "commit %s\nmark :%lu\ncommitter lit <> %ld +0000\ndata %lu\n%s\n", ref, mark, \
+        (long) commit->rawtime, strlen(commit->message) + 1, commit->message);
+    if (from > 0)
+        fprintf(out, "from :%lu\n", from);
+
+    /* then the file commands, in the order of the diffs. */
+    _foreach(commit->changes, const diff_t*, diff)
+        switch (diff->type) {
+            case (E_DIFF_FILE_MODIFIED): {
+                if (strcmp(diff->stored_path, diff->new_path) != 0) {
+                    fputs("D ", out);
+                    write_path(out, diff->stored_path);
+                    fputc('\n', out);
+                }
+            } /* fallthrough */
+            case (E_DIFF_FILE_NEW): {
+                write_version(exporter, diff);
+                break;
+            }
+            case (E_DIFF_FILE_DELETED):
+            case (E_DIFF_FOLDER_DELETED): {
+                fputs("D ", out);
+                write_path(out, diff->stored_path);
+                fputc('\n', out);
+                break;
+            }
+            case (E_DIFF_FOLDER_MODIFIED): {
+                if (strcmp(diff->stored_path, diff->new_path) != 0) {
+                    fputs("R ", out);
+                    write_path(out, diff->stored_path);
+                    fputc(' ', out);
+                    write_path(out, diff->new_path);
+                    fputc('\n', out);
+                }
+                break;
+            }
+            default: ; /* empty folders do not exist in a stream. */
+        }
+    _endforeach;
+    fputc('\n', out);
+
+    /* the tags on the commit follow it. */
+    dyna_t* tags = hmap_get(exporter->tags, hash);
+    if (tags) {
+        _foreach(tags, const tag_t*, tag)
+            fprintf(out, "reset refs/tags/%s\nfrom :%lu\n\n", tag->name, mark);
+            exporter->stats->tags++;
+        _endforeach;
+    }
+    free_commit(commit);
+    exporter->stats->commits++;
+    return mark;
+}
+
+/**
+ * @brief export the history of a branch up to an index, oldest first; the commits before the
+ *  fork point through the parent, and then the owned commits not exported yet, straight from the
+ *  ref (each commit continues from the mark of the one before it).
+ *
+ * @param exporter the state of the export.
+ * @param branch the branch.
+ * @param end the index in the history to export up to (SIZE_MAX for all of it).
+ * @param ref the ref the commits are written under.
+ * @return true if the history was exported up to the index.
+ */
+internal bool
+export_branch(exporter_t* exporter, export_branch_t* branch, size_t end, const char* ref) {
+    if (branch->end >= end)
+        return true;
+    if (branch->parent && !export_branch(exporter, find_branch(exporter, branch->parent), \
+        branch->fork, ref))
+        return false;
+
+    /* skip the owned commits exported already. */
+    ref_reader_t* reader = open_ref_reader(branch->name);
+    for (size_t i = branch->fork; i < branch->end && next_ref_hash(reader); i++);
+    const char* hash = 0x0;
+    while (branch->end < end && (hash = next_ref_hash(reader))) {
+        size_t from = branch->end > 0 ? branch_mark(exporter, branch, branch->end - 1) : 0;
+        size_t mark = export_commit(exporter, hash, ref, from);
+
+        /* marks are consecutive while the branch is exported in one go. */
+        export_run_t* last = branch->runs->length > 0 ? \
+            dyna_get(branch->runs, branch->runs->length - 1) : 0x0;
+        if (last && last->start + last->count == branch->end && last->mark + last->count == mark)
+            last->count++;
+        else {
+            export_run_t* run = calloc(1, sizeof *run);
+            run->start = branch->end;
+            run->count = 1;
+            run->mark = mark;
+            dyna_push(branch->runs, run);
+        }
+        branch->end++;
+    }
+    close_ref_reader(reader);
+    if (end != SIZE_MAX && branch->end < end) {
+        llog(E_LOGGER_LEVEL_ERROR, "the ref of \'%s\' ends before the fork point of a branch " \
+            "forked from it.\n", branch->name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief export branches of the repository in our cwd as a git fast-import stream; the history
+ *  is walked once, oldest first, straight from the refs, and every commit is read, written and
+ *  freed before the next one (every diff that writes a path holds its full content).
+ *
+ *  the commits a branch inherits are written once, under the first branch exported that needs
+ *  them, and each branch then continues from the mark of its fork point; the tags on commits
+ *  that were exported follow them.
+ *
+ * @param out the stream to write the commands to.
+ * @param names the names of the branches to be exported.
+ * @param stats pointer to store the counts of the export.
+ * @return true if every branch was exported.
+ */
+bool
+fast_export(FILE* out, dyna_t* names, export_stats_t* stats) {
+    /* assert on the stream, the names and the counts. */
+    assert(out != 0x0 && names != 0x0);
+    assert(stats != 0x0);
+    memset(stats, 0, sizeof *stats);
+    dyna_t* tags = read_tags();
+    exporter_t exporter = { .out = out, .branches = hmap_create(), .tags = index_tags(tags), \
+        .stats = stats };
+
+    /* each branch, then its ref is moved to its tip (wherever its commits were written). */
+    bool exported = true;
+    _foreach(names, const char*, name)
+        export_branch_t* branch = find_branch(&exporter, name);
+        char ref[256];
+        snprintf(ref, 256, "refs/heads/%s", name);
+        if (!export_branch(&exporter, branch, SIZE_MAX, ref)) {
+            exported = false;
+            break;
+        }
+        size_t tip = branch->end > 0 ? branch_mark(&exporter, branch, branch->end - 1) : 0;
+        if (tip > 0)
+            fprintf(out, "reset %s\nfrom :%lu\n\n", ref, tip);
+        stats->branches++;
+    _endforeach;
+    fflush(out);
+
+    /* free the branches and the tags; no commit was kept. */
+    _hmap_foreach(exporter.branches, entry)
+        export_branch_t* branch = entry->value;
+        _foreach(branch->runs, export_run_t*, run)
+            free(run);
+        _endforeach;
+        dyna_free(branch->runs);
+        free(branch->name);
+        free(branch->parent);
+        free(branch);
+    _endforeach;
+    hmap_free(exporter.branches);
+    _hmap_foreach(exporter.tags, entry)
+        dyna_free(entry->value);
+    _endforeach;
+    hmap_free(exporter.tags);
+    _foreach(tags, tag_t*, tag)
+        free(tag->name);
+        free(tag);
+    _endforeach;
+    dyna_free(tags);
+    return exported && !ferror(out);
+}
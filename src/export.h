@@ -0,0 +1,46 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-26
+ */
+#ifndef EXPORT_H
+#define EXPORT_H
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses dyna_t. */
+#include "dyna.h"
+
+/**
+ * a data structure for the counts of a fast-export; what was written to the stream.
+ */
+typedef struct {
+    size_t commits; /* number of commits exported. */
+    size_t blobs; /* number of file versions written (inline, one per path a commit wrote). */
+    size_t branches; /* number of branches exported. */
+    size_t tags; /* number of tags exported. */
+} export_stats_t;
+
+/**
+ * @brief export branches of the repository in our cwd as a git fast-import stream; the history
+ *  is walked once, oldest first, straight from the refs, and every commit is read, written and
+ *  freed before the next one (every diff that writes a path holds its full content).
+ *
+ *  the commits a branch inherits are written once, under the first branch exported that needs
+ *  them, and each branch then continues from the mark of its fork point; the tags on commits
+ *  that were exported follow them.
+ *
+ * @param out the stream to write the commands to.
+ * @param names the names of the branches to be exported.
+ * @param stats pointer to store the counts of the export.
+ * @return true if every branch was exported.
+ */
+bool
+fast_export(FILE* out, dyna_t* names, export_stats_t* stats);
+#endif /* EXPORT_H */
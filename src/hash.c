@@ -167,8 +167,25 @@ crc32(const unsigned char* data, unsigned long size) {
     assert(data != 0x0);
     assert(size > 0);
 
+    return crc32_append(0u, data, size);
+}
+
+/**
+ * @brief continue a crc32 hash over more data; the crc32 of data read in pieces is the same as
+ *  the crc32 of all of it at once (starting from 0).
+ *
+ * @param crc the crc32 of the data before.
+ * @param data pointer to the data to hash.
+ * @param size size of the data in bytes.
+ * @return ucrc32_t of the data before followed by this data.
+ */
+ucrc32_t
+crc32_append(ucrc32_t crc, const unsigned char* data, unsigned long size) {
+    /* assert on the data. */
+    assert(data != 0x0);
+
     /* according to ieee 802.3, @link[https://docs.amd.com/v/u/en-US/xapp209]. */
-    ucrc32_t crc = ~0u;
+    crc = ~crc;
     for (unsigned long i = 0; i < size; i++) {
         crc ^= data[i];
         for (unsigned long j = 0; j < 8; j++) {
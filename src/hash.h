@@ -40,6 +40,18 @@ strsha1(const sha1_t hash);
 ucrc32_t
 crc32(const unsigned char* data, unsigned long size);
 
+/**
+ * @brief continue a crc32 hash over more data; the crc32 of data read in pieces is the same as
+ *  the crc32 of all of it at once (starting from 0).
+ *
+ * @param crc the crc32 of the data before.
+ * @param data pointer to the data to hash.
+ * @param size size of the data in bytes.
+ * @return ucrc32_t of the data before followed by this data.
+ */
+ucrc32_t
+crc32_append(ucrc32_t crc, const unsigned char* data, unsigned long size);
+
 /**
  * @brief convert a crc32 hash to a string representation.
  *
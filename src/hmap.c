@@ -0,0 +1,218 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-12
+ */
+#include "hmap.h"
+
+/*! @uses fprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, free, exit. */
+#include <stdlib.h>
+
+/*! @uses strcmp. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses strdup, internal. */
+#include "utl.h"
+
+/**
+ * @brief hash a string key using 32-bit fnv-1a.
+ *
+ * @param key the string key to be hashed.
+ * @return the 32-bit hash of the key.
+ */
+internal unsigned int
+hash_key(const char* key) {
+    /* @ref[http://www.isthe.com/chongo/tech/comp/fnv/] */
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*) key; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief find the slot for <key>, either the occupied slot or the empty slot it would go in.
+ *
+ * @param map pointer to an allocated hash map (capacity must be non-zero).
+ * @param key the string key to search for.
+ * @param hash the hash of the key.
+ * @return the index of the slot.
+ */
+internal size_t
+find_slot(const hmap_t* map, const char* key, unsigned int hash) {
+    /* capacity is always a power of two, so we can mask instead of mod. */
+    size_t mask = map->capacity - 1, idx = hash & mask;
+    while (map->entries[idx].key) {
+        if (map->entries[idx].hash == hash && !strcmp(map->entries[idx].key, key))
+            return idx;
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+/**
+ * @brief grow the hash map to a new capacity, re-inserting every entry.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param capacity the new capacity (power of two).
+ */
+internal void
+grow(hmap_t* map, size_t capacity) {
+    /* allocate the new slots. */
+    hmap_entry_t* old = map->entries;
+    size_t old_capacity = map->capacity;
+    map->entries = calloc(capacity, sizeof *map->entries);
+    if (!map->entries) {
+        fprintf(stderr, "calloc failed; could not allocate memory for hash map.");
+        exit(EXIT_FAILURE); /* exit on failure. */
+    }
+    map->capacity = capacity;
+
+    /* re-insert every occupied slot (keys are moved, not duplicated). */
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (!old[i].key) continue;
+        map->entries[find_slot(map, old[i].key, old[i].hash)] = old[i];
+    }
+    free(old);
+}
+
+/**
+ * @brief create an empty hash map.
+ *
+ * @return an allocated hash map.
+ */
+hmap_t*
+hmap_create() {
+    /* allocate the map and set all data to be 0. */
+    hmap_t* map = calloc(1, sizeof *map);
+    map->entries = 0x0;
+    map->length = 0;
+    map->capacity = 0;
+    return map;
+}
+
+/**
+ * @brief destroying / freeing a hash map, including its keys (not the values).
+ *
+ * @param map pointer to an allocated hash map.
+ */
+void
+hmap_free(hmap_t* map) {
+    /* assert if the map is 0x0. */
+    assert(map != 0x0);
+
+    /* free each key, then the slots. */
+    for (size_t i = 0; i < map->capacity; i++)
+        free(map->entries[i].key);
+    free(map->entries);
+    free(map);
+}
+
+/**
+ * @brief insert or replace a value in the hash map under <key>.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key (duplicated if it is new).
+ * @param value the value to be stored.
+ * @return the value previously stored under <key>, or 0x0 if there was none.
+ */
+void*
+hmap_put(hmap_t* map, const char* key, void* value) {
+    /* assert if the map or key == 0x0. */
+    assert(map != 0x0 && key != 0x0);
+
+    /* keep the load factor under 3/4. */
+    if ((map->length + 1) * 4 > map->capacity * 3)
+        grow(map, map->capacity == 0 ? 16 : map->capacity * 2);
+
+    /* find the slot and replace if it is already occupied. */
+    unsigned int hash = hash_key(key);
+    hmap_entry_t* entry = &map->entries[find_slot(map, key, hash)];
+    if (entry->key) {
+        void* previous = entry->value;
+        entry->value = value;
+        return previous;
+    }
+    *entry = (hmap_entry_t) {
+        .key = strdup(key),
+        .value = value,
+        .hash = hash,
+    };
+    map->length++;
+    return 0x0;
+}
+
+/**
+ * @brief get the value stored under <key> in the hash map.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key to search for.
+ * @return the value stored, or 0x0 if the key does not exist.
+ */
+void*
+hmap_get(const hmap_t* map, const char* key) {
+    /* assert if the map or key == 0x0. */
+    assert(map != 0x0 && key != 0x0);
+    if (map->length == 0)
+        return 0x0;
+    return map->entries[find_slot(map, key, hash_key(key))].value;
+}
+
+/**
+ * @brief check if <key> exists in the hash map (regardless of its value).
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key to search for.
+ * @return true if the key exists in the hash map.
+ */
+bool
+hmap_has(const hmap_t* map, const char* key) {
+    /* assert if the map or key == 0x0. */
+    assert(map != 0x0 && key != 0x0);
+    if (map->length == 0)
+        return false;
+    return map->entries[find_slot(map, key, hash_key(key))].key != 0x0;
+}
+
+/**
+ * @brief remove <key> from the hash map, shifting back any probed entries.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key to remove.
+ * @return the value that was stored, or 0x0 if the key did not exist.
+ */
+void*
+hmap_remove(hmap_t* map, const char* key) {
+    /* assert if the map or key == 0x0. */
+    assert(map != 0x0 && key != 0x0);
+    if (map->length == 0)
+        return 0x0;
+
+    /* find the slot, if it is empty there is nothing to remove. */
+    size_t mask = map->capacity - 1, idx = find_slot(map, key, hash_key(key));
+    if (!map->entries[idx].key)
+        return 0x0;
+    void* value = map->entries[idx].value;
+    free(map->entries[idx].key);
+    map->entries[idx].key = 0x0;
+    map->length--;
+
+    /* backward shift deletion; move any entry that probed past the hole back into it. */
+    size_t hole = idx, next = (idx + 1) & mask;
+    while (map->entries[next].key) {
+        size_t home = map->entries[next].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            map->entries[hole] = map->entries[next];
+            map->entries[next].key = 0x0;
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    return value;
+}
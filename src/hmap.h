@@ -0,0 +1,98 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-12
+ */
+#ifndef HMAP_H
+#define HMAP_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/**
+ * a data structure for a single slot in a hash map, the key is owned by the map (duplicated on
+ *  insertion), the value is not; a slot with a key of 0x0 is considered empty.
+ */
+typedef struct {
+    char* key; /* owned string key, 0x0 if the slot is empty. */
+    void* value; /* value stored under the key (can be 0x0 for sets). */
+    unsigned int hash; /* cached hash of the key. */
+} hmap_entry_t;
+
+/**
+ * a data structure for a string keyed hash map using open addressing (linear probing); it can
+ *  also be used as a hash set by storing 0x0 values and checking with @ref hmap_has().
+ */
+typedef struct {
+    hmap_entry_t* entries; /* array of slots. */
+    size_t length, capacity; /* length (count) and capacity of the hash map. */
+} hmap_t;
+
+/**
+ * @brief create an empty hash map.
+ *
+ * @return an allocated hash map.
+ */
+hmap_t*
+hmap_create();
+
+/**
+ * @brief destroying / freeing a hash map, including its keys (not the values).
+ *
+ * @param map pointer to an allocated hash map.
+ */
+void
+hmap_free(hmap_t* map);
+
+/**
+ * @brief insert or replace a value in the hash map under <key>.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key (duplicated if it is new).
+ * @param value the value to be stored.
+ * @return the value previously stored under <key>, or 0x0 if there was none.
+ */
+void*
+hmap_put(hmap_t* map, const char* key, void* value);
+
+/**
+ * @brief get the value stored under <key> in the hash map.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key to search for.
+ * @return the value stored, or 0x0 if the key does not exist.
+ */
+void*
+hmap_get(const hmap_t* map, const char* key);
+
+/**
+ * @brief check if <key> exists in the hash map (regardless of its value).
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key to search for.
+ * @return true if the key exists in the hash map.
+ */
+bool
+hmap_has(const hmap_t* map, const char* key);
+
+/**
+ * @brief remove <key> from the hash map, shifting back any probed entries.
+ *
+ * @param map pointer to an allocated hash map.
+ * @param key the string key to remove.
+ * @return the value that was stored, or 0x0 if the key did not exist.
+ */
+void*
+hmap_remove(hmap_t* map, const char* key);
+
+/* starting an iteration over every occupied slot. */
+#define _hmap_foreach_it(map, var, iter) \
+    for (size_t iter = 0; iter < (map)->capacity; iter++) { \
+        if (!(map)->entries[iter].key) continue; \
+        hmap_entry_t* var = &(map)->entries[iter];
+
+/* starting an iteration over every occupied slot. */
+#define _hmap_foreach(map, var) _hmap_foreach_it(map, var, i)
+#endif /* HMAP_H */
@@ -0,0 +1,866 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-25
+ */
+/*!~ @note getline, fmemopen and open_memstream are posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
+#include "import.h"
+
+/*! @uses calloc, free, strtoul, strtol. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strncmp, strlen, strchr, strrchr, strcspn, strdup, strndup, memset, memchr. */
+#include <string.h>
+
+/*! @uses access, F_OK. */
+#include <unistd.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses time_t, struct tm, localtime, strftime. */
+#include <time.h>
+
+/*! @uses branch_t, create_branch, write_branch, branch_push, branch_length, branch_commit. */
+#include "branch.h"
+
+/*! @uses commit_t, create_commit, hash_commit, write_commit. */
+#include "commit.h"
+
+/*! @uses diff_t, create_lines_file_diff, create_lines_modified_diff. */
+#include "diff.h"
+
+/*! @uses tag_t, create_tag, write_tag. */
+#include "tag.h"
+
+/*! @uses hmap_t, hmap_create, hmap_put, hmap_get, hmap_remove. */
+#include "hmap.h"
+
+/*! @uses freadls, fexistpd, internal, MAX_LINE_LEN. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * a data structure for a blob of the stream; where it was spilled to, and its size.
+ */
+typedef struct {
+    long offset; /* offset of the blob in the spill file. */
+    size_t size; /* size of the blob. */
+    const char* altered; /* why its lines are not its exact bytes (0x0 if they are). */
+    bool reported; /* if a path it was imported at was reported. */
+} blob_t;
+
+/**
+ * a data structure for a change of a path by an imported commit; enough to undo it on a tree.
+ */
+typedef struct {
+    char* path; /* path that was changed. */
+    blob_t* old; /* version before the commit (0x0 if the path did not exist). */
+} change_t;
+
+struct import_line;
+
+/**
+ * a data structure for an imported commit; the line that owns it, its index on that line, and the
+ *  changes it made (to find the tree at it when another line forks from it).
+ */
+typedef struct {
+    struct import_line* owner; /* line the commit is on. */
+    size_t idx; /* index of the commit on the line. */
+    dyna_t* changes; /* allocated change_t of the commit, in order. */
+} import_commit_t;
+
+/**
+ * a data structure for a line of history being imported (a branch once it is named); its tree at
+ *  the tip (every path to its version), and the commits it owns.
+ */
+typedef struct import_line {
+    branch_t* branch; /* the branch, named once the stream ends. */
+    hmap_t* tree; /* path to blob_t of every file at the tip. */
+    import_commit_t* tip; /* last commit of the line (0x0 if it has none). */
+    dyna_t* commits; /* import_commit_t owned by the line, in order. */
+    char* ref; /* ref of the first commit of the line. */
+    bool named; /* if the line was named after a ref. */
+} import_line_t;
+
+/**
+ * a data structure for the state of an import; the stream, the spill file, the marks, the refs
+ *  and the lines.
+ */
+typedef struct {
+    FILE* in; /* stream the commands are read from. */
+    char* line; /* last line read (without its newline). */
+    size_t capacity; /* capacity of the line. */
+    bool unread; /* if the last line is to be read again. */
+    FILE* blobs; /* spill file of the blobs. */
+    hmap_t* blob_marks; /* mark to blob_t. */
+    hmap_t* commit_marks; /* mark to import_commit_t. */
+    hmap_t* refs; /* ref to the import_commit_t it is at (0x0 if it was reset to nothing). */
+    dyna_t* ref_order; /* allocated names of the refs, in the order they were first set. */
+    dyna_t* lines; /* import_line_t in the order they were started. */
+    dyna_t* tags; /* tag_t to be written. */
+    repository_t* repository; /* repository imported into. */
+    import_stats_t* stats; /* counts of the import. */
+} importer_t;
+
+/**
+ * @brief read the next line of the stream (or the last one again if it was unread).
+ *
+ * @param importer the state of the import.
+ * @return the line without its newline, or 0x0 at the end of the stream.
+ */
+internal char*
+next_line(importer_t* importer) {
+    if (importer->unread) {
+        importer->unread = false;
+        return importer->line;
+    }
+    ssize_t length = getline(&importer->line, &importer->capacity, importer->in);
+    if (length < 0)
+        return 0x0;
+    if (length > 0 && importer->line[length - 1] == '\n')
+        importer->line[length - 1] = '\0';
+    return importer->line;
+}
+
+/**
+ * @brief read the data of a command ('data <size>' then exactly that many bytes).
+ *
+ * @param importer the state of the import.
+ * @param size pointer to store the size of the data.
+ * @return the allocated data (with a terminator), or 0x0 if the stream is malformed.
+ */
+internal char*
+read_data(importer_t* importer, size_t* size) {
+    char* line = next_line(importer);
+    if (!line || strncmp(line, "data ", 5) || !strncmp(line, "data <<", 7)) {
+        llog(E_LOGGER_LEVEL_ERROR, "expected 'data <size>' in the stream.\n");
+        return 0x0;
+    }
+    *size = strtoul(line + 5, 0x0, 10);
+    char* data = calloc(1, *size + 1);
+    if (fread(data, 1, *size, importer->in) != *size) {
+        llog(E_LOGGER_LEVEL_ERROR, "the stream ended within the data of a command.\n");
+        free(data);
+        return 0x0;
+    }
+
+    /* the newline after the data is optional. */
+    int ch = fgetc(importer->in);
+    if (ch != '\n' && ch != EOF) ungetc(ch, importer->in);
+    return data;
+}
+
+/**
+ * @brief spill a blob to the end of the spill file, noting if its lines will not be its bytes.
+ *
+ * @param importer the state of the import.
+ * @param data the bytes of the blob.
+ * @param size the size of the blob.
+ * @return the allocated blob.
+ */
+internal blob_t*
+spill_blob(importer_t* importer, const char* data, size_t size) {
+    blob_t* blob = calloc(1, sizeof *blob);
+    fseek(importer->blobs, 0, SEEK_END);
+    blob->offset = ftell(importer->blobs);
+    blob->size = size;
+    fwrite(data, 1, size, importer->blobs);
+    importer->stats->blobs++;
+
+    /* a file is kept as lines of text (read back by freadls), so some blobs cannot be kept byte
+     *  for byte; they are still imported, but reported once they are. */
+    if (memchr(data, '\0', size))
+        blob->altered = "it holds NUL bytes, the lines are cut at them";
+    else if (size > 0 && data[size - 1] != '\n')
+        blob->altered = "it does not end in a newline, one is added";
+    for (size_t i = 0, start = 0; !blob->altered && i < size; i++) {
+        if (data[i] != '\n') continue;
+        if (i - start > MAX_LINE_LEN - 1)
+            blob->altered = "it has lines longer than lit keeps, they are cut";
+        start = i + 1;
+    }
+    return blob;
+}
+
+/**
+ * @brief read a blob back from the spill file, as lines.
+ *
+ * @param importer the state of the import.
+ * @param blob the blob.
+ * @param n pointer to store the number of lines.
+ * @return the allocated lines.
+ */
+internal char**
+blob_lines(importer_t* importer, const blob_t* blob, size_t* n) {
+    *n = 0;
+    if (blob->size == 0)
+        return calloc(1, sizeof(char*));
+    char* data = calloc(1, blob->size + 1);
+    fseek(importer->blobs, blob->offset, SEEK_SET);
+    size_t read = fread(data, 1, blob->size, importer->blobs);
+    FILE* f = fmemopen(data, read, "r");
+    char** lines = freadls(f, n);
+    fclose(f);
+    free(data);
+    return lines;
+}
+
+/**
+ * @brief free lines read from a blob.
+ *
+ * @param lines the lines.
+ * @param n the number of lines.
+ */
+internal void
+free_blob_lines(char** lines, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        free(lines[i]);
+    free(lines);
+}
+
+/**
+ * @brief parse a path of a file command; quoted paths are unescaped (in place).
+ *
+ * @param path the start of the path.
+ * @param rest pointer to store the start of what follows the path (0x0 if the path is the rest
+ *  of the line).
+ * @return the path.
+ */
+internal char*
+parse_path(char* path, char** rest) {
+    if (*path != '"') {
+        char* space = rest ? strchr(path, ' ') : 0x0;
+        if (space) {
+            *space = '\0';
+            *rest = space + 1;
+        }
+        return path;
+    }
+    char* from = path + 1, *to = path;
+    while (*from && *from != '"') {
+        if (*from != '\\') {
+            *to++ = *from++;
+            continue;
+        }
+        from++;
+        if (*from >= '0' && *from <= '7') {
+            unsigned int octal = 0;
+            for (int k = 0; k < 3 && *from >= '0' && *from <= '7'; k++)
+                octal = octal * 8 + (unsigned int) (*from++ - '0');
+            *to++ = (char) octal;
+            continue;
+        }
+        switch (*from) {
+            case 'n': *to++ = '\n'; break;
+            case 't': *to++ = '\t'; break;
+            case 'a': *to++ = '\a'; break;
+            case 'b': *to++ = '\b'; break;
+            case 'f': *to++ = '\f'; break;
+            case 'r': *to++ = '\r'; break;
+            case 'v': *to++ = '\v'; break;
+            default: *to++ = *from;
+        }
+        if (*from) from++;
+    }
+    if (rest) *rest = *from == '"' && from[1] == ' ' ? from + 2 : 0x0;
+    *to = '\0';
+    return path;
+}
+
+/**
+ * @brief the name of the branch of a ref ('refs/heads/<name>', or the ref without 'refs/').
+ *
+ * @param ref the ref.
+ * @return the name within the ref.
+ */
+internal const char*
+ref_branch_name(const char* ref) {
+    if (!strncmp(ref, "refs/heads/", 11))
+        return ref + 11;
+    return !strncmp(ref, "refs/", 5) ? ref + 5 : ref;
+}
+
+/**
+ * @brief resolve the mark of a commit (':<mark>').
+ *
+ * @param importer the state of the import.
+ * @param mark the mark.
+ * @return the commit, or 0x0 if the mark is not a known commit.
+ */
+internal import_commit_t*
+resolve_mark(importer_t* importer, const char* mark) {
+    import_commit_t* commit = *mark == ':' ? hmap_get(importer->commit_marks, mark) : 0x0;
+    if (!commit)
+        llog(E_LOGGER_LEVEL_ERROR, "'%s' is not the mark of an imported commit.\n", mark);
+    return commit;
+}
+
+/**
+ * @brief set a ref to a commit (or to nothing).
+ *
+ * @param importer the state of the import.
+ * @param ref the ref.
+ * @param commit the commit (0x0 for nothing).
+ */
+internal void
+set_ref(importer_t* importer, const char* ref, import_commit_t* commit) {
+    if (!hmap_has(importer->refs, ref))
+        dyna_push(importer->ref_order, strdup(ref));
+    hmap_put(importer->refs, ref, commit);
+}
+
+/**
+ * @brief start a line of history, forked from a commit (or from nothing).
+ *
+ * @param importer the state of the import.
+ * @param ref the ref of the first commit of the line.
+ * @param from the commit the line starts from (0x0 for none).
+ * @return the line.
+ */
+internal import_line_t*
+start_line(importer_t* importer, const char* ref, import_commit_t* from) {
+    import_line_t* line = calloc(1, sizeof *line);
+    line->branch = create_branch(ref_branch_name(ref));
+    line->tree = hmap_create();
+    line->commits = dyna_create();
+    line->tip = from;
+    line->ref = strdup(ref);
+    dyna_push(importer->lines, line);
+    if (!from)
+        return line;
+
+    /* the tree at the commit it forks from; the tree of the tip of its line, with every later
+     *  change of that line undone. */
+    line->branch->fork = from->idx + 1;
+    line->branch->base = from->owner->branch;
+    _hmap_foreach(from->owner->tree, entry)
+        hmap_put(line->tree, entry->key, entry->value);
+    _endforeach;
+    for (size_t i = from->owner->commits->length; i > 0; i--) {
+        const import_commit_t* later = dyna_get(from->owner->commits, i - 1);
+        if (later->idx <= from->idx) break;
+        for (size_t j = later->changes->length; j > 0; j--) {
+            const change_t* change = dyna_get(later->changes, j - 1);
+            if (change->old) hmap_put(line->tree, change->path, change->old);
+            else hmap_remove(line->tree, change->path);
+        }
+    }
+    return line;
+}
+
+/**
+ * @brief find the line a commit goes on; the line it continues the tip of, otherwise a new line
+ *  forked from where it starts.
+ *
+ * @param importer the state of the import.
+ * @param from the commit it starts from (0x0 for none).
+ * @param ref the ref of the commit.
+ * @return the line.
+ */
+internal import_line_t*
+commit_line(importer_t* importer, import_commit_t* from, const char* ref) {
+    if (from && from->owner->tip == from)
+        return from->owner;
+    return start_line(importer, ref, from);
+}
+
+/**
+ * @brief change a path of the tree of a line to a new version (or remove it), adding the diff
+ *  to the commit and the change to the imported commit.
+ *
+ * @param importer the state of the import.
+ * @param imported the line.
+ * @param commit the commit being imported.
+ * @param changes the changes of the imported commit.
+ * @param path the path.
+ * @param blob the new version (0x0 to remove the path).
+ */
+internal void
+change_path(importer_t* importer, import_line_t* imported, commit_t* commit, dyna_t* changes, \
+    const char* path, blob_t* blob) {
+    blob_t* old = hmap_get(imported->tree, path);
+    if (old == blob)
+        return;
+    if (blob && blob->altered && !blob->reported) {
+        llog(E_LOGGER_LEVEL_WARNING, "'%s' is not imported byte for byte; %s.\n", path, \
+            blob->altered);
+        blob->reported = true;
+        importer->stats->altered++;
+    }
+
+    /* new, deleted or modified; the lines of each version are read back from the spill file. */
+    size_t m = 0, n = 0;
+    char** old_lines = old ? blob_lines(importer, old, &m) : 0x0;
+    char** new_lines = blob ? blob_lines(importer, blob, &n) : 0x0;
+    diff_t* diff = !old ? create_lines_file_diff(path, E_DIFF_FILE_NEW, new_lines, n) : \
+        !blob ? create_lines_file_diff(path, E_DIFF_FILE_DELETED, old_lines, m) : \
+        create_lines_modified_diff(path, path, old_lines, m, new_lines, n);
+    dyna_push(commit->changes, diff);
+    if (old_lines) free_blob_lines(old_lines, m);
+    if (new_lines) free_blob_lines(new_lines, n);
+
+    /* then the tree, and how to undo it. */
+    change_t* change = calloc(1, sizeof *change);
+    change->path = strdup(path);
+    change->old = old;
+    dyna_push(changes, change);
+    if (blob) hmap_put(imported->tree, path, blob);
+    else hmap_remove(imported->tree, path);
+}
+
+/**
+ * @brief remove every path of the tree of a line under a directory (or the path itself).
+ *
+ * @param importer the state of the import.
+ * @param imported the line.
+ * @param commit the commit being imported.
+ * @param changes the changes of the imported commit.
+ * @param path the path or directory ('' for everything).
+ */
+internal void
+remove_paths(importer_t* importer, import_line_t* imported, commit_t* commit, dyna_t* changes, \
+    const char* path) {
+    size_t length = strlen(path);
+    dyna_t* removed = dyna_create();
+    _hmap_foreach(imported->tree, entry)
+        if (length == 0 || !strcmp(entry->key, path) || (!strncmp(entry->key, path, length) && \
+            entry->key[length] == '/'))
+            dyna_push(removed, strdup(entry->key));
+    _endforeach;
+    _foreach(removed, char*, _path)
+        change_path(importer, imported, commit, changes, _path, 0x0);
+        free(_path);
+    _endforeach;
+    dyna_free(removed);
+}
+
+/**
+ * @brief hash an imported commit over its mark (or original id), its parent, its ref, its time,
+ *  its diffs and its whole message; a commit already stored under that hash is never overwritten.
+ *
+ * @param commit the commit being imported.
+ * @param from the commit it starts from (0x0 for none).
+ * @param ref the ref of the commit.
+ * @param mark the mark of the commit (0x0 if it has none).
+ * @param oid the original id of the commit (0x0 if it has none).
+ * @param message the whole message of the commit.
+ * @param size the size of the message.
+ * @return true if the hash is not taken.
+ */
+internal bool
+hash_imported(commit_t* commit, const import_commit_t* from, const char* ref, \
+    const char* mark, const char* oid, const char* message, size_t size) {
+    char* data = 0x0, *parent = 0x0;
+    size_t length = 0;
+    FILE* f = open_memstream(&data, &length);
+    if (from) parent = strsha1(branch_commit(from->owner->branch, from->idx)->hash);
+    fprintf(f, "import\nmark=%s\noriginal-oid=%s\nparent=%s\nref=%s\nrawtime=%ld\n", \
+        mark ? mark : "", oid ? oid : "", parent ? parent : "", ref, (long) commit->rawtime);
+    _foreach(commit->changes, const diff_t*, change)
+        fprintf(f, "diff=%u\n", change->crc);
+    _endforeach;
+    fputs("message=", f);
+    fwrite(message, 1, size, f);
+    fclose(f);
+    hash_commit(commit, (const unsigned char*) data, length);
+    free(data);
+    free(parent);
+
+    /* the import stops rather than overwrite another commit. */
+    if (access(commit->path, F_OK) == 0) {
+        char* hash = strsha1(commit->hash);
+        llog(E_LOGGER_LEVEL_ERROR, "commit %s (from '%s') would overwrite a commit already in the "
+            "repository.\n", hash, mark ? mark : ref);
+        free(hash);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief import a 'commit' command; its header, where it starts, then its file commands.
+ *
+ * @param importer the state of the import.
+ * @param ref the ref of the commit.
+ * @return true if the commit was imported.
+ */
+internal bool
+import_commit(importer_t* importer, const char* ref) {
+    /* the header; the mark (and the original id), the committer and the message. */
+    char* mark = 0x0, *oid = 0x0, *line = 0x0;
+    time_t rawtime = 0;
+    while ((line = next_line(importer))) {
+        if (!strncmp(line, "mark ", 5)) {
+            free(mark);
+            mark = strdup(line + 5);
+        }
+        else if (!strncmp(line, "original-oid ", 13)) {
+            free(oid);
+            oid = strdup(line + 13);
+        }
+        else if (!strncmp(line, "committer ", 10)) {
+            char* close = strrchr(line, '>');
+            rawtime = close ? (time_t) strtol(close + 1, 0x0, 10) : 0;
+        }
+        else if (strncmp(line, "author ", 7) && strncmp(line, "encoding ", 9)) {
+            importer->unread = true;
+            break;
+        }
+    }
+    size_t size = 0, message_size = 0;
+    char* message = read_data(importer, &message_size);
+    bool imported_commit = message != 0x0;
+
+    /* where it starts; the first parent (the ref otherwise), the other parents are dropped. */
+    import_commit_t* from = hmap_get(importer->refs, ref);
+    while (imported_commit && (line = next_line(importer))) {
+        if (!strncmp(line, "from ", 5)) {
+            from = resolve_mark(importer, line + 5);
+            imported_commit = from != 0x0;
+        }
+        else if (strncmp(line, "merge ", 6)) {
+            importer->unread = true;
+            break;
+        }
+    }
+    if (!imported_commit) {
+        free(message);
+        free(mark);
+        free(oid);
+        return false;
+    }
+    import_line_t* imported = commit_line(importer, from, ref);
+
+    /* the commit, with the first line of the message (a commit has a single line). */
+    char* first = strndup(message, strcspn(message, "\n"));
+    commit_t* commit = create_commit(first[0] ? first : ".", imported->branch->name);
+    free(first);
+    if (rawtime > 0) {
+        commit->rawtime = rawtime;
+        struct tm* local_time = localtime(&commit->rawtime);
+        strftime(commit->timestamp, 21, "%Y-%m-%d %H:%M:%S", local_time);
+    }
+
+    /* the file commands, up to the blank line (or the next command). */
+    dyna_t* changes = dyna_create();
+    while (imported_commit && (line = next_line(importer)) && line[0] != '\0') {
+        char* rest = 0x0;
+        if (!strncmp(line, "M ", 2)) {
+            char* reference = strchr(line + 2, ' ');
+            char* path = reference ? strchr(reference + 1, ' ') : 0x0;
+            if (!path) {
+                imported_commit = false;
+                break;
+            }
+            *reference++ = '\0';
+            *path++ = '\0';
+            /* a submodule is not a file, there is nothing to import. */
+            if (!strcmp(line + 2, "160000"))
+                continue;
+            blob_t* blob = 0x0;
+            char* _path = strdup(parse_path(path, 0x0));
+            if (!strcmp(reference, "inline")) {
+                char* data = read_data(importer, &size);
+                if (data) blob = spill_blob(importer, data, size);
+                free(data);
+            }
+            else
+                blob = hmap_get(importer->blob_marks, reference);
+            if (!blob)
+                llog(E_LOGGER_LEVEL_ERROR, "'%s' is not the mark of a blob.\n", reference);
+            else
+                change_path(importer, imported, commit, changes, _path, blob);
+            free(_path);
+            imported_commit = blob != 0x0;
+        }
+        else if (!strncmp(line, "D ", 2))
+            remove_paths(importer, imported, commit, changes, parse_path(line + 2, 0x0));
+        else if (!strncmp(line, "R ", 2) || !strncmp(line, "C ", 2)) {
+            char* source = strdup(parse_path(line + 2, &rest));
+            char* destination = rest ? strdup(parse_path(rest, 0x0)) : 0x0;
+            blob_t* blob = hmap_get(imported->tree, source);
+            if (blob && destination) {
+                change_path(importer, imported, commit, changes, destination, blob);
+                if (line[0] == 'R')
+                    change_path(importer, imported, commit, changes, source, 0x0);
+            }
+            free(source);
+            free(destination);
+        }
+        else if (!strcmp(line, "deleteall"))
+            remove_paths(importer, imported, commit, changes, "");
+        else if (strncmp(line, "N ", 2)) {
+            importer->unread = true;
+            break;
+        }
+    }
+
+    /* create_commit only hashes the start of the message and the second it was made at, so two
+     *  commits of a stream would share a hash; it is taken over what tells them apart instead. */
+    if (imported_commit)
+        imported_commit = hash_imported(commit, from, ref, mark, oid, message, message_size);
+    free(message);
+    free(oid);
+
+    /* written straight away, then only what is needed to fork from it is kept. */
+    if (imported_commit) {
+        commit->generation = branch_length(imported->branch) + 1;
+        write_commit(commit);
+        _foreach(commit->changes, diff_t*, change)
+            _foreach_it(change->lines, char*, _line, j)
+                free(_line);
+            _endforeach;
+            dyna_free(change->lines);
+            free(change->stored_path);
+            free(change->new_path);
+            free(change);
+        _endforeach;
+        dyna_free(commit->changes);
+        commit->changes = dyna_create();
+        branch_push(imported->branch, commit);
+        import_commit_t* _commit = calloc(1, sizeof *_commit);
+        _commit->owner = imported;
+        _commit->idx = branch_length(imported->branch) - 1;
+        _commit->changes = changes;
+        dyna_push(imported->commits, _commit);
+        imported->tip = _commit;
+        if (mark) hmap_put(importer->commit_marks, mark, _commit);
+        set_ref(importer, ref, _commit);
+        importer->stats->commits++;
+    }
+    else
+        llog(E_LOGGER_LEVEL_ERROR, "could not import a commit on '%s'.\n", ref);
+    free(mark);
+    return imported_commit;
+}
+
+/**
+ * @brief queue a tag of an imported commit, written with the refs.
+ *
+ * @param importer the state of the import.
+ * @param name the name of the tag.
+ * @param commit the commit.
+ */
+internal void
+queue_tag(importer_t* importer, const char* name, const import_commit_t* commit) {
+    const branch_t* branch = commit->owner->branch;
+    dyna_push(importer->tags, create_tag(branch, branch_commit(branch, commit->idx), name));
+}
+
+/**
+ * @brief name a branch; an empty branch of the repository with the same name is replaced, and a
+ *  name of a branch with history is made unique.
+ *
+ * @param importer the state of the import.
+ * @param branch the branch.
+ * @param name the name.
+ */
+internal void
+name_branch(importer_t* importer, branch_t* branch, const char* name) {
+    char unique[192];
+    snprintf(unique, 192, "%s", name);
+    size_t slot = importer->repository->branches->length;
+    for (size_t k = 1; slot == importer->repository->branches->length; k++) {
+        bool taken = false;
+        _foreach_it(importer->repository->branches, branch_t*, _branch, j)
+            if (strcmp(_branch->name, unique)) continue;
+            if (branch_length(_branch) == 0 && !_branch->parent) slot = j;
+            else taken = true;
+        _endforeach;
+        if (!taken) break;
+        snprintf(unique, 192, "%s.%lu", name, k);
+    }
+    if (strcmp(unique, name))
+        llog(E_LOGGER_LEVEL_INFO, "'%s' already has history, it was imported as '%s'.\n", name, \
+            unique);
+    free(branch->name);
+    branch->name = strdup(unique);
+    snprintf(branch->path, 256, ".lit/refs/heads/%s", unique);
+    if (slot < importer->repository->branches->length)
+        importer->repository->branches->data[slot] = branch;
+    else
+        dyna_push(importer->repository->branches, branch);
+}
+
+/**
+ * @brief name the lines after the refs at their tips and write every branch (and the index of the
+ *  repository) at once; a ref that is not at the tip of a line of its own is a new branch forked
+ *  at its commit, and a line with no ref at its tip is named after the ref of its first commit.
+ *
+ * @param importer the state of the import.
+ */
+internal void
+write_refs(importer_t* importer) {
+    /* the tags and branches by the refs, in the order they were first set. */
+    dyna_t* branches = dyna_create();
+    _foreach(importer->ref_order, char*, ref)
+        import_commit_t* commit = hmap_get(importer->refs, ref);
+        if (commit && !strncmp(ref, "refs/tags/", 10))
+            queue_tag(importer, ref + 10, commit);
+        else if (commit && commit->owner->tip == commit && !commit->owner->named) {
+            name_branch(importer, commit->owner->branch, ref_branch_name(ref));
+            commit->owner->named = true;
+        }
+        else if (commit) {
+            branch_t* branch = create_branch(ref_branch_name(ref));
+            branch->fork = commit->idx + 1;
+            branch->base = commit->owner->branch;
+            name_branch(importer, branch, ref_branch_name(ref));
+            dyna_push(branches, branch);
+        }
+    _endforeach;
+    _foreach(importer->lines, import_line_t*, line)
+        /* a line is started before its first commit is read, which may have failed. */
+        if (line->commits->length == 0)
+            continue;
+        if (!line->named) {
+            char name[256];
+            snprintf(name, 256, "%s.side", ref_branch_name(line->ref));
+            name_branch(importer, line->branch, name);
+        }
+        dyna_push(branches, line->branch);
+    _endforeach;
+
+    /* a new repository (with an empty active branch) is switched to the first branch imported. */
+    repository_t* repository = importer->repository;
+    branch_t* active = dyna_get(repository->branches, repository->idx);
+    if (branch_length(active) == 0 && importer->lines->length > 0) {
+        _foreach_it(repository->branches, branch_t*, branch, j)
+            if (branch == ((import_line_t*) dyna_get(importer->lines, 0))->branch) {
+                repository->idx = j;
+                break;
+            }
+        _endforeach;
+    }
+
+    /* then every ref, with the name of the branch it forks from. */
+    _foreach(branches, branch_t*, branch)
+        if (branch->base) {
+            free(branch->parent);
+            branch->parent = strdup(branch->base->name);
+        }
+        branch->head = branch_length(branch) > 0 ? branch_length(branch) - 1 : 0;
+        fexistpd(branch->path);
+        write_branch(branch);
+    _endforeach;
+    write_repository(repository);
+    importer->stats->branches = branches->length;
+    dyna_free(branches);
+}
+
+/**
+ * @brief import a git fast-export stream into the repository in our cwd; the objects of every
+ *  commit are written as it is read, without touching the working tree, and the refs of every
+ *  branch (and the tags) are written once, at the end.
+ *
+ *  branches are linear, so the commits are put on lines of first parents (the other parents of a
+ *  merge are dropped, its changes are relative to the first one already); each line is named
+ *  after the ref at its tip, or '<ref>.side' after the ref of its first commit if it has none.
+ *
+ * @param in the stream to read the commands from.
+ * @param repository the repository the stream is imported into.
+ * @param stats pointer to store the counts of the import.
+ * @return true if the whole stream was imported.
+ */
+bool
+fast_import(FILE* in, repository_t* repository, import_stats_t* stats) {
+    /* assert on the stream, the repository and the counts. */
+    assert(in != 0x0 && repository != 0x0);
+    assert(stats != 0x0);
+    memset(stats, 0, sizeof *stats);
+
+    /* the spill file is removed straight away, it is only needed while it is open. */
+    importer_t importer = { .in = in, .repository = repository, .stats = stats };
+    importer.blobs = fopen(IMPORT_BLOBS_PATH, "w+b");
+    if (!importer.blobs) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open the spill file of the blobs.\n");
+        return false;
+    }
+    remove(IMPORT_BLOBS_PATH);
+    importer.blob_marks = hmap_create();
+    importer.commit_marks = hmap_create();
+    importer.refs = hmap_create();
+    importer.ref_order = dyna_create();
+    importer.lines = dyna_create();
+    importer.tags = dyna_create();
+    if (!repository->branches) repository->branches = dyna_create();
+
+    /* every command of the stream, in order. */
+    bool imported = true, done = false;
+    char* line = 0x0;
+    while (imported && !done && (line = next_line(&importer))) {
+        if (!strcmp(line, "blob")) {
+            char* mark = 0x0;
+            while ((line = next_line(&importer)) && (!strncmp(line, "mark ", 5) || \
+                !strncmp(line, "original-oid ", 13))) {
+                if (line[0] == 'm') {
+                    free(mark);
+                    mark = strdup(line + 5);
+                }
+            }
+            importer.unread = line != 0x0;
+            size_t size = 0;
+            char* data = read_data(&importer, &size);
+            imported = data != 0x0;
+            if (data && mark) hmap_put(importer.blob_marks, mark, spill_blob(&importer, data, size));
+            free(data);
+            free(mark);
+        }
+        else if (!strncmp(line, "commit ", 7)) {
+            char* ref = strdup(line + 7);
+            imported = import_commit(&importer, ref);
+            free(ref);
+        }
+        else if (!strncmp(line, "reset ", 6)) {
+            char* ref = strdup(line + 6);
+            import_commit_t* from = 0x0;
+            if ((line = next_line(&importer)) && !strncmp(line, "from ", 5))
+                imported = (from = resolve_mark(&importer, line + 5)) != 0x0;
+            else
+                importer.unread = line != 0x0;
+            set_ref(&importer, ref, from);
+            free(ref);
+        }
+        else if (!strncmp(line, "tag ", 4)) {
+            char* name = strdup(line + 4);
+            import_commit_t* from = 0x0;
+            while ((line = next_line(&importer)) && strncmp(line, "data ", 5))
+                if (!strncmp(line, "from ", 5)) from = resolve_mark(&importer, line + 5);
+            importer.unread = line != 0x0;
+            size_t size = 0;
+            char* message = read_data(&importer, &size);
+            imported = from && message;
+            if (imported) queue_tag(&importer, name, from);
+            free(message);
+            free(name);
+        }
+        else if (!strcmp(line, "checkpoint"))
+            fflush(importer.blobs);
+        else if (!strncmp(line, "progress ", 9))
+            llog(E_LOGGER_LEVEL_INFO, "%s\n", line + 9);
+        else if (!strcmp(line, "done"))
+            done = true;
+        else if (line[0] != '\0' && strncmp(line, "feature ", 8) && strncmp(line, "option ", 7)) {
+            llog(E_LOGGER_LEVEL_ERROR, "unsupported command in the stream: '%s'.\n", line);
+            imported = false;
+        }
+    }
+
+    /* the refs (of whatever was imported), then the tags, all at once. */
+    write_refs(&importer);
+    _foreach(importer.tags, tag_t*, tag)
+        char path[256];
+        snprintf(path, 256, ".lit/refs/tags/%s", tag->name);
+        fexistpd(path);
+        write_tag(tag);
+        free(tag->name);
+        free(tag);
+    _endforeach;
+    stats->tags = importer.tags->length;
+    fclose(importer.blobs);
+    free(importer.line);
+    return imported;
+}
@@ -0,0 +1,51 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-25
+ */
+#ifndef IMPORT_H
+#define IMPORT_H
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses repository_t. */
+#include "repo.h"
+
+/*!~ @note the blobs of a stream are spilled to a file while importing (it is removed on open, and
+ *  only read back for the previous version of a path that is modified). */
+#define IMPORT_BLOBS_PATH ".lit/import.blobs"
+
+/**
+ * a data structure for the counts of a fast-import; what was read from the stream and written.
+ */
+typedef struct {
+    size_t commits; /* number of commits imported. */
+    size_t blobs; /* number of blobs read. */
+    size_t altered; /* number of blobs imported whose lines are not their exact bytes. */
+    size_t branches; /* number of branches written (including the side branches). */
+    size_t tags; /* number of tags written. */
+} import_stats_t;
+
+/**
+ * @brief import a git fast-export stream into the repository in our cwd; the objects of every
+ *  commit are written as it is read, without touching the working tree, and the refs of every
+ *  branch (and the tags) are written once, at the end.
+ *
+ *  branches are linear, so the commits are put on lines of first parents (the other parents of a
+ *  merge are dropped, its changes are relative to the first one already); each line is named
+ *  after the ref at its tip, or '<ref>.side' after the ref of its first commit if it has none.
+ *
+ * @param in the stream to read the commands from.
+ * @param repository the repository the stream is imported into.
+ * @param stats pointer to store the counts of the import.
+ * @return true if the whole stream was imported.
+ */
+bool
+fast_import(FILE* in, repository_t* repository, import_stats_t* stats);
+#endif /* IMPORT_H */
@@ -0,0 +1,168 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-15
+ */
+#include "lru.h"
+
+/*! @uses calloc, free, exit. */
+#include <stdlib.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses strdup, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * @brief create an empty lru cache.
+ *
+ * @param capacity the maximum number of values held.
+ * @param copy_value function to copy a value out of the cache.
+ * @param free_value function to free a value (evicted, replaced, or freed with the cache).
+ * @return an allocated lru cache.
+ */
+lru_t*
+lru_create(size_t capacity, void* (*copy_value)(const void*), void (*free_value)(void*)) {
+    /* assert on the functions. */
+    assert(capacity > 0);
+    assert(copy_value != 0x0);
+    assert(free_value != 0x0);
+
+    /* allocate the cache. */
+    lru_t* lru = calloc(1, sizeof *lru);
+    if (!lru) {
+        llog(E_LOGGER_LEVEL_ERROR, "calloc failed; could not allocate memory for lru cache.\n");
+        exit(EXIT_FAILURE);
+    }
+    lru->map = hmap_create();
+    lru->capacity = capacity;
+    lru->copy_value = copy_value;
+    lru->free_value = free_value;
+    pthread_mutex_init(&lru->lock, 0x0);
+    return lru;
+}
+
+/**
+ * @brief destroying / freeing a lru cache, including its keys and values.
+ *
+ * @param lru pointer to an allocated lru cache.
+ */
+void
+lru_free(lru_t* lru) {
+    /* assert on the cache. */
+    assert(lru != 0x0);
+    for (lru_entry_t* entry = lru->head, *next = 0x0; entry; entry = next) {
+        next = entry->next;
+        lru->free_value(entry->value);
+        free(entry->key);
+        free(entry);
+    }
+    hmap_free(lru->map);
+    pthread_mutex_destroy(&lru->lock);
+    free(lru);
+}
+
+/**
+ * @brief unlink an entry from the list of a lru cache.
+ *
+ * @param lru pointer to an allocated lru cache.
+ * @param entry the entry to be unlinked.
+ */
+internal void
+lru_unlink(lru_t* lru, lru_entry_t* entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else lru->head = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else lru->tail = entry->prev;
+    entry->prev = entry->next = 0x0;
+}
+
+/**
+ * @brief link an entry at the front (most recently used) of the list of a lru cache.
+ *
+ * @param lru pointer to an allocated lru cache.
+ * @param entry the entry to be linked.
+ */
+internal void
+lru_link_front(lru_t* lru, lru_entry_t* entry) {
+    entry->prev = 0x0;
+    entry->next = lru->head;
+    if (lru->head) lru->head->prev = entry;
+    lru->head = entry;
+    if (!lru->tail) lru->tail = entry;
+}
+
+/**
+ * @brief get a copy of the value stored under <key>, marking it as the most recently used.
+ *
+ * @param lru pointer to an allocated lru cache.
+ * @param key the string key to search for.
+ * @param value pointer to store the copy of the value.
+ * @return true if the key exists in the cache.
+ */
+bool
+lru_get(lru_t* lru, const char* key, void** value) {
+    /* assert on the parameters. */
+    assert(lru != 0x0);
+    assert(key != 0x0);
+    assert(value != 0x0);
+
+    /* find and move the entry to the front. */
+    pthread_mutex_lock(&lru->lock);
+    lru_entry_t* entry = hmap_get(lru->map, key);
+    if (entry) {
+        lru_unlink(lru, entry);
+        lru_link_front(lru, entry);
+        *value = lru->copy_value(entry->value);
+    }
+    pthread_mutex_unlock(&lru->lock);
+    return entry != 0x0;
+}
+
+/**
+ * @brief insert or replace the value stored under <key> (the cache takes ownership of it),
+ *  evicting the least recently used value if the cache is full.
+ *
+ * @param lru pointer to an allocated lru cache.
+ * @param key the string key.
+ * @param value the value to be stored.
+ */
+void
+lru_put(lru_t* lru, const char* key, void* value) {
+    /* assert on the parameters. */
+    assert(lru != 0x0);
+    assert(key != 0x0);
+    pthread_mutex_lock(&lru->lock);
+
+    /* replace the value of an existing entry. */
+    lru_entry_t* entry = hmap_get(lru->map, key);
+    if (entry) {
+        lru->free_value(entry->value);
+        entry->value = value;
+        lru_unlink(lru, entry);
+        lru_link_front(lru, entry);
+        pthread_mutex_unlock(&lru->lock);
+        return;
+    }
+
+    /* evict the least recently used entry if we are full. */
+    if (lru->map->length >= lru->capacity && lru->tail) {
+        lru_entry_t* evicted = lru->tail;
+        lru_unlink(lru, evicted);
+        hmap_remove(lru->map, evicted->key);
+        lru->free_value(evicted->value);
+        free(evicted->key);
+        free(evicted);
+    }
+
+    /* then link the new entry at the front. */
+    entry = calloc(1, sizeof *entry);
+    entry->key = strdup(key);
+    entry->value = value;
+    hmap_put(lru->map, key, entry);
+    lru_link_front(lru, entry);
+    pthread_mutex_unlock(&lru->lock);
+}
@@ -0,0 +1,81 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-15
+ */
+#ifndef LRU_H
+#define LRU_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses pthread_mutex_t. */
+#include <pthread.h>
+
+/*! @uses hmap_t. */
+#include "hmap.h"
+
+/**
+ * a data structure for a single entry of a lru cache, linked from the most to the least recently
+ *  used entry.
+ */
+typedef struct lru_entry {
+    char* key; /* owned string key. */
+    void* value; /* owned value. */
+    struct lru_entry* prev, *next; /* more and less recently used entries. */
+} lru_entry_t;
+
+/**
+ * a data structure for a string keyed lru (least recently used) cache; it holds at most
+ *  <capacity> values, evicting the least recently used one. values are owned by the cache, and
+ *  are copied out under its lock so that it can be shared between threads.
+ */
+typedef struct {
+    hmap_t* map; /* map of keys to their entries. */
+    lru_entry_t* head, *tail; /* most and least recently used entries. */
+    size_t capacity; /* maximum number of entries. */
+    void* (*copy_value)(const void* value); /* copies a value out of the cache. */
+    void (*free_value)(void* value); /* frees a value evicted from the cache. */
+    pthread_mutex_t lock; /* lock on the cache. */
+} lru_t;
+
+/**
+ * @brief create an empty lru cache.
+ *
+ * @param capacity the maximum number of values held.
+ * @param copy_value function to copy a value out of the cache.
+ * @param free_value function to free a value (evicted, replaced, or freed with the cache).
+ * @return an allocated lru cache.
+ */
+lru_t*
+lru_create(size_t capacity, void* (*copy_value)(const void*), void (*free_value)(void*));
+
+/**
+ * @brief destroying / freeing a lru cache, including its keys and values.
+ *
+ * @param lru pointer to an allocated lru cache.
+ */
+void
+lru_free(lru_t* lru);
+
+/**
+ * @brief get a copy of the value stored under <key>, marking it as the most recently used.
+ *
+ * @param lru pointer to an allocated lru cache.
+ * @param key the string key to search for.
+ * @param value pointer to store the copy of the value.
+ * @return true if the key exists in the cache.
+ */
+bool
+lru_get(lru_t* lru, const char* key, void** value);
+
+/**
+ * @brief insert or replace the value stored under <key> (the cache takes ownership of it),
+ *  evicting the least recently used value if the cache is full.
+ *
+ * @param lru pointer to an allocated lru cache.
+ * @param key the string key.
+ * @param value the value to be stored.
+ */
+void
+lru_put(lru_t* lru, const char* key, void* value);
+#endif /* LRU_H */
@@ -0,0 +1,265 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-13
+ */
+#include "merge.h"
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses fprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, free, exit. */
+#include <stdlib.h>
+
+/*! @uses strcmp. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses strdup, internal. */
+#include "utl.h"
+
+/**
+ * @brief allocate a hunk and push it onto an array.
+ *
+ * @param hunks the dynamic array of hunks.
+ * @param base_start the start of the range in the base.
+ * @param base_end the end of the range in the base (exclusive).
+ * @param other_start the start of the range in the other side.
+ * @param other_end the end of the range in the other side (exclusive).
+ */
+internal void
+push_hunk(dyna_t* hunks, size_t base_start, size_t base_end, size_t other_start, \
+    size_t other_end) {
+    hunk_t* hunk = calloc(1, sizeof *hunk);
+    *hunk = (hunk_t) {
+        .base_start = base_start,
+        .base_count = base_end - base_start,
+        .other_start = other_start,
+        .other_count = other_end - other_start,
+    };
+    dyna_push(hunks, hunk);
+}
+
+/**
+ * @brief compute the hunks that turn <base> into <other> using the longest common subsequence,
+ *  after trimming the common prefix and suffix.
+ *
+ * @param base the lines of the base file.
+ * @param m the number of lines in the base.
+ * @param other the lines of the other file.
+ * @param n the number of lines in the other file.
+ * @return a dynamic array of allocated hunk_t, sorted by base_start.
+ */
+dyna_t*
+compute_hunks(char** base, size_t m, char** other, size_t n) {
+    /* assert on the lines (they may be empty, but not 0x0). */
+    assert(base != 0x0 || m == 0);
+    assert(other != 0x0 || n == 0);
+    dyna_t* hunks = dyna_create();
+
+    /* trim the common prefix and suffix, most edits only touch a small window of a file. */
+    size_t prefix = 0, suffix = 0;
+    while (prefix < m && prefix < n && !strcmp(base[prefix], other[prefix]))
+        prefix++;
+    while (suffix < m - prefix && suffix < n - prefix && \
+        !strcmp(base[m - 1 - suffix], other[n - 1 - suffix]))
+        suffix++;
+    size_t rows = m - prefix - suffix, cols = n - prefix - suffix;
+    if (rows == 0 && cols == 0)
+        return hunks;
+    if (rows == 0 || cols == 0) {
+        push_hunk(hunks, prefix, prefix + rows, prefix, prefix + cols);
+        return hunks;
+    }
+
+    /* @ref[https://en.wikipedia.org/wiki/Longest_common_subsequence], dp[i][j] is the length
+     *  of the lcs of the suffixes a[i..] and b[j..] of the trimmed window. */
+    char** a = base + prefix, **b = other + prefix;
+    unsigned int* dp = calloc((rows + 1) * (cols + 1), sizeof *dp);
+    if (!dp) {
+        fprintf(stderr, "calloc failed; could not allocate memory for lcs table.");
+        exit(EXIT_FAILURE); /* exit on failure. */
+    }
+#define _dp(i, j) dp[(i) * (cols + 1) + (j)]
+    for (size_t i = rows; i-- > 0;) {
+        for (size_t j = cols; j-- > 0;) {
+            if (!strcmp(a[i], b[j]))
+                _dp(i, j) = 1 + _dp(i + 1, j + 1);
+            else
+                _dp(i, j) = _dp(i + 1, j) >= _dp(i, j + 1) ? _dp(i + 1, j) : _dp(i, j + 1);
+        }
+    }
+
+    /* backtrack, opening a hunk on the first mismatch and closing it on the next match. */
+    size_t i = 0, j = 0, hunk_i = 0, hunk_j = 0;
+    bool open = false;
+    while (i < rows || j < cols) {
+        if (i < rows && j < cols && !strcmp(a[i], b[j])) {
+            if (open) {
+                push_hunk(hunks, prefix + hunk_i, prefix + i, prefix + hunk_j, prefix + j);
+                open = false;
+            }
+            i++; j++;
+            continue;
+        }
+        if (!open) {
+            hunk_i = i; hunk_j = j;
+            open = true;
+        }
+        if (j >= cols || (i < rows && _dp(i + 1, j) >= _dp(i, j + 1))) i++;
+        else j++;
+    }
+    if (open)
+        push_hunk(hunks, prefix + hunk_i, prefix + i, prefix + hunk_j, prefix + j);
+#undef _dp
+    free(dp);
+    return hunks;
+}
+
+/**
+ * @brief free a dynamic array of hunks returned by @ref compute_hunks().
+ *
+ * @param hunks the dynamic array of hunks.
+ */
+void
+free_hunks(dyna_t* hunks) {
+    /* assert on the hunks. */
+    assert(hunks != 0x0);
+    _foreach(hunks, hunk_t*, hunk)
+        free(hunk);
+    _endforeach;
+    dyna_free(hunks);
+}
+
+/**
+ * @brief do two hunks (from different sides) overlap in the base?
+ *
+ * @param a the first hunk.
+ * @param b the second hunk.
+ * @return true if the hunks overlap, or both start at the same line of the base.
+ */
+internal bool
+is_overlapping(const hunk_t* a, const hunk_t* b) {
+    /* two edits (or insertions) at the same place can not be ordered, so they overlap. */
+    if (a->base_start == b->base_start)
+        return true;
+    return a->base_start < b->base_start + b->base_count && \
+        b->base_start < a->base_start + a->base_count;
+}
+
+/**
+ * @brief are the two hunks the same change (same base range and same replacement lines)?
+ *
+ * @param a the first hunk.
+ * @param a_lines the lines of the side of the first hunk.
+ * @param b the second hunk.
+ * @param b_lines the lines of the side of the second hunk.
+ * @return true if both hunks make the same change.
+ */
+internal bool
+is_identical(const hunk_t* a, char** a_lines, const hunk_t* b, char** b_lines) {
+    if (a->base_start != b->base_start || a->base_count != b->base_count || \
+        a->other_count != b->other_count)
+        return false;
+    for (size_t k = 0; k < a->other_count; k++)
+        if (strcmp(a_lines[a->other_start + k], b_lines[b->other_start + k]) != 0)
+            return false;
+    return true;
+}
+
+/**
+ * @brief three-way (diff3-style) merge of two sets of changes against a common base; hunks
+ *  that do not overlap in the base are both applied, identical hunks are applied once.
+ *
+ * @param base the lines of the common base.
+ * @param nb the number of lines in the base.
+ * @param ours the lines of our side.
+ * @param no the number of lines on our side.
+ * @param theirs the lines of their side.
+ * @param nt the number of lines on their side.
+ * @param merged pointer to store the allocated merged lines (only on a clean merge).
+ * @param nm pointer to store the number of merged lines.
+ * @param conflicts dynamic array to push allocated merge_conflict_t onto (can be 0x0).
+ * @return the result of the merge.
+ */
+e_merge_result_t
+merge_lines(char** base, size_t nb, char** ours, size_t no, char** theirs, size_t nt, \
+    char*** merged, size_t* nm, dyna_t* conflicts) {
+    /* assert on the output pointers. */
+    assert(merged != 0x0);
+    assert(nm != 0x0);
+
+    /* compute the changes each side made against the base. */
+    dyna_t* our_hunks = compute_hunks(base, nb, ours, no), \
+        *their_hunks = compute_hunks(base, nb, theirs, nt);
+
+    /* the merged file can never be larger than the base plus both sides. */
+    char** lines = calloc(nb + no + nt + 1, sizeof(char*));
+    size_t count = 0, pos = 0, io = 0, it = 0;
+    e_merge_result_t result = E_MERGE_RESULT_CLEAN;
+
+    /* walk both (sorted) hunk lists along the base. */
+    while (io < our_hunks->length || it < their_hunks->length) {
+        hunk_t* ho = dyna_get(our_hunks, io), *ht = dyna_get(their_hunks, it);
+        hunk_t* take = 0x0;
+        char** side = 0x0;
+        if (ho && ht && is_overlapping(ho, ht)) {
+            /* the same change on both sides is not a conflict. */
+            if (is_identical(ho, ours, ht, theirs)) {
+                take = ho; side = ours;
+                io++; it++;
+            }
+            else {
+                result = E_MERGE_RESULT_CONFLICT;
+                if (conflicts) {
+                    merge_conflict_t* conflict = calloc(1, sizeof *conflict);
+                    *conflict = (merge_conflict_t) { .ours = *ho, .theirs = *ht };
+                    dyna_push(conflicts, conflict);
+                }
+
+                /* skip whichever ends first, it may still overlap the next hunk. */
+                if (ho->base_start + ho->base_count <= ht->base_start + ht->base_count) io++;
+                else it++;
+                continue;
+            }
+        }
+        else if (ho && (!ht || ho->base_start < ht->base_start)) {
+            take = ho; side = ours;
+            io++;
+        }
+        else {
+            take = ht; side = theirs;
+            it++;
+        }
+
+        /* copy the unchanged base lines up to the hunk, then the replacement lines. */
+        if (result == E_MERGE_RESULT_CONFLICT)
+            continue;
+        while (pos < take->base_start)
+            lines[count++] = strdup(base[pos++]);
+        for (size_t k = 0; k < take->other_count; k++)
+            lines[count++] = strdup(side[take->other_start + k]);
+        pos = take->base_start + take->base_count;
+    }
+
+    /* copy the remaining base lines. */
+    free_hunks(our_hunks);
+    free_hunks(their_hunks);
+    if (result == E_MERGE_RESULT_CONFLICT) {
+        for (size_t k = 0; k < count; k++)
+            free(lines[k]);
+        free(lines);
+        *merged = 0x0;
+        *nm = 0;
+        return result;
+    }
+    while (pos < nb)
+        lines[count++] = strdup(base[pos++]);
+    *merged = lines;
+    *nm = count;
+    return result;
+}
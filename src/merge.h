@@ -0,0 +1,79 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-13
+ */
+#ifndef MERGE_H
+#define MERGE_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses dyna_t, dyna_push, etc... */
+#include "dyna.h"
+
+/**
+ * a data structure for a hunk; a range of lines in the base that was replaced with a range of
+ *  lines from the other side. a hunk with a base count of zero is a pure insertion, and a hunk
+ *  with an other count of zero is a pure deletion.
+ */
+typedef struct {
+    size_t base_start, base_count; /* range of lines replaced in the base [start, start+count). */
+    size_t other_start, other_count; /* range of replacement lines in the other side. */
+} hunk_t;
+
+/**
+ * a data structure for a conflict found during a three-way merge; the two hunks (one from each
+ *  side) that overlap in the base.
+ */
+typedef struct {
+    hunk_t ours, theirs; /* overlapping hunks, from our side and their side. */
+} merge_conflict_t;
+
+/**
+ * enum to describe the possible results of a three-way line merge.
+ */
+typedef enum {
+    E_MERGE_RESULT_CLEAN = 0x0, /* the merge applied cleanly. */
+    E_MERGE_RESULT_CONFLICT = 0x1, /* at least one pair of hunks overlapped. */
+} e_merge_result_t;
+
+/**
+ * @brief compute the hunks that turn <base> into <other> using the longest common subsequence,
+ *  after trimming the common prefix and suffix.
+ *
+ * @param base the lines of the base file.
+ * @param m the number of lines in the base.
+ * @param other the lines of the other file.
+ * @param n the number of lines in the other file.
+ * @return a dynamic array of allocated hunk_t, sorted by base_start.
+ */
+dyna_t*
+compute_hunks(char** base, size_t m, char** other, size_t n);
+
+/**
+ * @brief free a dynamic array of hunks returned by @ref compute_hunks().
+ *
+ * @param hunks the dynamic array of hunks.
+ */
+void
+free_hunks(dyna_t* hunks);
+
+/**
+ * @brief three-way (diff3-style) merge of two sets of changes against a common base; hunks
+ *  that do not overlap in the base are both applied, identical hunks are applied once.
+ *
+ * @param base the lines of the common base.
+ * @param nb the number of lines in the base.
+ * @param ours the lines of our side.
+ * @param no the number of lines on our side.
+ * @param theirs the lines of their side.
+ * @param nt the number of lines on their side.
+ * @param merged pointer to store the allocated merged lines (only on a clean merge).
+ * @param nm pointer to store the number of merged lines.
+ * @param conflicts dynamic array to push allocated merge_conflict_t onto (can be 0x0).
+ * @return the result of the merge.
+ */
+e_merge_result_t
+merge_lines(char** base, size_t nb, char** ours, size_t no, char** theirs, size_t nt, \
+    char*** merged, size_t* nm, dyna_t* conflicts);
+#endif /* MERGE_H */
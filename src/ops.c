@@ -28,6 +28,30 @@
 /*! @uses llog, E_LOGGER_LEVEL_ERROR. */
 #include "log.h"
 
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses pthread_once_t, pthread_once. */
+#include <pthread.h>
+
+/*! @uses lru_t, lru_create, lru_get, lru_put. */
+#include "lru.h"
+
+/*! @uses compute_hunks, free_hunks, hunk_t. */
+#include "merge.h"
+
+/*! @uses sysconf, _SC_NPROCESSORS_ONLN. */
+#include <unistd.h>
+
+/*! @uses sparse_includes. */
+#include "sparse.h"
+
+/*!~ @note the number of versions (of a path written by a commit) kept in memory. */
+#define RECONSTRUCT_CACHE_SIZE 64
+
+/*!~ @note the number of unchanged lines shown around each hunk of a delta. */
+#define DELTA_CONTEXT 3
+
 /**
  * @brief apply the commit forward to the files currently existing.
  *
@@ -38,11 +62,12 @@ forward_commit_op(const commit_t* commit) {
     /* assert on the commit. */
     assert(commit != 0x0);
 
-    /* iterate for a 'delta apply'. */
+    /* iterate for a 'delta apply', paths outside of a sparse checkout are never written. */
     _foreach(commit->changes, const diff_t*, diff)
         switch (diff->type) {
             case (E_DIFF_FILE_NEW): {
                 /* write this out to the file. */
+                if (!sparse_includes(diff->new_path)) break;
                 size_t n = 0;
                 char** lines = fforwardls((char**)diff->lines->data, diff->lines->length, &n);
                 fwritels(diff->new_path, lines, n);
@@ -50,12 +75,14 @@ forward_commit_op(const commit_t* commit) {
                 break;
             }
             case (E_DIFF_FILE_MODIFIED): {
-                if (strcmp(diff->new_path, diff->stored_path) != 0) {
+                if (strcmp(diff->new_path, diff->stored_path) != 0 && \
+                    sparse_includes(diff->stored_path)) {
                     /* if the file was renamed, we need to remove the old file. */
                     remove(diff->stored_path);
                 }
 
                 /* write this out to the new file. */
+                if (!sparse_includes(diff->new_path)) break;
                 size_t n = 0;
                 char** lines = fforwardls((char**)diff->lines->data, diff->lines->length, &n);
                 fwritels(diff->new_path, lines, n);
@@ -64,14 +91,16 @@ forward_commit_op(const commit_t* commit) {
             }
             case (E_DIFF_FOLDER_NEW): {
                 /* make a new folder. */
-                mkdir(diff->stored_path, 0755);
+                if (sparse_includes(diff->stored_path))
+                    mkdir(diff->stored_path, 0755);
                 break;
             }
             /* if a folder was deleted */
             case (E_DIFF_FILE_DELETED):
             case (E_DIFF_FOLDER_DELETED): {
                 /* then we 'unlink' this folder. */
-                remove(diff->stored_path);
+                if (sparse_includes(diff->stored_path))
+                    remove(diff->stored_path);
                 break;
             }
             default: ; /* ? */
@@ -89,22 +118,25 @@ reverse_commit_op(const commit_t* commit) {
     /* assert on the commit. */
     assert(commit != 0x0);
 
-    /* iterate for a "delta apply". */
+    /* iterate for a "delta apply", paths outside of a sparse checkout are never written. */
     _foreach(commit->changes, const diff_t*, diff)
         switch (diff->type) {
             case (E_DIFF_FOLDER_NEW):
             case (E_DIFF_FILE_NEW): {
                 /* file / folder was created so delete it. */
-                remove(diff->stored_path);
+                if (sparse_includes(diff->stored_path))
+                    remove(diff->stored_path);
                 break;
             }
             case (E_DIFF_FILE_MODIFIED): {
-                if (strcmp(diff->new_path, diff->stored_path) != 0) {
+                if (strcmp(diff->new_path, diff->stored_path) != 0 && \
+                    sparse_includes(diff->new_path)) {
                     /* if the file was renamed, we need to remove the old file. */
                     remove(diff->new_path);
                 }
 
                 /* write this out to the new file. */
+                if (!sparse_includes(diff->stored_path)) break;
                 size_t n = 0;
                 char** lines = finversels((char**)diff->lines->data, diff->lines->length, &n);
                 fwritels(diff->stored_path, lines, n);
@@ -113,11 +145,13 @@ reverse_commit_op(const commit_t* commit) {
             }
             case (E_DIFF_FOLDER_DELETED): {
                 /* make a new folder. */
-                mkdir(diff->stored_path, 0755);
+                if (sparse_includes(diff->stored_path))
+                    mkdir(diff->stored_path, 0755);
                 break;
             }
             case (E_DIFF_FILE_DELETED): {
                 /* write this out to the file. */
+                if (!sparse_includes(diff->stored_path)) break;
                 size_t n = 0;
                 char** lines = finversels((char**)diff->lines->data, diff->lines->length, &n);
                 fwritels(diff->stored_path, lines, n);
@@ -129,6 +163,227 @@ reverse_commit_op(const commit_t* commit) {
     _endforeach;
 }
 
+/**
+ * enum for the final action a transition takes on a single path.
+ */
+typedef enum {
+    E_TRANSITION_WRITE = 0x1, /* write the file from the lines of a diff. */
+    E_TRANSITION_REMOVE = 0x2, /* remove the file or folder. */
+    E_TRANSITION_MKDIR = 0x3, /* create the folder. */
+} e_transition_ty_t;
+
+/**
+ * a data structure for the final action a transition takes on a single path.
+ */
+typedef struct {
+    e_transition_ty_t type; /* type of action. */
+    const diff_t* diff; /* diff to write the file from (writes only). */
+    bool inverse; /* write the original (inverse) lines of the diff instead of the new ones. */
+} transition_action_t;
+
+/**
+ * @brief plan an action for a path, replacing any action planned before it (paths outside of a
+ *  sparse checkout are skipped).
+ *
+ * @param transition the transition to be planned onto.
+ * @param path the path of the action.
+ * @param type the type of action.
+ * @param diff the diff to write the file from (writes only).
+ * @param inverse whether to write the inverse lines of the diff.
+ */
+internal void
+plan_action(transition_t* transition, const char* path, e_transition_ty_t type, \
+    const diff_t* diff, bool inverse) {
+    /* paths outside of a sparse checkout are never planned (and so never written). */
+    if (!sparse_includes(path))
+        return;
+    transition_action_t* action = hmap_get(transition->actions, path);
+    if (!action) {
+        action = calloc(1, sizeof *action);
+        hmap_put(transition->actions, path, action);
+    }
+    *action = (transition_action_t) { .type = type, .diff = diff, .inverse = inverse };
+}
+
+/**
+ * @brief create an empty working tree transition.
+ *
+ * @return an allocated transition.
+ */
+transition_t*
+create_transition() {
+    transition_t* transition = calloc(1, sizeof *transition);
+    transition->actions = hmap_create();
+    return transition;
+}
+
+/**
+ * @brief plan applying a commit forward as part of a transition (nothing is written yet).
+ *
+ * @param transition the transition to be planned onto.
+ * @param commit the commit to be applied forward.
+ */
+void
+forward_transition(transition_t* transition, const commit_t* commit) {
+    /* assert on the transition and the commit. */
+    assert(transition != 0x0);
+    assert(commit != 0x0);
+
+    /* the same cases as forward_commit_op, only planned. */
+    _foreach(commit->changes, const diff_t*, diff)
+        switch (diff->type) {
+            case (E_DIFF_FILE_NEW): {
+                plan_action(transition, diff->new_path, E_TRANSITION_WRITE, diff, false);
+                break;
+            }
+            case (E_DIFF_FILE_MODIFIED): {
+                if (strcmp(diff->new_path, diff->stored_path) != 0)
+                    plan_action(transition, diff->stored_path, E_TRANSITION_REMOVE, 0x0, false);
+                plan_action(transition, diff->new_path, E_TRANSITION_WRITE, diff, false);
+                break;
+            }
+            case (E_DIFF_FOLDER_NEW): {
+                plan_action(transition, diff->stored_path, E_TRANSITION_MKDIR, 0x0, false);
+                break;
+            }
+            case (E_DIFF_FILE_DELETED):
+            case (E_DIFF_FOLDER_DELETED): {
+                plan_action(transition, diff->stored_path, E_TRANSITION_REMOVE, 0x0, false);
+                break;
+            }
+            default: ; /* ? */
+        }
+    _endforeach;
+}
+
+/**
+ * @brief plan applying a commit backwards (inverse) as part of a transition (nothing is
+ *  written yet).
+ *
+ * @param transition the transition to be planned onto.
+ * @param commit the commit to be applied backwards.
+ */
+void
+reverse_transition(transition_t* transition, const commit_t* commit) {
+    /* assert on the transition and the commit. */
+    assert(transition != 0x0);
+    assert(commit != 0x0);
+
+    /* the same cases as reverse_commit_op, only planned (in reverse order). */
+    _inv_foreach(commit->changes, const diff_t*, diff)
+        switch (diff->type) {
+            case (E_DIFF_FOLDER_NEW):
+            case (E_DIFF_FILE_NEW): {
+                plan_action(transition, diff->stored_path, E_TRANSITION_REMOVE, 0x0, false);
+                break;
+            }
+            case (E_DIFF_FILE_MODIFIED): {
+                if (strcmp(diff->new_path, diff->stored_path) != 0)
+                    plan_action(transition, diff->new_path, E_TRANSITION_REMOVE, 0x0, false);
+                plan_action(transition, diff->stored_path, E_TRANSITION_WRITE, diff, true);
+                break;
+            }
+            case (E_DIFF_FOLDER_DELETED): {
+                plan_action(transition, diff->stored_path, E_TRANSITION_MKDIR, 0x0, false);
+                break;
+            }
+            case (E_DIFF_FILE_DELETED): {
+                plan_action(transition, diff->stored_path, E_TRANSITION_WRITE, diff, true);
+                break;
+            }
+            default: ; /* ? */
+        }
+    _endforeach;
+}
+
+/**
+ * @brief compare two transition entries by path (for qsort).
+ *
+ * @param a pointer to the first hmap_entry_t*.
+ * @param b pointer to the second hmap_entry_t*.
+ * @return the strcmp of both paths.
+ */
+internal int
+compare_entries(const void* a, const void* b) {
+    return strcmp((*(hmap_entry_t* const*) a)->key, (*(hmap_entry_t* const*) b)->key);
+}
+
+/**
+ * @brief apply a planned transition to the working tree, writing or removing each touched path
+ *  once, and then free the transition.
+ *
+ * @param transition the transition to be applied.
+ */
+void
+apply_transition(transition_t* transition) {
+    /* assert on the transition. */
+    assert(transition != 0x0);
+
+    /* sort the paths, so that parents come before their children. */
+    size_t n = 0;
+    hmap_entry_t** entries = calloc(transition->actions->length + 1, sizeof *entries);
+    _hmap_foreach(transition->actions, entry)
+        entries[n++] = entry;
+    _endforeach;
+    qsort(entries, n, sizeof *entries, compare_entries);
+
+    /* create folders and write files first (parents first). */
+    for (size_t i = 0; i < n; i++) {
+        const transition_action_t* action = entries[i]->value;
+        if (action->type == E_TRANSITION_MKDIR)
+            mkdir(entries[i]->key, 0755);
+        else if (action->type == E_TRANSITION_WRITE) {
+            /* write either the new or the original lines of the diff. */
+            const diff_t* diff = action->diff;
+            size_t k = 0;
+            char** lines = action->inverse ? \
+                finversels((char**) diff->lines->data, diff->lines->length, &k) : \
+                fforwardls((char**) diff->lines->data, diff->lines->length, &k);
+            fwritels(entries[i]->key, lines, k);
+            ffreels(lines, k);
+        }
+    }
+
+    /* then remove files and folders (children first). */
+    for (size_t i = n; i-- > 0;) {
+        const transition_action_t* action = entries[i]->value;
+        if (action->type == E_TRANSITION_REMOVE)
+            remove(entries[i]->key);
+    }
+
+    /* free the transition. */
+    for (size_t i = 0; i < n; i++)
+        free(entries[i]->value);
+    free(entries);
+    hmap_free(transition->actions);
+    free(transition);
+}
+
+/**
+ * @brief move the working tree between two commits on a branch in one coalesced transition.
+ *
+ * @param branch the branch that both commits are on.
+ * @param from the index of the commit the working tree is currently at.
+ * @param to the index of the commit to move the working tree to.
+ */
+void
+transition_op(const branch_t* branch, size_t from, size_t to) {
+    /* assert on the branch. */
+    assert(branch != 0x0);
+
+    /* plan every commit between the two, then write each path once. */
+    transition_t* transition = create_transition();
+    if (to > from) {
+        for (size_t i = from + 1; i <= to && i < branch_length(branch); i++)
+            forward_transition(transition, branch_commit(branch, i));
+    }
+    else {
+        for (size_t i = from; i > to; i--)
+            reverse_transition(transition, branch_commit(branch, i));
+    }
+    apply_transition(transition);
+}
+
 /**
  * @brief rollback to an older commit.
  *
@@ -143,7 +398,7 @@ rollback_op(branch_t* branch, const commit_t* commit) {
 
     /* the first thing to do is to check that this commit is in <branch> history. */
     size_t target_idx = (size_t) -1;
-    _foreach_it(branch->commits, commit_t*, _commit, i)
+    _branch_foreach_it(branch, commit_t*, _commit, i)
         /* we compare by hashes, not by pointers. */
         if (!memcmp(_commit->hash, commit->hash, 20u)) {
             target_idx = i;
@@ -157,11 +412,8 @@ rollback_op(branch_t* branch, const commit_t* commit) {
         return;
     }
 
-    /* apply inverse of commits from current back to target
-     *  go backwards from current position to target */
-    for (size_t i = branch->head; i > target_idx; i--) {
-        reverse_commit_op(dyna_get(branch->commits, i));
-    }
+    /* apply inverse of commits from current back to target in one coalesced transition. */
+    transition_op(branch, branch->head, target_idx);
     branch->head = target_idx;
 }
 
@@ -179,7 +431,7 @@ checkout_op(branch_t* branch, const commit_t* commit) {
 
     /* first thing to do is to check that this commit is in <branch> history. */
     size_t target_idx = -1;
-    _foreach_it(branch->commits, commit_t*, _commit, i)
+    _branch_foreach_it(branch, commit_t*, _commit, i)
         /* we compare by hashes, not by pointers. */
         if (!memcmp(_commit->hash, commit->hash, 20u)) {
             target_idx = i;
@@ -193,8 +445,647 @@ checkout_op(branch_t* branch, const commit_t* commit) {
         exit(EXIT_FAILURE);
     }
 
-    /* apply commits from current forward to target, go forwards from current position to target */
-    for (size_t i = branch->head + 1; i <= target_idx; i++)
-        forward_commit_op(dyna_get(branch->commits, i));
+    /* apply commits from current forward to target in one coalesced transition. */
+    transition_op(branch, branch->head, target_idx);
     branch->head = target_idx;
-}
\ No newline at end of file
+}
+
+/**
+ * a data structure for the version of a path written (or removed) by a commit.
+ */
+typedef struct {
+    char** lines; /* lines of the file (0x0 if it does not exist at the commit). */
+    size_t n; /* number of lines. */
+} version_t;
+
+/* the cache of versions, keyed by '<sha1 of the commit that wrote the path>:<path>'; the diffs of
+ *  that commit hold the whole content, so the version is the same on every branch it is on (the
+ *  version at any other commit depends on the history below it, which rebase can change). */
+internal lru_t* versions = 0x0;
+internal pthread_once_t versions_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief copy the lines of a reconstructed version.
+ *
+ * @param lines the lines (or 0x0).
+ * @param n the number of lines.
+ * @return the allocated copy (or 0x0).
+ */
+internal char**
+copy_lines(char** lines, size_t n) {
+    if (!lines)
+        return 0x0;
+    char** copy = calloc(n > 0 ? n : 1, sizeof(char*));
+    for (size_t i = 0; i < n; i++)
+        copy[i] = strdup(lines[i]);
+    return copy;
+}
+
+/**
+ * @brief free the lines of a reconstructed version.
+ *
+ * @param lines the lines (or 0x0).
+ * @param n the number of lines.
+ */
+internal void
+free_lines(char** lines, size_t n) {
+    if (lines && n > 0) ffreels(lines, n);
+    else free(lines);
+}
+
+/**
+ * @brief copy a version out of the cache.
+ *
+ * @param value the version.
+ * @return the allocated copy.
+ */
+internal void*
+copy_version(const void* value) {
+    const version_t* version = value;
+    version_t* copy = calloc(1, sizeof *copy);
+    copy->lines = copy_lines(version->lines, version->n);
+    copy->n = version->n;
+    return copy;
+}
+
+/**
+ * @brief free a version evicted from the cache.
+ *
+ * @param value the version.
+ */
+internal void
+free_version(void* value) {
+    version_t* version = value;
+    free_lines(version->lines, version->n);
+    free(version);
+}
+
+/**
+ * @brief create the cache of reconstructed versions (once).
+ */
+internal void
+create_versions(void) {
+    versions = lru_create(RECONSTRUCT_CACHE_SIZE, copy_version, free_version);
+}
+
+/**
+ * @brief get the version of a path written by a commit from the cache.
+ *
+ * @param hash the hash of the commit that wrote (or removed) the path.
+ * @param path the path of the file.
+ * @param n pointer to store the number of lines.
+ * @param lines pointer to store the allocated lines (0x0 if the path does not exist).
+ * @return true if the version was cached.
+ */
+internal bool
+get_version(const sha1_t hash, const char* path, size_t* n, char*** lines) {
+    pthread_once(&versions_once, create_versions);
+    char* _hash = strsha1(hash), key[512];
+    snprintf(key, 512, "%s:%s", _hash, path);
+    free(_hash);
+    version_t* version = 0x0;
+    if (!lru_get(versions, key, (void**) &version))
+        return false;
+    *lines = version->lines;
+    *n = version->n;
+    free(version);
+    return true;
+}
+
+/**
+ * @brief put the version of a path written by a commit into the cache (a copy is stored).
+ *
+ * @param hash the hash of the commit that wrote (or removed) the path.
+ * @param path the path of the file.
+ * @param lines the lines (0x0 if the path does not exist).
+ * @param n the number of lines.
+ */
+internal void
+put_version(const sha1_t hash, const char* path, char** lines, size_t n) {
+    pthread_once(&versions_once, create_versions);
+    char* _hash = strsha1(hash), key[512];
+    snprintf(key, 512, "%s:%s", _hash, path);
+    free(_hash);
+    version_t* version = calloc(1, sizeof *version);
+    version->lines = copy_lines(lines, n);
+    version->n = n;
+    lru_put(versions, key, version);
+}
+
+/**
+ * @brief find the content of a path written by a single commit; the last diff in a commit is the
+ *  most recent.
+ *
+ * @param commit the commit (with its diffs read).
+ * @param path the path of the file.
+ * @param lines pointer to store the allocated lines (0x0 if the commit removed the path).
+ * @param n pointer to store the number of lines.
+ * @return true if the commit wrote (or removed) the path.
+ */
+internal bool
+reconstruct_commit(const commit_t* commit, const char* path, char*** lines, size_t* n) {
+    _inv_foreach(commit->changes, const diff_t*, diff)
+        switch (diff->type) {
+            case (E_DIFF_FILE_NEW):
+            case (E_DIFF_FILE_MODIFIED): {
+                if (!strcmp(diff->new_path, path)) {
+                    /* every line in the diff is kept, apart from the removed ones. */
+                    *lines = diff->lines->length == 0 ? calloc(1, sizeof(char*)) : \
+                        fforwardls((char**) diff->lines->data, diff->lines->length, n);
+                    return true;
+                }
+
+                /* renamed away from this path. */
+                if (!strcmp(diff->stored_path, path)) {
+                    *lines = 0x0;
+                    return true;
+                }
+                break;
+            }
+            case (E_DIFF_FILE_DELETED): {
+                if (!strcmp(diff->stored_path, path)) {
+                    *lines = 0x0;
+                    return true;
+                }
+                break;
+            }
+            default: ;
+        }
+    _endforeach;
+    return false;
+}
+
+/**
+ * @brief reconstruct the content of a single path at a commit in memory, without touching the
+ *  working tree; the most recent diff that wrote the path holds its full content.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @param path the path of the file to be reconstructed.
+ * @param n pointer to store the number of lines reconstructed.
+ * @return the allocated lines of the file, or 0x0 if the path does not exist at the commit.
+ */
+char**
+reconstruct_op(const branch_t* branch, size_t idx, const char* path, size_t* n) {
+    /* assert on the parameters. */
+    assert(branch != 0x0);
+    assert(path != 0x0);
+    assert(n != 0x0);
+    *n = 0;
+
+    /* walk backwards from the commit (every diff is already in memory). */
+    char** lines = 0x0;
+    for (size_t i = idx + 1; i-- > 0;) {
+        const commit_t* commit = branch_commit(branch, i);
+        if (commit && reconstruct_commit(commit, path, &lines, n))
+            break;
+    }
+    return lines;
+}
+
+/**
+ * @brief reconstruct the content of a single path at a commit straight from the refs, without
+ *  reading the repository; the history is walked back from the commit, commits that did not change
+ *  the path are skipped from their bloom filter alone, and only the diffs of the rest are read.
+ *
+ * @param history the history of the branch, where <hash> was the last commit returned.
+ * @param hash the hash string of the commit.
+ * @param path the path of the file to be reconstructed.
+ * @param n pointer to store the number of lines reconstructed.
+ * @return the allocated lines of the file, or 0x0 if the path does not exist at the commit.
+ */
+char**
+reconstruct_history_op(history_t* history, const char* hash, const char* path, size_t* n) {
+    /* assert on the parameters. */
+    assert(history != 0x0);
+    assert(hash != 0x0);
+    assert(path != 0x0);
+    assert(n != 0x0);
+    *n = 0;
+
+    /* walk backwards from the commit, reading the diffs only when the path may have changed and
+     *  the version that commit wrote was not recently read. */
+    char** lines = 0x0;
+    for (const char* current = hash; current; current = next_history(history, 0x0)) {
+        char commit_path[256];
+        snprintf(commit_path, 256, ".lit/objects/commits/%.2s/%.38s", current, current + 2);
+        commit_t* header = read_commit_header(commit_path);
+        bool may_change = commit_may_change(header, path), \
+            found = may_change && get_version(header->hash, path, n, &lines);
+        free_commit(header);
+        if (found)
+            break;
+        if (!may_change)
+            continue;
+        commit_t* commit = read_commit(commit_path);
+        found = reconstruct_commit(commit, path, &lines, n);
+        if (found)
+            put_version(commit->hash, path, lines, *n);
+        free_commit(commit);
+        if (found)
+            break;
+    }
+    return lines;
+}
+
+/**
+ * a data structure shared by every worker thread of a delta between two commits.
+ */
+typedef struct {
+    const branch_t* from, *to; /* branches of the old and new commit. */
+    size_t from_idx, to_idx; /* index of the old and new commit on their branch. */
+    dyna_t* deltas; /* array of delta_t, one per changed path (sorted by path). */
+    size_t next; /* index of the next delta to be computed (guarded by the lock). */
+    pthread_mutex_t lock; /* lock on the next delta. */
+} delta_batch_t;
+
+/**
+ * @brief collect every file path changed by the commits in (<base>, <idx>] on a branch.
+ *
+ * @param paths hashed set of paths to be added to.
+ * @param branch the branch to be collected from.
+ * @param base the index of the ancestor commit (exclusive, -1 for the start of the branch).
+ * @param idx the index of the last commit (inclusive).
+ */
+internal void
+collect_delta_paths(hmap_t* paths, const branch_t* branch, long base, size_t idx) {
+    for (size_t i = (size_t) (base + 1); i <= idx; i++) {
+        const commit_t* commit = branch_commit(branch, i);
+        if (!commit) continue;
+        _foreach_it(commit->changes, const diff_t*, change, j)
+            /* folders have no content, and a rename changes both the stored and the new path. */
+            if (change->type == E_DIFF_FOLDER_NEW || change->type == E_DIFF_FOLDER_DELETED || \
+                change->type == E_DIFF_FOLDER_MODIFIED)
+                continue;
+            if (!hmap_has(paths, change->new_path))
+                hmap_put(paths, change->new_path, 0x0);
+            if (!hmap_has(paths, change->stored_path))
+                hmap_put(paths, change->stored_path, 0x0);
+        _endforeach;
+    }
+}
+
+/**
+ * @brief append a formatted line to a delta.
+ *
+ * @param delta the delta to be appended to.
+ * @param prefix the prefix of the line (' ', '-' or '+').
+ * @param line the line.
+ */
+internal void
+append_to_delta(delta_t* delta, char prefix, const char* line) {
+    size_t length = strlen(line);
+    char* buffer = calloc(1, length + 2);
+    buffer[0] = prefix;
+    memcpy(buffer + 1, line, length);
+    dyna_push(delta->lines, buffer);
+}
+
+/**
+ * @brief format the hunks between two versions of a path as unified diff lines, hunks closer
+ *  than twice the context are joined together.
+ *
+ * @param delta the delta to be appended to.
+ * @param a the lines of the old version.
+ * @param m the number of lines in the old version.
+ * @param b the lines of the new version.
+ * @param hunks the hunks that turn <a> into <b>.
+ */
+internal void
+format_delta(delta_t* delta, char** a, size_t m, char** b, const dyna_t* hunks) {
+    for (size_t h = 0; h < hunks->length;) {
+        /* gather every hunk within reach of the context of the last one. */
+        size_t last = h;
+        while (last + 1 < hunks->length) {
+            const hunk_t* current = hunks->data[last], *next = hunks->data[last + 1];
+            if (next->base_start - (current->base_start + current->base_count) > 2 * DELTA_CONTEXT)
+                break;
+            last++;
+        }
+        const hunk_t* first = hunks->data[h], *final = hunks->data[last];
+
+        /* the range of the joined hunks on both sides, with the context around them. */
+        size_t base_lo = first->base_start > DELTA_CONTEXT ? first->base_start - DELTA_CONTEXT : 0;
+        size_t other_lo = first->other_start - (first->base_start - base_lo);
+        size_t base_end = final->base_start + final->base_count;
+        size_t base_hi = base_end + DELTA_CONTEXT < m ? base_end + DELTA_CONTEXT : m;
+        size_t other_hi = final->other_start + final->other_count + (base_hi - base_end);
+        char header[128];
+        snprintf(header, 128, "@@ -%lu,%lu +%lu,%lu @@", \
+            base_hi > base_lo ? base_lo + 1 : base_lo, base_hi - base_lo, \
+            other_hi > other_lo ? other_lo + 1 : other_lo, other_hi - other_lo);
+        dyna_push(delta->lines, strdup(header));
+
+        /* interleave the hunks with the unchanged lines between them. */
+        size_t pos = base_lo;
+        for (size_t k = h; k <= last; k++) {
+            const hunk_t* hunk = hunks->data[k];
+            while (pos < hunk->base_start) append_to_delta(delta, ' ', a[pos++]);
+            for (size_t l = 0; l < hunk->base_count; l++)
+                append_to_delta(delta, '-', a[hunk->base_start + l]);
+            for (size_t l = 0; l < hunk->other_count; l++)
+                append_to_delta(delta, '+', b[hunk->other_start + l]);
+            pos = hunk->base_start + hunk->base_count;
+        }
+        while (pos < base_hi) append_to_delta(delta, ' ', a[pos++]);
+        h = last + 1;
+    }
+}
+
+/**
+ * @brief worker thread of a delta; reconstructs both versions of each path in memory and formats
+ *  the hunks between them, until there are no paths left.
+ *
+ * @param arg pointer to the delta_batch_t.
+ * @return 0x0.
+ */
+internal void*
+delta_worker(void* arg) {
+    delta_batch_t* batch = arg;
+    for (;;) {
+        /* take the next path. */
+        pthread_mutex_lock(&batch->lock);
+        delta_t* delta = dyna_get(batch->deltas, batch->next++);
+        pthread_mutex_unlock(&batch->lock);
+        if (!delta) break;
+
+        /* a path missing on a side is compared as empty. */
+        size_t m = 0, n = 0;
+        char** a = reconstruct_op(batch->from, batch->from_idx, delta->path, &m);
+        char** b = reconstruct_op(batch->to, batch->to_idx, delta->path, &n);
+        delta->existed = a != 0x0;
+        delta->exists = b != 0x0;
+        if (a || b) {
+            dyna_t* hunks = compute_hunks(a, m, b, n);
+            format_delta(delta, a, m, b, hunks);
+            free_hunks(hunks);
+        }
+        free_lines(a, m);
+        free_lines(b, n);
+    }
+    return 0x0;
+}
+
+/**
+ * @brief qsort comparator for deltas by path.
+ */
+internal int
+compare_deltas(const void* a, const void* b) {
+    return strcmp((*(const delta_t**) a)->path, (*(const delta_t**) b)->path);
+}
+
+/**
+ * @brief compute the deltas of every path changed between two commits entirely in memory; only
+ *  the paths changed after their common ancestor (on either side) are reconstructed, and each
+ *  path is compared on its own worker thread.
+ *
+ * @param from the branch of the old commit.
+ * @param from_idx the index of the old commit on its branch.
+ * @param to the branch of the new commit.
+ * @param to_idx the index of the new commit on its branch.
+ * @param base the index of the common ancestor on both branches (-1 if there is none).
+ * @return a dynamic array of allocated delta_t sorted by path (paths without changes are left out).
+ */
+dyna_t*
+delta_op(const branch_t* from, size_t from_idx, const branch_t* to, size_t to_idx, long base) {
+    /* assert on the branches. */
+    assert(from != 0x0);
+    assert(to != 0x0);
+
+    /* only the paths changed on either side of the ancestor can differ. */
+    hmap_t* paths = hmap_create();
+    collect_delta_paths(paths, from, base, from_idx);
+    collect_delta_paths(paths, to, base, to_idx);
+    delta_batch_t batch = { .from = from, .to = to, .from_idx = from_idx, .to_idx = to_idx, \
+        .deltas = dyna_create(), .next = 0 };
+    _hmap_foreach(paths, entry)
+        delta_t* delta = calloc(1, sizeof *delta);
+        delta->path = strdup(entry->key);
+        delta->lines = dyna_create();
+        dyna_push(batch.deltas, delta);
+    _endforeach;
+    hmap_free(paths);
+    if (batch.deltas->length > 1)
+        qsort(batch.deltas->data, batch.deltas->length, sizeof(delta_t*), compare_deltas);
+
+    /* reconstruct and compare in parallel, one worker per core at most. */
+    pthread_mutex_init(&batch.lock, 0x0);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n_threads = cores < 1 ? 1 : (size_t) cores;
+    if (n_threads > batch.deltas->length) n_threads = batch.deltas->length;
+    pthread_t* threads = calloc(n_threads + 1, sizeof *threads);
+    for (size_t t = 0; t < n_threads; t++)
+        if (pthread_create(&threads[t], 0x0, delta_worker, &batch) != 0) {
+            llog(E_LOGGER_LEVEL_ERROR, "pthread_create failed; could not start delta worker.\n");
+            exit(EXIT_FAILURE);
+        }
+    for (size_t t = 0; t < n_threads; t++)
+        pthread_join(threads[t], 0x0);
+    free(threads);
+    pthread_mutex_destroy(&batch.lock);
+
+    /* leave out the paths that ended up the same on both sides. */
+    dyna_t* deltas = dyna_create();
+    _foreach(batch.deltas, delta_t*, delta)
+        if (delta->lines->length > 0 || delta->existed != delta->exists)
+            dyna_push(deltas, delta);
+        else
+            free_delta(delta);
+    _endforeach;
+    dyna_free(batch.deltas);
+    return deltas;
+}
+
+/**
+ * @brief free a delta returned by @ref delta_op().
+ *
+ * @param delta the delta to be freed.
+ */
+void
+free_delta(delta_t* delta) {
+    /* assert on the delta. */
+    assert(delta != 0x0);
+    _foreach(delta->lines, char*, line)
+        free(line);
+    _endforeach;
+    dyna_free(delta->lines);
+    free(delta->path);
+    free(delta);
+}
+
+/**
+ * a data structure shared by every worker thread reconstructing the tree of a commit.
+ */
+typedef struct {
+    const branch_t* branch; /* branch that the commit is on. */
+    dyna_t* entries; /* array of tree_entry_t (sorted by path). */
+    const char* root; /* directory each file is written under (0x0 to keep them in memory). */
+    size_t next; /* index of the next entry to be reconstructed (guarded by the lock). */
+    pthread_mutex_t lock; /* lock on the next entry. */
+} tree_batch_t;
+
+/**
+ * @brief worker thread of a tree; reconstructs each path from the diff that last wrote it, until
+ *  there are no paths left.
+ *
+ * @param arg pointer to the tree_batch_t.
+ * @return 0x0.
+ */
+internal void*
+tree_worker(void* arg) {
+    tree_batch_t* batch = arg;
+    for (;;) {
+        /* take the next path. */
+        pthread_mutex_lock(&batch->lock);
+        tree_entry_t* entry = dyna_get(batch->entries, batch->next++);
+        pthread_mutex_unlock(&batch->lock);
+        if (!entry) break;
+
+        /* the diff that last wrote the path holds its full content. */
+        const commit_t* commit = branch_commit(batch->branch, entry->idx);
+        if (!commit || !reconstruct_commit(commit, entry->path, &entry->lines, &entry->n) || \
+            !entry->lines)
+            entry->lines = calloc(1, sizeof(char*));
+
+        /* when exporting, the file is written out (and its lines dropped) straight away. */
+        if (batch->root) {
+            const char* path = entry->path;
+            while (!strncmp(path, "./", 2)) path += 2;
+            size_t length = strlen(batch->root) + strlen(path) + 2;
+            char* destination = calloc(1, length);
+            snprintf(destination, length, "%s/%s", batch->root, path);
+            fwritels(destination, entry->lines, entry->n);
+            free(destination);
+            free_lines(entry->lines, entry->n);
+            entry->lines = 0x0;
+            entry->n = 0;
+        }
+    }
+    return 0x0;
+}
+
+/**
+ * @brief qsort comparator for tree entries by path.
+ */
+internal int
+compare_tree_entries(const void* a, const void* b) {
+    return strcmp((*(const tree_entry_t**) a)->path, (*(const tree_entry_t**) b)->path);
+}
+
+/**
+ * @brief walk the history up to a commit once to find the commit that last wrote each path, then
+ *  reconstruct each path from that commit alone on a worker thread.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @param root the directory each file is written under (0x0 to keep them in memory).
+ * @return a dynamic array of allocated tree_entry_t sorted by path.
+ */
+internal dyna_t*
+run_tree(const branch_t* branch, size_t idx, const char* root) {
+    /* walk forward up to the commit, keeping the last commit that wrote each path. */
+    hmap_t* paths = hmap_create();
+    for (size_t i = 0; i <= idx && i < branch_length(branch); i++) {
+        const commit_t* commit = branch_commit(branch, i);
+        if (!commit) continue;
+        _foreach_it(commit->changes, const diff_t*, change, j)
+            switch (change->type) {
+                case (E_DIFF_FILE_NEW):
+                case (E_DIFF_FILE_MODIFIED): {
+                    if (strcmp(change->stored_path, change->new_path) && \
+                        hmap_has(paths, change->stored_path))
+                        hmap_remove(paths, change->stored_path);
+                    hmap_put(paths, change->new_path, (void*) (i + 1));
+                    break;
+                }
+                case (E_DIFF_FILE_DELETED): {
+                    if (hmap_has(paths, change->stored_path))
+                        hmap_remove(paths, change->stored_path);
+                    break;
+                }
+                default: ;
+            }
+        _endforeach;
+    }
+    tree_batch_t batch = { .branch = branch, .entries = dyna_create(), .root = root, .next = 0 };
+    _hmap_foreach(paths, slot)
+        tree_entry_t* entry = calloc(1, sizeof *entry);
+        entry->path = strdup(slot->key);
+        entry->idx = (size_t) slot->value - 1;
+        dyna_push(batch.entries, entry);
+    _endforeach;
+    hmap_free(paths);
+    if (batch.entries->length > 1)
+        qsort(batch.entries->data, batch.entries->length, sizeof(tree_entry_t*), \
+            compare_tree_entries);
+
+    /* reconstruct in parallel, one worker per core at most. */
+    pthread_mutex_init(&batch.lock, 0x0);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n_threads = cores < 1 ? 1 : (size_t) cores;
+    if (n_threads > batch.entries->length) n_threads = batch.entries->length;
+    pthread_t* threads = calloc(n_threads + 1, sizeof *threads);
+    for (size_t t = 0; t < n_threads; t++)
+        if (pthread_create(&threads[t], 0x0, tree_worker, &batch) != 0) {
+            llog(E_LOGGER_LEVEL_ERROR, "pthread_create failed; could not start tree worker.\n");
+            exit(EXIT_FAILURE);
+        }
+    for (size_t t = 0; t < n_threads; t++)
+        pthread_join(threads[t], 0x0);
+    free(threads);
+    pthread_mutex_destroy(&batch.lock);
+    return batch.entries;
+}
+
+/**
+ * @brief reconstruct every file that exists at a commit entirely in memory; the history is
+ *  walked once to find the commit that last wrote each path, then each path is reconstructed
+ *  from that commit alone on a worker thread.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @return a dynamic array of allocated tree_entry_t sorted by path.
+ */
+dyna_t*
+tree_op(const branch_t* branch, size_t idx) {
+    /* assert on the branch. */
+    assert(branch != 0x0);
+    return run_tree(branch, idx, 0x0);
+}
+
+/**
+ * @brief write every file that exists at a commit under a directory, without touching the
+ *  working tree; each file is reconstructed and written out on a worker thread.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @param root the directory to be written under.
+ * @return the number of files written.
+ */
+size_t
+export_op(const branch_t* branch, size_t idx, const char* root) {
+    /* assert on the branch and the directory. */
+    assert(branch != 0x0);
+    assert(root != 0x0);
+    dyna_t* entries = run_tree(branch, idx, root);
+    size_t count = entries->length;
+    _foreach(entries, tree_entry_t*, entry)
+        free_tree_entry(entry);
+    _endforeach;
+    dyna_free(entries);
+    return count;
+}
+
+/**
+ * @brief free a tree entry returned by @ref tree_op().
+ *
+ * @param entry the entry to be freed.
+ */
+void
+free_tree_entry(tree_entry_t* entry) {
+    /* assert on the entry. */
+    assert(entry != 0x0);
+    free_lines(entry->lines, entry->n);
+    free(entry->path);
+    free(entry);
+}
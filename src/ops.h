@@ -11,6 +11,40 @@
 /*! @uses branch_t */
 #include "branch.h"
 
+/*! @uses hmap_t. */
+#include "hmap.h"
+
+/**
+ * a data structure for a planned working tree transition; the final action for every path
+ *  touched by a sequence of commits (applied forward or in reverse), so that applying the
+ *  transition writes or removes each path exactly once.
+ */
+typedef struct {
+    hmap_t* actions; /* path -> transition_action_t*, the last planned action wins. */
+} transition_t;
+
+/**
+ * a data structure for the delta of a single path between two commits; the unified diff lines
+ *  (hunk headers, and lines prefixed with ' ', '-' or '+') and whether the path exists on
+ *  either side.
+ */
+typedef struct {
+    char* path; /* path of the file. */
+    dyna_t* lines; /* allocated unified diff lines. */
+    bool existed, exists; /* if the path exists at the old and at the new commit. */
+} delta_t;
+
+/**
+ * a data structure for a single file in the tree of a commit; its path, the commit whose diff
+ *  holds its full content, and the reconstructed lines.
+ */
+typedef struct {
+    char* path; /* path of the file. */
+    size_t idx; /* index of the commit that last wrote the path. */
+    char** lines; /* allocated lines of the file. */
+    size_t n; /* number of lines. */
+} tree_entry_t;
+
 /**
  * @brief apply the commit forward to the files currently existing.
  *
@@ -44,4 +78,132 @@ rollback_op(branch_t* branch, const commit_t* commit);
  */
 void
 checkout_op(branch_t* branch, const commit_t* commit);
+
+/**
+ * @brief create an empty working tree transition.
+ *
+ * @return an allocated transition.
+ */
+transition_t*
+create_transition();
+
+/**
+ * @brief plan applying a commit forward as part of a transition (nothing is written yet).
+ *
+ * @param transition the transition to be planned onto.
+ * @param commit the commit to be applied forward.
+ */
+void
+forward_transition(transition_t* transition, const commit_t* commit);
+
+/**
+ * @brief plan applying a commit backwards (inverse) as part of a transition (nothing is
+ *  written yet).
+ *
+ * @param transition the transition to be planned onto.
+ * @param commit the commit to be applied backwards.
+ */
+void
+reverse_transition(transition_t* transition, const commit_t* commit);
+
+/**
+ * @brief apply a planned transition to the working tree, writing or removing each touched path
+ *  once, and then free the transition.
+ *
+ * @param transition the transition to be applied.
+ */
+void
+apply_transition(transition_t* transition);
+
+/**
+ * @brief move the working tree between two commits on a branch in one coalesced transition.
+ *
+ * @param branch the branch that both commits are on.
+ * @param from the index of the commit the working tree is currently at.
+ * @param to the index of the commit to move the working tree to.
+ */
+void
+transition_op(const branch_t* branch, size_t from, size_t to);
+
+/**
+ * @brief reconstruct the content of a single path at a commit in memory, without touching the
+ *  working tree; the most recent diff that wrote the path holds its full content.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @param path the path of the file to be reconstructed.
+ * @param n pointer to store the number of lines reconstructed.
+ * @return the allocated lines of the file, or 0x0 if the path does not exist at the commit.
+ */
+char**
+reconstruct_op(const branch_t* branch, size_t idx, const char* path, size_t* n);
+
+/**
+ * @brief reconstruct the content of a single path at a commit straight from the refs, without
+ *  reading the repository; the history is walked back from the commit, commits that did not change
+ *  the path are skipped from their bloom filter alone, and only the diffs of the rest are read.
+ *
+ * @param history the history of the branch, where <hash> was the last commit returned.
+ * @param hash the hash string of the commit.
+ * @param path the path of the file to be reconstructed.
+ * @param n pointer to store the number of lines reconstructed.
+ * @return the allocated lines of the file, or 0x0 if the path does not exist at the commit.
+ */
+char**
+reconstruct_history_op(history_t* history, const char* hash, const char* path, size_t* n);
+
+/**
+ * @brief compute the deltas of every path changed between two commits entirely in memory; only
+ *  the paths changed after their common ancestor (on either side) are reconstructed, and each
+ *  path is compared on its own worker thread.
+ *
+ * @param from the branch of the old commit.
+ * @param from_idx the index of the old commit on its branch.
+ * @param to the branch of the new commit.
+ * @param to_idx the index of the new commit on its branch.
+ * @param base the index of the common ancestor on both branches (-1 if there is none).
+ * @return a dynamic array of allocated delta_t sorted by path (paths without changes are left out).
+ */
+dyna_t*
+delta_op(const branch_t* from, size_t from_idx, const branch_t* to, size_t to_idx, long base);
+
+/**
+ * @brief free a delta returned by @ref delta_op().
+ *
+ * @param delta the delta to be freed.
+ */
+void
+free_delta(delta_t* delta);
+
+/**
+ * @brief reconstruct every file that exists at a commit entirely in memory; the history is
+ *  walked once to find the commit that last wrote each path, then each path is reconstructed
+ *  from that commit alone on a worker thread.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @return a dynamic array of allocated tree_entry_t sorted by path.
+ */
+dyna_t*
+tree_op(const branch_t* branch, size_t idx);
+
+/**
+ * @brief write every file that exists at a commit under a directory, without touching the
+ *  working tree; each file is reconstructed and written out on a worker thread.
+ *
+ * @param branch the branch that the commit is on.
+ * @param idx the index of the commit on the branch.
+ * @param root the directory to be written under.
+ * @return the number of files written.
+ */
+size_t
+export_op(const branch_t* branch, size_t idx, const char* root);
+
+/**
+ * @brief free a tree entry returned by @ref tree_op().
+ *
+ * @param entry the entry to be freed.
+ */
+void
+free_tree_entry(tree_entry_t* entry);
 #endif /* OPS_H */
\ No newline at end of file
@@ -4,7 +4,7 @@
  */
 #include "rebase.h"
 
-/*! @uses checkout_op. */
+/*! @uses transition_op, reconstruct_op. */
 #include "ops.h"
 
 /*! @uses bool, true, false. */
@@ -13,7 +13,7 @@
 /*! @uses assert. */
 #include <assert.h>
 
-/*! @uses strcmp. */
+/*! @uses strcmp, memcpy. */
 #include <string.h>
 
 /*! @uses fprintf. */
@@ -22,93 +22,596 @@
 /*! @uses diff_t. */
 #include "diff.h"
 
+/*! @uses hmap_t, hmap_put, hmap_has, _hmap_foreach. */
+#include "hmap.h"
+
+/*! @uses merge_lines, merge_conflict_t. */
+#include "merge.h"
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
 /*! @uses internal. */
 #include "utl.h"
 
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/*! @uses pthread_t, pthread_create, pthread_join, pthread_mutex_t. */
+#include <pthread.h>
+
+/*! @uses sysconf, _SC_NPROCESSORS_ONLN. */
+#include <unistd.h>
+
+/**
+ * a data structure holding the state of a hunk-level (three-way) merge of a single path that
+ *  was changed on both sides of the divergence; the content at the ancestor, the content at the
+ *  destination head, and the content the rebased commits have produced so far.
+ */
+typedef struct {
+    char** base, **ours, **current; /* ancestor, destination head and rebased content. */
+    size_t nb, no, nc; /* number of lines in each. */
+    bool owns_base; /* whether the base was reconstructed on the source (never cached). */
+} line_merge_t;
+
+/**
+ * a data structure for a genuine conflict found by the rebase planner; either a path that can
+ *  only be compared as a whole (folders, renames, deletions), or overlapping hunks in a file.
+ */
+typedef struct {
+    const char* path; /* conflicting path (owned by the plans path sets). */
+    dyna_t* hunks; /* array of merge_conflict_t, or 0x0 for a whole-path conflict. */
+} rebase_conflict_t;
+
+/**
+ * a data structure for a version of a path reconstructed on the base branch of a batch rebase.
+ */
+typedef struct {
+    char** lines; /* reconstructed lines, or 0x0 if the path does not exist at that commit. */
+    size_t n; /* number of lines. */
+} reconstructed_t;
+
+/**
+ * a data structure holding what a batch rebase shares between every branch rebased onto the
+ *  same base; the base-side path sets (one per ancestor) and the base-side versions of each
+ *  path (one per ancestor or head), both computed once and shared by all worker threads.
+ */
+typedef struct {
+    hmap_t* paths; /* "<idx>" -> hmap_t* of the paths changed on the base after <idx>. */
+    hmap_t* lines; /* "<idx>:<path>" -> reconstructed_t* of the path at <idx> on the base. */
+    pthread_mutex_t lock; /* guards both maps, and commit creation (localtime is not reentrant). */
+} rebase_cache_t;
+
+/**
+ * a data structure holding what the rebase planner computes about the divergence of two
+ *  branches; the common ancestor on each side, a hashed set of every path changed after the
+ *  ancestor on each side, the paths changed on both sides that merge cleanly line by line, and
+ *  the genuine conflicts.
+ */
+typedef struct {
+    branch_t* destination, *source; /* branch rebased onto, and branch rebased from. */
+    commit_t* ancestor; /* common ancestor commit (0x0 if the branches are unrelated). */
+    long destination_idx, source_idx; /* index of the ancestor on each branch. */
+    long source_base; /* index of the last source commit already on the destination (a prefix). */
+    hmap_t* destination_paths, *source_paths; /* path -> first commit_t* that changed it. */
+    hmap_t* merges; /* path -> line_merge_t* for paths changed on both sides without overlap. */
+    hmap_t* applied; /* hashes of source commits already on the destination (after the ancestor). */
+    dyna_t* conflicts; /* array of rebase_conflict_t. */
+    rebase_cache_t* cache; /* shared base-side data of a batch rebase (0x0 for a single one). */
+} rebase_plan_t;
+
+/* the content of a path that does not exist at the ancestor (never freed). */
+internal char* empty_lines[1] = { 0x0 };
+
+/**
+ * @brief check if a commit is in a hashed set of commit hashes, by its own hash or by the hash
+ *  of the original it was rewritten from.
+ *
+ * @param applied hashed set of commit hashes (can be 0x0).
+ * @param commit the commit to be checked.
+ * @return true if the commit is in the set.
+ */
+internal bool
+is_applied(const hmap_t* applied, const commit_t* commit) {
+    if (!applied) return false;
+    char* hash = strsha1(commit->hash);
+    bool found = hmap_has(applied, hash);
+    free(hash);
+    if (!found && commit->has_rebased) {
+        hash = strsha1(commit->rebased);
+        found = hmap_has(applied, hash);
+        free(hash);
+    }
+    return found;
+}
+
 /**
- * @brief are the two commits conflicting in their changes at all?
+ * @brief collect every path changed by the commits after <idx> on a branch into a hashed set.
  *
- * @param first_commit the first commit to compare.
- * @param second_commit the second commit to compare.
- * @return true if there are any commit conflicts (printed to stderr).
+ * @param branch the branch to be collected from.
+ * @param idx the index of the ancestor commit (exclusive).
+ * @param skip hashed set of commit hashes to be skipped (can be 0x0).
+ * @return a hash map of path -> first commit_t* after the ancestor that changed the path.
+ */
+internal hmap_t*
+collect_changed_paths(const branch_t* branch, const long idx, const hmap_t* skip) {
+    /* assert on the branch. */
+    assert(branch != 0x0);
+
+    /* iterate through each commit after the ancestor. */
+    hmap_t* paths = hmap_create();
+    for (size_t i = (size_t) (idx + 1); i < branch_length(branch); i++) {
+        commit_t* commit = branch_commit(branch, i);
+        if (is_applied(skip, commit)) continue;
+        _foreach_it(commit->changes, const diff_t*, change, j)
+            /* a rename changes both the stored and the new path. */
+            if (!hmap_has(paths, change->new_path))
+                hmap_put(paths, change->new_path, commit);
+            if (strcmp(change->stored_path, change->new_path) != 0 && \
+                !hmap_has(paths, change->stored_path))
+                hmap_put(paths, change->stored_path, commit);
+        _endforeach;
+    }
+    return paths;
+}
+
+/**
+ * @brief can the changes to <path> after <idx> on a branch be merged line by line? only files
+ *  that are created or modified in place (no folders, renames or deletions) can be.
+ *
+ * @param branch the branch to be checked.
+ * @param idx the index of the ancestor commit (exclusive).
+ * @param path the path to be checked.
+ * @return true if every change to the path is a line-level change.
  */
 internal bool
-is_conflicting_commits(const commit_t* first_commit, const commit_t* second_commit) {
-    /* assert on the commits. */
-    assert(first_commit != 0x0);
-    assert(second_commit != 0x0);
-
-    /* iterate through each change in the first commit */
-    _foreach_it(first_commit->changes, const diff_t*, first_change, i)
-        /* iterate through each change in the second commit. */
-        _foreach_it(second_commit->changes, const diff_t*, second_change, j)
-            /* if the filenames match at all, there could be a conflict. */
-            if (!strcmp(first_change->new_path, second_change->new_path)) {
-                fprintf(stderr, "found conflicting changes in %s/@%u vs %s/@%u\n", \
-                    strsha1(first_commit->hash), first_change->crc, strsha1(second_commit->hash), \
-                    second_change->crc);
-                return true;
+is_line_mergeable(const branch_t* branch, const long idx, const char* path) {
+    for (size_t i = (size_t) (idx + 1); i < branch_length(branch); i++) {
+        const commit_t* commit = branch_commit(branch, i);
+        _foreach_it(commit->changes, const diff_t*, change, j)
+            if (strcmp(change->new_path, path) != 0 && strcmp(change->stored_path, path) != 0)
+                continue;
+            if (change->type != E_DIFF_FILE_NEW && change->type != E_DIFF_FILE_MODIFIED)
+                return false;
+            if (strcmp(change->new_path, change->stored_path) != 0)
+                return false;
+        _endforeach;
+    }
+    return true;
+}
+
+/**
+ * @brief free an array of lines that may be empty (ffreels asserts on a count of zero).
+ *
+ * @param lines the lines to be freed (can be 0x0).
+ * @param n the number of lines.
+ */
+internal void
+free_lines(char** lines, size_t n) {
+    if (!lines || lines == empty_lines) return;
+    if (n == 0) free(lines);
+    else ffreels(lines, n);
+}
+
+/**
+ * @brief free a rebase plan, its path sets, merge states and conflicts (the branches, commits
+ *  and anything shared through the cache are not owned).
+ *
+ * @param plan the rebase plan to be freed.
+ */
+internal void
+free_rebase_plan(rebase_plan_t* plan) {
+    /* assert on the plan. */
+    assert(plan != 0x0);
+    if (plan->merges) {
+        _hmap_foreach(plan->merges, entry)
+            line_merge_t* state = entry->value;
+            if (state->current != state->ours) free_lines(state->current, state->nc);
+            if (!plan->cache || state->owns_base) free_lines(state->base, state->nb);
+            if (!plan->cache) free_lines(state->ours, state->no);
+            free(state);
+        _endforeach;
+        hmap_free(plan->merges);
+    }
+    if (plan->conflicts) {
+        _foreach(plan->conflicts, rebase_conflict_t*, conflict)
+            if (conflict->hunks) {
+                _foreach_it(conflict->hunks, merge_conflict_t*, hunk, j)
+                    free(hunk);
+                _endforeach;
+                dyna_free(conflict->hunks);
             }
+            free(conflict);
         _endforeach;
-    _endforeach;
+        dyna_free(plan->conflicts);
+    }
+    if (plan->destination_paths && !plan->cache) hmap_free(plan->destination_paths);
+    if (plan->applied) hmap_free(plan->applied);
+    if (plan->source_paths) hmap_free(plan->source_paths);
+    free(plan);
+}
+
+/**
+ * @brief push a genuine conflict onto the plan.
+ *
+ * @param plan the rebase plan.
+ * @param path the conflicting path.
+ * @param hunks array of merge_conflict_t, or 0x0 for a whole-path conflict.
+ */
+internal void
+push_conflict(rebase_plan_t* plan, const char* path, dyna_t* hunks) {
+    rebase_conflict_t* conflict = calloc(1, sizeof *conflict);
+    *conflict = (rebase_conflict_t) { .path = path, .hunks = hunks };
+    dyna_push(plan->conflicts, conflict);
+}
+
+/**
+ * @brief reconstruct a path at <idx> on the destination, through the shared cache of a batch
+ *  rebase if there is one (the lines are then owned by the cache).
+ *
+ * @param plan the rebase plan.
+ * @param idx the index of the commit on the destination.
+ * @param path the path to be reconstructed.
+ * @param n pointer to store the number of lines.
+ * @return the lines of the path, or 0x0 if it does not exist at that commit.
+ */
+internal char**
+reconstruct_destination(const rebase_plan_t* plan, size_t idx, const char* path, size_t* n) {
+    if (!plan->cache)
+        return reconstruct_op(plan->destination, idx, path, n);
+
+    /* every branch forked at the same point asks for the same versions. */
+    char key[1024];
+    snprintf(key, sizeof key, "%lu:%s", idx, path);
+    pthread_mutex_lock(&plan->cache->lock);
+    reconstructed_t* version = hmap_get(plan->cache->lines, key);
+    if (!version) {
+        version = calloc(1, sizeof *version);
+        version->lines = reconstruct_op(plan->destination, idx, path, &version->n);
+        hmap_put(plan->cache->lines, key, version);
+    }
+    pthread_mutex_unlock(&plan->cache->lock);
+    *n = version->n;
+    return version->lines;
+}
+
+/**
+ * @brief collect the paths changed on the destination after <idx>, through the shared cache of
+ *  a batch rebase if there is one (the set is then owned by the cache).
+ *
+ * @param plan the rebase plan.
+ * @param idx the index of the ancestor on the destination.
+ * @return a hash map of path -> first commit_t* after the ancestor that changed the path.
+ */
+internal hmap_t*
+collect_destination_paths(const rebase_plan_t* plan, long idx) {
+    if (!plan->cache)
+        return collect_changed_paths(plan->destination, idx, 0x0);
 
-    /* return if it is conflicting. */
-    return false;
+    /* branches forked at the same point share the same set. */
+    char key[32];
+    snprintf(key, sizeof key, "%ld", idx);
+    pthread_mutex_lock(&plan->cache->lock);
+    hmap_t* paths = hmap_get(plan->cache->paths, key);
+    if (!paths) {
+        paths = collect_changed_paths(plan->destination, idx, 0x0);
+        hmap_put(plan->cache->paths, key, paths);
+    }
+    pthread_mutex_unlock(&plan->cache->lock);
+    return paths;
 }
 
-/* minimum value macro. */
-#define min(a, b) ((a) < (b) ? (a) : (b))
+/**
+ * @brief compare the changes both sides made to a path line by line; if the hunks are disjoint
+ *  the path is added to the plans merges, otherwise it is a genuine conflict.
+ *
+ * @param plan the rebase plan.
+ * @param path the path changed on both sides (owned by the plans path sets).
+ */
+internal void
+plan_line_merge(rebase_plan_t* plan, const char* path) {
+    /* folders, renames and deletions can only be compared as a whole. */
+    if (!is_line_mergeable(plan->destination, plan->destination_idx, path) || \
+        !is_line_mergeable(plan->source, plan->source_base, path)) {
+        push_conflict(plan, path, 0x0);
+        return;
+    }
+
+    /* reconstruct the three versions in memory, a path created on both sides has an empty base.
+     *  once a prefix of the source is already on the destination, the base is the source after
+     *  it; both sides then only differ from it by what the other does not have. */
+    line_merge_t* state = calloc(1, sizeof *state);
+    size_t nt = 0;
+    state->owns_base = plan->source_base != plan->source_idx;
+    state->base = state->owns_base ? \
+        reconstruct_op(plan->source, (size_t) plan->source_base, path, &state->nb) : \
+        reconstruct_destination(plan, plan->destination_idx, path, &state->nb);
+    if (!state->base) state->base = empty_lines;
+    state->ours = reconstruct_destination(plan, branch_length(plan->destination) - 1, \
+        path, &state->no);
+    char** theirs = reconstruct_op(plan->source, branch_length(plan->source) - 1, path, &nt);
+    if (!state->ours || !theirs) {
+        push_conflict(plan, path, 0x0);
+        free_lines(theirs, nt);
+        if (!plan->cache || state->owns_base) free_lines(state->base, state->nb);
+        if (!plan->cache) free_lines(state->ours, state->no);
+        free(state);
+        return;
+    }
+
+    /* merge the final versions, the replay merges each intermediate version again. */
+    char** merged = 0x0;
+    size_t nm = 0;
+    dyna_t* hunks = dyna_create();
+    e_merge_result_t result = merge_lines(state->base, state->nb, state->ours, state->no, \
+        theirs, nt, &merged, &nm, hunks);
+    free_lines(theirs, nt);
+    if (result == E_MERGE_RESULT_CONFLICT) {
+        push_conflict(plan, path, hunks);
+        if (!plan->cache || state->owns_base) free_lines(state->base, state->nb);
+        if (!plan->cache) free_lines(state->ours, state->no);
+        free(state);
+        return;
+    }
+    free_lines(merged, nm);
+    dyna_free(hunks);
+    state->current = state->ours;
+    state->nc = state->no;
+    hmap_put(plan->merges, path, state);
+}
 
 /**
- * @brief if the current branch can rebase commits on top of the source, without modifications.
+ * @brief plan a rebase of <source> onto <destination>; find the ancestor, build the hashed path
+ *  set for each side of the divergence once, intersect them in linear time, and then compare
+ *  the paths changed on both sides hunk by hunk.
+ *
+ * @param destination the destination branch.
+ * @param source the source branch.
+ * @param cache the shared base-side data of a batch rebase (0x0 for a single rebase).
+ * @return an allocated rebase plan, or 0x0 if no common ancestor was found (printed to stderr).
+ */
+internal rebase_plan_t*
+plan_branches(branch_t* destination, branch_t* source, rebase_cache_t* cache) {
+    /* assert on the destination and the source. */
+    assert(destination != 0x0);
+    assert(source != 0x0);
+    rebase_plan_t* plan = calloc(1, sizeof *plan);
+    plan->destination = destination;
+    plan->source = source;
+    plan->cache = cache;
+
+    /* find the common ancestor, and its index on both sides. */
+    plan->ancestor = find_common_ancestor(plan->destination, plan->source);
+    if (!plan->ancestor) {
+        fprintf(stderr, "no common ancestor found between \'%s\' and \'%s\'\n", \
+            plan->destination->name, plan->source->name);
+        free_rebase_plan(plan);
+        return 0x0;
+    }
+    plan->destination_idx = find_index_commit(plan->destination, plan->ancestor);
+    plan->source_idx = find_index_commit(plan->source, plan->ancestor);
+    if (plan->destination_idx == -1 || plan->source_idx == -1) {
+        fprintf(stderr, "ancestor commit \'%s\' not found in \'%s\'\n", \
+            strsha1(plan->ancestor->hash), plan->destination_idx == -1 ? \
+            plan->destination->name : plan->source->name);
+        free_rebase_plan(plan);
+        return 0x0;
+    }
+
+    /* commits of the source already on the destination (rebased before) are not replayed again;
+     *  the ones that were rewritten are found by the original they were rewritten from. */
+    plan->applied = hmap_create();
+    for (size_t i = (size_t) plan->destination_idx + 1; i < branch_length(plan->destination); i++) {
+        const commit_t* commit = branch_commit(plan->destination, i);
+        char* hash = strsha1(commit->hash);
+        hmap_put(plan->applied, hash, 0x0);
+        free(hash);
+        if (!commit->has_rebased) continue;
+        hash = strsha1(commit->rebased);
+        hmap_put(plan->applied, hash, 0x0);
+        free(hash);
+    }
+
+    /* the source commits right after the ancestor that are already on the destination. */
+    plan->source_base = plan->source_idx;
+    while ((size_t) plan->source_base + 1 < branch_length(plan->source) && \
+        is_applied(plan->applied, branch_commit(plan->source, (size_t) plan->source_base + 1)))
+        plan->source_base++;
+
+    /* build the path set for each side of the divergence. */
+    plan->destination_paths = collect_destination_paths(plan, plan->destination_idx);
+    plan->source_paths = collect_changed_paths(plan->source, plan->source_idx, plan->applied);
+
+    /* intersect the two sets, probing the larger with each path of the smaller, every path
+     *  changed on both sides is then compared line by line. */
+    plan->merges = hmap_create();
+    plan->conflicts = dyna_create();
+    bool smaller_is_source = plan->source_paths->length <= plan->destination_paths->length;
+    const hmap_t* smaller = smaller_is_source ? plan->source_paths : plan->destination_paths, \
+        *larger = smaller_is_source ? plan->destination_paths : plan->source_paths;
+    _hmap_foreach(smaller, entry)
+        if (hmap_has(larger, entry->key))
+            plan_line_merge(plan, entry->key);
+    _endforeach;
+    return plan;
+}
+
+/**
+ * @brief plan a rebase of the source branch onto the destination branch by name.
  *
  * @param repository the repository read from the cwd.
  * @param destination_branch_name the destination branch name.
  * @param source_branch_name the source branch name.
- * @return if rebase is possible on the source branch.
+ * @return an allocated rebase plan, or 0x0 if no common ancestor was found (printed to stderr).
  */
-internal bool
-is_rebase_possible(const repository_t* repository, const char* destination_branch_name, \
+internal rebase_plan_t*
+plan_rebase(const repository_t* repository, const char* destination_branch_name, \
     const char* source_branch_name) {
     /* assert on the repository, destination and then branch name. */
     assert(repository != 0x0);
     assert(destination_branch_name != 0x0);
-    assert(destination_branch_name != 0x0);
+    assert(source_branch_name != 0x0);
 
     /* find the current and active branches. */
-    branch_t* destination = get_branch_repository(repository, destination_branch_name),\
-    * source = get_branch_repository(repository, source_branch_name);
+    return plan_branches(get_branch_repository(repository, destination_branch_name), \
+        get_branch_repository(repository, source_branch_name), 0x0);
+}
 
-    /* find the common ancestor. */
-    commit_t* ancestor = find_common_ancestor(destination, source);
-    if (!ancestor) {
-        fprintf(stderr, "no common ancestor found between \'%s\' and \'%s\'\n", \
-            destination->name, source->name);
-        return false;
-    };
-    size_t ancestor_idx = find_index_commit(destination, ancestor);
-    if (ancestor_idx == (size_t) -1) {
-        fprintf(stderr, "ancestor commit \'%s\' not found in \'%s\'\n", \
-            strsha1(ancestor->hash), destination->name);
-        return false;
-    }
+/**
+ * @brief report every genuine conflict in a rebase plan to stderr.
+ *
+ * @param plan the rebase plan to be reported.
+ */
+internal void
+report_conflicts(const rebase_plan_t* plan) {
+    /* assert on the plan. */
+    assert(plan != 0x0);
+
+    /* print each conflicting path with the first commit on each side that changed it. */
+    _foreach(plan->conflicts, const rebase_conflict_t*, conflict)
+        const commit_t* destination_commit = hmap_get(plan->destination_paths, conflict->path), \
+            *source_commit = hmap_get(plan->source_paths, conflict->path);
+        char* destination_hash = strsha1(destination_commit->hash), \
+            *source_hash = strsha1(source_commit->hash);
+        fprintf(stderr, "found conflicting changes to \'%s\' in %s/\'%s\' vs %s/\'%s\'\n", \
+            conflict->path, destination_hash, plan->destination->name, source_hash, \
+            plan->source->name);
+        free(destination_hash);
+        free(source_hash);
+
+        /* print the overlapping line ranges (of the ancestor version) as well. */
+        if (!conflict->hunks) continue;
+        _foreach_it(conflict->hunks, const merge_conflict_t*, hunk, j)
+            fprintf(stderr, "\tlines %lu-%lu on \'%s\' overlap lines %lu-%lu on \'%s\'\n", \
+                hunk->ours.base_start + 1, hunk->ours.base_start + hunk->ours.base_count, \
+                plan->destination->name, hunk->theirs.base_start + 1, \
+                hunk->theirs.base_start + hunk->theirs.base_count, plan->source->name);
+        _endforeach;
+    _endforeach;
+}
+
+/**
+ * @brief free a commit rewritten by a replay that is discarded; only the diffs of the merged
+ *  paths were created for it, the others are shared with the source commit.
+ *
+ * @param plan the rebase plan.
+ * @param rebased the rewritten commit.
+ */
+internal void
+free_rebased(const rebase_plan_t* plan, commit_t* rebased) {
+    dyna_t* changes = rebased->changes;
+    rebased->changes = dyna_create();
+    _foreach(changes, diff_t*, change)
+        if (hmap_has(plan->merges, change->new_path))
+            dyna_push(rebased->changes, change);
+    _endforeach;
+    dyna_free(changes);
+    free_commit(rebased);
+}
+
+/**
+ * @brief discard a replay that conflicted; the commit being rewritten and every one rewritten
+ *  before it are freed, and each merged path goes back to the destination head.
+ *
+ * @param plan the rebase plan.
+ * @param rebased the commit being rewritten when the replay conflicted.
+ * @param rewritten dynamic array of the commits rewritten before it (emptied).
+ * @param replayed dynamic array of the commits replayed so far (freed).
+ */
+internal void
+discard_replay(rebase_plan_t* plan, commit_t* rebased, dyna_t* rewritten, dyna_t* replayed) {
+    free_rebased(plan, rebased);
+    while (rewritten->length > 0)
+        free_rebased(plan, dyna_pop(rewritten, rewritten->length - 1));
+    dyna_free(replayed);
+    _hmap_foreach(plan->merges, entry)
+        line_merge_t* state = entry->value;
+        if (state->current != state->ours) free_lines(state->current, state->nc);
+        state->current = state->ours;
+        state->nc = state->no;
+    _endforeach;
+}
 
-    /* check each change in commits after the ancestor on <source>
-     *  if there is a change that could raise a conflict in history,
-     *  report the conflict found, continue, and then eventually
-     *  return false. */
-    bool conflict_found = false;
-    for (size_t i = ancestor_idx + 1; i < source->head && i < min(source->commits->length,
-        destination->commits->length); i++) {
-        /* get the commit after the ancestor on the source branch. */
-        commit_t* source_commit = dyna_get(source->commits, i), * destination_commit =
-           dyna_get(destination->commits, i);
+/**
+ * @brief replay the commits after the ancestor on <source> on top of <destination>; commits
+ *  that touch a path changed on both sides are rewritten with diffs against the merged content,
+ *  every other commit is reused as is.
+ *
+ * @param plan the rebase plan (without conflicts).
+ * @param rewritten dynamic array to push the rewritten commits onto (to be written by the caller
+ *  once the whole replay has succeeded, and emptied here otherwise).
+ * @return a dynamic array of the commits to be appended, or 0x0 if an intermediate version
+ *  conflicted (pushed onto the plans conflicts).
+ */
+internal dyna_t*
+replay_commits(rebase_plan_t* plan, dyna_t* rewritten) {
+    /* assert on the plan. */
+    assert(plan != 0x0);
+    assert(rewritten != 0x0);
+    dyna_t* replayed = dyna_create();
+    for (size_t k = (size_t) plan->source_idx + 1; k < branch_length(plan->source); k++) {
+        commit_t* commit = branch_commit(plan->source, k);
+        if (is_applied(plan->applied, commit))
+            continue;
 
-        /* check if the commits have any conflicts. */
-        if (is_conflicting_commits(source_commit, destination_commit))
-            conflict_found = true;
+        /* if no path in this commit needs to be merged, reuse the commit. */
+        bool touched = false;
+        _foreach(commit->changes, const diff_t*, change)
+            if (hmap_has(plan->merges, change->new_path)) {
+                touched = true;
+                break;
+            }
+        _endforeach;
+        if (!touched) {
+            dyna_push(replayed, commit);
+            continue;
+        }
+
+        /* rewrite the commit, diffing each merged path against what has been replayed so far. */
+        if (plan->cache) pthread_mutex_lock(&plan->cache->lock);
+        commit_t* rebased = create_commit(commit->message, plan->destination->name);
+        if (plan->cache) pthread_mutex_unlock(&plan->cache->lock);
+        rebased->generation = branch_length(plan->destination) + replayed->length + 1;
+        rebased->has_rebased = true;
+        memcpy(rebased->rebased, commit->has_rebased ? commit->rebased : commit->hash, 20);
+        hmap_t* seen = hmap_create();
+        _foreach(commit->changes, diff_t*, change)
+            line_merge_t* state = hmap_get(plan->merges, change->new_path);
+            if (!state) {
+                dyna_push(rebased->changes, change);
+                continue;
+            }
+            if (hmap_has(seen, change->new_path))
+                continue;
+            hmap_put(seen, change->new_path, 0x0);
+
+            /* merge the version of the path after this commit onto the destination head. */
+            size_t nt = 0, nm = 0;
+            char** theirs = reconstruct_op(plan->source, k, change->new_path, &nt), **merged = 0x0;
+            dyna_t* hunks = dyna_create();
+            e_merge_result_t result = merge_lines(state->base, state->nb, state->ours, \
+                state->no, theirs, nt, &merged, &nm, hunks);
+            free_lines(theirs, nt);
+            if (result == E_MERGE_RESULT_CONFLICT) {
+                push_conflict(plan, hmap_get(plan->source_paths, change->new_path) ? \
+                    change->new_path : change->stored_path, hunks);
+                hmap_free(seen);
+                discard_replay(plan, rebased, rewritten, replayed);
+                return 0x0;
+            }
+            dyna_free(hunks);
+            dyna_push(rebased->changes, create_lines_modified_diff(change->new_path, \
+                change->new_path, state->current, state->nc, merged, nm));
+            if (state->current != state->ours) free_lines(state->current, state->nc);
+            state->current = merged;
+            state->nc = nm;
+        _endforeach;
+        hmap_free(seen);
+        dyna_push(replayed, rebased);
+        dyna_push(rewritten, rebased);
     }
-    return !conflict_found;
+
+    return replayed;
 }
 
 /**
@@ -127,38 +630,253 @@ branch_rebase(const repository_t* repository, const char* destination_branch_nam
     assert(destination_branch_name != 0x0);
     assert(destination_branch_name != 0x0);
 
-    /* check if the rebase is even possible first. */
-    if (!is_rebase_possible(repository, destination_branch_name, source_branch_name)) {
+    /* plan the rebase, and check that it is even possible first. */
+    rebase_plan_t* plan = plan_rebase(repository, destination_branch_name, source_branch_name);
+    dyna_t* rewritten = dyna_create();
+    dyna_t* replayed = plan && plan->conflicts->length == 0 ? replay_commits(plan, rewritten) : 0x0;
+    if (!replayed) {
+        if (plan) report_conflicts(plan);
         fprintf(stderr, "rebase is not possible on branch \'%s\', "
                         "conflicts or errors found (please fix), see above.\n", source_branch_name);
+        if (plan) free_rebase_plan(plan);
+        dyna_free(rewritten);
         return E_REBASE_RESULT_CONFLICT;
     }
 
-    /* find the source and destination branches. */
-    branch_t* destination = get_branch_repository(repository, destination_branch_name),\
-        *source = get_branch_repository(repository, source_branch_name);
-
-    /* find the common ancestor. */
-    commit_t* ancestor = find_common_ancestor(destination, source);
-    size_t source_ancestor_idx = find_index_commit(source, ancestor);
-    size_t rebase_count = source->head - source_ancestor_idx;
+    /* only write the rewritten commits once the whole replay has succeeded. */
+    _foreach(rewritten, const commit_t*, commit)
+        write_commit(commit);
+    _endforeach;
+    dyna_free(rewritten);
+    branch_t* destination = plan->destination;
+    size_t rebase_count = replayed->length;
+    free_rebase_plan(plan);
 
-    /* calculate the commit count to be added and then add them onto the dest. */
-    for (size_t i = source_ancestor_idx + 1; i < source->commits->length; i++) {
-        commit_t* commit = dyna_get(source->commits, i);
-        dyna_push(destination->commits, commit);
-    }
+    /* add all the replayed commits onto the dest. */
+    _foreach(replayed, commit_t*, commit)
+        branch_push(destination, commit);
+    _endforeach;
+    dyna_free(replayed);
 
-    /* checkout the most recent commits just added if it is the active branch. */
+    /* everything above was done in memory; if it is the active branch, materialize only the
+     *  final state of the working tree, in one coalesced transition (each path written once). */
     branch_t* head = dyna_get(repository->branches, repository->idx);
     if (!strcmp(destination->name, head->name))
-        checkout_op(destination, dyna_get(destination->commits, destination->head + rebase_count));
-    else destination->head += rebase_count;
+        transition_op(destination, destination->head, destination->head + rebase_count);
+    destination->head += rebase_count;
 
-    /* write and log. */
-    write_branch(destination);
+    /* append the replayed commits to the ref and log. */
+    append_branch(destination, rebase_count);
     write_repository(repository);
     printf("successfully rebased \'%s\' onto \'%s\' with %lu commit(s).\n", \
         source_branch_name, destination->name, rebase_count);
     return E_REBASE_RESULT_SUCCESS;
+}
+
+/**
+ * a data structure for a single branch of a batch rebase, filled in by a worker thread.
+ */
+typedef struct {
+    branch_t* branch; /* branch to be rebased onto the base. */
+    rebase_plan_t* plan; /* plan of the rebase (0x0 if there was no ancestor). */
+    dyna_t* replayed, *rewritten; /* commits appended onto the base, and the ones rewritten. */
+} rebase_job_t;
+
+/**
+ * a data structure shared by every worker thread of a batch rebase.
+ */
+typedef struct {
+    branch_t* onto; /* base branch that every job is rebased onto. */
+    dyna_t* jobs; /* array of rebase_job_t. */
+    size_t next; /* index of the next job to be taken (guarded by the cache lock). */
+    rebase_cache_t* cache; /* shared base-side data. */
+} rebase_batch_t;
+
+/**
+ * @brief worker thread of a batch rebase; plans and replays jobs until there are none left,
+ *  everything is done in memory (nothing is written until every job has finished).
+ *
+ * @param arg pointer to the rebase_batch_t.
+ * @return 0x0.
+ */
+internal void*
+rebase_worker(void* arg) {
+    rebase_batch_t* batch = arg;
+    for (;;) {
+        /* take the next job. */
+        pthread_mutex_lock(&batch->cache->lock);
+        rebase_job_t* job = dyna_get(batch->jobs, batch->next++);
+        pthread_mutex_unlock(&batch->cache->lock);
+        if (!job) break;
+
+        /* plan, and if there are no conflicts (and anything to do), replay. */
+        job->plan = plan_branches(batch->onto, job->branch, batch->cache);
+        if (!job->plan || job->plan->conflicts->length > 0 || \
+            job->plan->destination_idx == (long) branch_length(batch->onto) - 1)
+            continue;
+        job->rewritten = dyna_create();
+        job->replayed = replay_commits(job->plan, job->rewritten);
+    }
+    return 0x0;
+}
+
+/**
+ * @brief fork a rebased branch from the tip of the base, owning only its replayed commits, and
+ *  move the working tree in one coalesced transition if it is the active branch.
+ *
+ * @param repository the repository read from the cwd.
+ * @param job the finished job.
+ * @param onto the base branch.
+ * @param active whether the branch is the active branch.
+ */
+internal void
+apply_rebase_job(const repository_t* repository, rebase_job_t* job, branch_t* onto, bool active) {
+    branch_t* branch = job->branch;
+    rebase_plan_t* plan = job->plan;
+
+    /* branches forked from this one keep the history they inherited from it. */
+    _foreach(repository->branches, branch_t*, child)
+        if (child->base == branch) {
+            reparent_branch(child);
+            write_branch(child);
+        }
+    _endforeach;
+
+    /* back to the ancestor on the old history... */
+    transition_t* transition = active ? create_transition() : 0x0;
+    if (active && branch->head <= (size_t) plan->source_idx)
+        for (size_t i = branch->head + 1; i <= (size_t) plan->source_idx; i++)
+            forward_transition(transition, branch_commit(branch, i));
+    else if (active)
+        for (size_t i = branch->head; i > (size_t) plan->source_idx; i--)
+            reverse_transition(transition, branch_commit(branch, i));
+
+    /* the tip of the base is now the fork point of the branch. */
+    dyna_free(branch->commits);
+    branch->commits = dyna_create();
+    _foreach(job->replayed, commit_t*, commit)
+        branch_push(branch, commit);
+    _endforeach;
+    free(branch->parent);
+    branch->parent = strdup(onto->name);
+    branch->base = onto;
+    branch->fork = branch_length(onto);
+    branch->head = branch_length(branch) - 1;
+
+    /* ...then forward to the tip of the new one. */
+    if (active) {
+        for (size_t i = (size_t) plan->destination_idx + 1; i < branch_length(branch); i++)
+            forward_transition(transition, branch_commit(branch, i));
+        apply_transition(transition);
+    }
+}
+
+/**
+ * @brief rebase many branches onto the same base; the repository is loaded once, the base-side
+ *  path sets and reconstructed versions are shared between every branch, independent branches
+ *  are planned and replayed in parallel, and the refs are only written once all are done.
+ *
+ * @param repository the repository read from the cwd.
+ * @param onto_branch_name the base branch to rebase every branch onto.
+ * @param branch_names array of branch names to be rebased (every other branch if empty).
+ * @return rebase result status enum (conflict if any branch could not be rebased).
+ */
+e_rebase_result_t
+branch_rebase_all(const repository_t* repository, const char* onto_branch_name, \
+    const dyna_t* branch_names) {
+    /* assert on the repository, base name and branch names. */
+    assert(repository != 0x0);
+    assert(onto_branch_name != 0x0);
+    assert(branch_names != 0x0);
+
+    /* create a job for each branch. */
+    branch_t* onto = get_branch_repository(repository, onto_branch_name);
+    dyna_t* jobs = dyna_create();
+    _foreach(repository->branches, branch_t*, branch)
+        bool selected = branch_names->length == 0 && branch != onto;
+        for (size_t j = 0; j < branch_names->length; j++)
+            if (!strcmp(branch_names->data[j], branch->name))
+                selected = true;
+        if (!selected) continue;
+        if (branch == onto) {
+            llog(E_LOGGER_LEVEL_ERROR, "cannot rebase \'%s\' onto itself.\n", onto->name);
+            exit(EXIT_FAILURE);
+        }
+        rebase_job_t* job = calloc(1, sizeof *job);
+        job->branch = branch;
+        dyna_push(jobs, job);
+    _endforeach;
+    for (size_t j = 0; j < branch_names->length; j++)
+        get_branch_repository(repository, branch_names->data[j]); /* exits if it does not exist. */
+
+    /* plan and replay in parallel, one worker per core at most. */
+    rebase_cache_t cache = { .paths = hmap_create(), .lines = hmap_create() };
+    pthread_mutex_init(&cache.lock, 0x0);
+    rebase_batch_t batch = { .onto = onto, .jobs = jobs, .next = 0, .cache = &cache };
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n_threads = cores < 1 ? 1 : (size_t) cores;
+    if (n_threads > jobs->length) n_threads = jobs->length;
+    pthread_t* threads = calloc(n_threads + 1, sizeof *threads);
+    for (size_t t = 0; t < n_threads; t++)
+        if (pthread_create(&threads[t], 0x0, rebase_worker, &batch) != 0) {
+            llog(E_LOGGER_LEVEL_ERROR, "pthread_create failed; could not start rebase worker.\n");
+            exit(EXIT_FAILURE);
+        }
+    for (size_t t = 0; t < n_threads; t++)
+        pthread_join(threads[t], 0x0);
+    free(threads);
+
+    /* write every rewritten commit first, then apply and report each branch in order. */
+    e_rebase_result_t result = E_REBASE_RESULT_SUCCESS;
+    _foreach(jobs, rebase_job_t*, job)
+        if (!job->replayed) continue;
+        _foreach_it(job->rewritten, const commit_t*, commit, j)
+            write_commit(commit);
+        _endforeach;
+    _endforeach;
+    branch_t* active = dyna_get(repository->branches, repository->idx);
+    _foreach(jobs, rebase_job_t*, job)
+        if (!job->plan) {
+            result = E_REBASE_RESULT_CONFLICT;
+        }
+        else if (!job->replayed && job->plan->conflicts->length == 0) {
+            printf("\'%s\' is already up to date with \'%s\'.\n", job->branch->name, onto->name);
+        }
+        else if (!job->replayed) {
+            report_conflicts(job->plan);
+            fprintf(stderr, "rebase is not possible on branch \'%s\', "
+                            "conflicts or errors found (please fix), see above.\n", \
+                            job->branch->name);
+            result = E_REBASE_RESULT_CONFLICT;
+        }
+        else {
+            apply_rebase_job(repository, job, onto, job->branch == active);
+            printf("successfully rebased \'%s\' onto \'%s\' with %lu commit(s).\n", \
+                job->branch->name, onto->name, job->replayed->length);
+        }
+    _endforeach;
+
+    /* the refs are only written once every branch has been applied. */
+    _foreach(jobs, rebase_job_t*, job)
+        if (job->replayed) write_branch(job->branch);
+        if (job->plan) free_rebase_plan(job->plan);
+        if (job->replayed) dyna_free(job->replayed);
+        if (job->rewritten) dyna_free(job->rewritten);
+        free(job);
+    _endforeach;
+    dyna_free(jobs);
+
+    /* free the shared cache. */
+    _hmap_foreach(cache.paths, entry)
+        hmap_free(entry->value);
+    _endforeach;
+    _hmap_foreach(cache.lines, entry)
+        reconstructed_t* version = entry->value;
+        free_lines(version->lines, version->n);
+        free(version);
+    _endforeach;
+    hmap_free(cache.paths);
+    hmap_free(cache.lines);
+    pthread_mutex_destroy(&cache.lock);
+    return result;
 }
\ No newline at end of file
@@ -29,4 +29,18 @@ typedef enum {
 e_rebase_result_t
 branch_rebase(const repository_t* repository, const char* destination_branch_name, \
     const char* source_branch_name);
+
+/**
+ * @brief rebase many branches onto the same base; the repository is loaded once, the base-side
+ *  path sets and reconstructed versions are shared between every branch, independent branches
+ *  are planned and replayed in parallel, and the refs are only written once all are done.
+ *
+ * @param repository the repository read from the cwd.
+ * @param onto_branch_name the base branch to rebase every branch onto.
+ * @param branch_names array of branch names to be rebased (every other branch if empty).
+ * @return rebase result status enum (conflict if any branch could not be rebased).
+ */
+e_rebase_result_t
+branch_rebase_all(const repository_t* repository, const char* onto_branch_name, \
+    const dyna_t* branch_names);
 #endif /* REBASE_H */
\ No newline at end of file
@@ -10,7 +10,7 @@
 /*! @uses mkdir, getcwd. */
 #include <sys/stat.h>
 
-/*! @uses printf, fprintf, perror, fopen, fclose, fscanf. */
+/*! @uses printf, fprintf, perror, fopen, fclose, fscanf, rename. */
 #include <stdio.h>
 
 /*! @uses strcpy, strncpy. */
@@ -19,10 +19,10 @@
 /*! @uses malloc, free. */
 #include <stdlib.h>
 
-/*! @uses getcwd, chdir */
+/*! @uses getcwd, chdir, access. */
 #include <unistd.h>
 
-/*! @uses apply_inverse_commit, apply_forward_commit */
+/*! @uses create_transition, forward_transition, reverse_transition, apply_transition. */
 #include "ops.h"
 
 /*! @uses MKDIR_MOWNER. */
@@ -31,8 +31,50 @@
 /*! @uses llog, E_LOGGER_LEVEL_ERROR. */
 #include "log.h"
 
+/*! @uses read_common_dir. */
+#include "worktree.h"
+
+/*! @uses lock_upstream. */
+#include "upstream.h"
+
 /**
- * @brief find a common commit ancestor using hashes and timestamps by going backwards.
+ * @brief check if the commit at <idx> is the same on both branches.
+ *
+ * @param branch1 the first branch.
+ * @param branch2 the second branch.
+ * @param idx the index of the commit on both branches.
+ * @return true if both branches have the same commit at <idx>.
+ */
+internal bool
+is_shared_commit(const branch_t* branch1, const branch_t* branch2, size_t idx) {
+    const commit_t* c1 = branch_commit(branch1, idx), *c2 = branch_commit(branch2, idx);
+    return c1 && c2 && memcmp(c1->hash, c2->hash, 20) == 0;
+}
+
+/**
+ * @brief find how many commits of <ancestor> are in the history of <branch>, if <ancestor> is
+ *  <branch> itself or a branch it was (transitively) forked from.
+ *
+ * @param branch the branch.
+ * @param ancestor the (possible) ancestor branch.
+ * @return the number of commits of <ancestor> in the history, or -1 if it is not an ancestor.
+ */
+internal long
+shared_length(const branch_t* branch, const branch_t* ancestor) {
+    /* each fork point along the way can only shorten what is shared. */
+    size_t length = branch_length(branch);
+    for (; branch; branch = branch->base) {
+        if (branch == ancestor)
+            return (long) length;
+        if (branch->fork < length)
+            length = branch->fork;
+    }
+    return -1;
+}
+
+/**
+ * @brief find a common commit ancestor using the fork points of both branches, and otherwise the
+ *  longest common prefix of both branches.
  *
  * @param branch1 the first branch.
  * @param branch2 the second branch.
@@ -43,28 +85,31 @@ find_common_ancestor(branch_t* branch1, branch_t* branch2) {
     /* is there any issues with the commits provided? */
     assert(branch1 != 0x0);
     assert(branch2 != 0x0);
-    if (branch1->commits->length == 0 || branch2->commits->length == 0)
+    if (branch_length(branch1) == 0 || branch_length(branch2) == 0)
         return 0x0;
 
-    /* start from the most recent comits and work backwards */
-    long i = (long) branch1->commits->length - 1;
-    long j = (long) branch2->commits->length - 1;
-    commit_t* ancestor = 0x0;
-
-    /* work backwards through both branches simultaneously */
-    while (i >= 0 && j >= 0) {
-        commit_t* c1 = dyna_get(branch1->commits, i), *c2 = dyna_get(branch2->commits, j);
+    /* the closest branch both were forked from (or one of them), the ancestor is the last
+     *  commit of it that both histories still share; this only walks the fork points. */
+    for (const branch_t* branch = branch1; branch; branch = branch->base) {
+        long length2 = shared_length(branch2, branch);
+        if (length2 < 0) continue;
+        long length1 = shared_length(branch1, branch);
+        long shared = length1 < length2 ? length1 : length2;
+        return shared > 0 ? branch_commit(branch, (size_t) shared - 1) : 0x0;
+    }
 
-        /* if hashes match, this a common commit. */
-        if (memcmp(c1->hash, c2->hash, 32) == 0) {
-            ancestor = c1;
-            break;
-        }
-        /* move the pointer with the more recent timestamp backwards. */
-        if (c1->timestamp > c2->timestamp) i--;
-        else j--;
+    /* otherwise both branches share a prefix of commits (copied before fork points were
+     *  tracked), so binary search for the last index where both branches agree. */
+    if (!is_shared_commit(branch1, branch2, 0))
+        return 0x0;
+    size_t low = 0, high = branch_length(branch1) < branch_length(branch2) ? \
+        branch_length(branch1) - 1 : branch_length(branch2) - 1;
+    while (low < high) {
+        size_t mid = low + (high - low + 1) / 2;
+        if (is_shared_commit(branch1, branch2, mid)) low = mid;
+        else high = mid - 1;
     }
-    return ancestor;
+    return branch_commit(branch1, low);
 }
 
 /**
@@ -79,8 +124,14 @@ find_index_commit(branch_t* branch, commit_t* commit) {
     /* assert the branch and the commit. */
     assert(branch);
     assert(commit);
-    _foreach_it(branch->commits, const commit_t*, _commit, i)
-        if (memcmp(_commit->hash, commit->hash, 32) == 0) {
+
+    /* the generation of a commit is usually its position, check there first. */
+    const commit_t* guess = commit->generation > 0 ? \
+        branch_commit(branch, commit->generation - 1) : 0x0;
+    if (guess && memcmp(guess->hash, commit->hash, 20) == 0)
+        return (long) commit->generation - 1;
+    _branch_foreach_it(branch, const commit_t*, _commit, i)
+        if (memcmp(_commit->hash, commit->hash, 20) == 0) {
             return (long) i;
         }
     _endforeach;
@@ -134,6 +185,23 @@ create_repository() {
     return repo;
 }
 
+/**
+ * @brief write the names of the branches of an index, and then the names added elsewhere.
+ *
+ * @param f the index file.
+ * @param repo the repository being written.
+ * @param added the names of the branches another worktree added meanwhile.
+ */
+internal void
+write_index_names(FILE* f, const repository_t* repo, dyna_t* added) {
+    _foreach_it(repo->branches, const branch_t*, branch, i)
+        fprintf(f, "%lu:%s\n", i, branch->name);
+    _endforeach;
+    _foreach_it(added, const char*, name, j)
+        fprintf(f, "%lu:%s\n", repo->branches->length + j, name);
+    _endforeach;
+}
+
 /**
  * @brief write the repository to disk in our '.lit' directory.
  *
@@ -144,8 +212,29 @@ write_repository(const repository_t* repo) {
     /* assert the repository. */
     assert(repo != 0x0);
 
-    /* open the file '.lit/repository' for writing. */
-    FILE* f = fopen(".lit/index", "w");
+    /* a repository with worktrees shares its index with every one of them; the writes are
+     *  serialized (with pushes and pulls), and the branches another worktree added since this one
+     *  read the index are kept (their refs exist, unlike those of branches deleted here). */
+    char* common = read_common_dir();
+    dyna_t* added = dyna_create();
+    if (common || access(".lit/" WORKTREE_REGISTRY, F_OK) == 0) {
+        lock_upstream(true);
+        dyna_t* names = read_branch_names();
+        _foreach(names, char*, name)
+            bool known = false;
+            _foreach_it(repo->branches, const branch_t*, branch, j)
+                if (!strcmp(branch->name, name)) known = true;
+            _endforeach;
+            char path[256];
+            snprintf(path, 256, ".lit/refs/heads/%s", name);
+            if (!known && access(path, F_OK) == 0) dyna_push(added, name);
+            else free(name);
+        _endforeach;
+        dyna_free(names);
+    }
+
+    /* open the file '.lit/repository' for writing (aside, it is read without the lock). */
+    FILE* f = fopen(".lit/index.tmp", "w");
     if (!f) {
         llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open index file for writing.\n");
         exit(EXIT_FAILURE);
@@ -153,12 +242,45 @@ write_repository(const repository_t* repo) {
 
     /* write the main branch information. */
     fprintf(f, "active:%lu\n", repo->idx);
-    fprintf(f, "count:%lu\n", repo->branches->length);
+    fprintf(f, "count:%lu\n", repo->branches->length + added->length);
     fprintf(f, "readonly:%d\n", repo->readonly ? 1 : 0);
-    _foreach_it(repo->branches, const branch_t*, branch, i)
-        fprintf(f, "%lu:%s\n", i, branch->name);
-    _endforeach;
+    write_index_names(f, repo, added);
     fclose(f);
+    rename(".lit/index.tmp", ".lit/index");
+
+    /* then the index of the repository, which keeps its own active branch (by name, the branches
+     *  may have moved). */
+    if (common) {
+        char path[512];
+        snprintf(path, 512, "%s/index", common);
+        bool readonly = false;
+        char* active = read_active_branch_name_at(path, &readonly);
+        size_t idx = 0;
+        _foreach_it(repo->branches, const branch_t*, branch, i)
+            if (!strcmp(branch->name, active)) idx = i;
+        _endforeach;
+        _foreach_it(added, const char*, name, j)
+            if (!strcmp(name, active)) idx = repo->branches->length + j;
+        _endforeach;
+        free(active);
+        char temporary[520];
+        snprintf(temporary, 520, "%s.tmp", path);
+        f = fopen(temporary, "w");
+        if (!f) {
+            llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open index file for writing.\n");
+            exit(EXIT_FAILURE);
+        }
+        fprintf(f, "active:%lu\ncount:%lu\nreadonly:%d\n", idx, repo->branches->length + \
+            added->length, readonly ? 1 : 0);
+        write_index_names(f, repo, added);
+        fclose(f);
+        rename(temporary, path);
+        free(common);
+    }
+    _foreach(added, char*, name)
+        free(name);
+    _endforeach;
+    dyna_free(added);
 }
 
 /**
@@ -180,8 +302,10 @@ read_repository() {
 
     /* read the current branch index. */
     size_t length = 0;
-    int scanned = fscanf(f, "active:%lu\ncount:%lu\nreadonly:%b", &repo->idx, \
-        &length, &repo->readonly);
+    int readonly = 0;
+    int scanned = fscanf(f, "active:%lu\ncount:%lu\nreadonly:%d\n", &repo->idx, \
+        &length, &readonly);
+    repo->readonly = readonly != 0;
     if (scanned != 3) {
         llog(E_LOGGER_LEVEL_ERROR,"fscanf failed; could not read current branch header.\n");
         fclose(f);
@@ -195,6 +319,26 @@ read_repository() {
         return repo;
     }
 
+    /* a worktree reads its branches from the index of the repository, and finds its active
+     *  branch among them by name. */
+    char* common = read_common_dir(), *active = 0x0;
+    if (common) {
+        bool _readonly = false;
+        active = read_active_branch_name_at(".lit/index", &_readonly);
+        char path[512];
+        snprintf(path, 512, "%s/index", common);
+        free(common);
+        fclose(f);
+        f = fopen(path, "r");
+        size_t _idx = 0;
+        int _shared_readonly = 0;
+        if (!f || fscanf(f, "active:%lu\ncount:%lu\nreadonly:%d\n", &_idx, &length, \
+            &_shared_readonly) != 3) {
+            llog(E_LOGGER_LEVEL_ERROR,"fscanf failed; could not read the index of the repository.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
     /* create the dynamic array. */
     repo->branches = dyna_create();
 
@@ -214,12 +358,172 @@ read_repository() {
         char *path = calloc(1, 257);
         snprintf(path, 256, ".lit/refs/heads/%s", branch_name);
         dyna_push(repo->branches, read_branch(branch_name));
+        if (active && !strcmp(active, branch_name))
+            repo->idx = repo->branches->length - 1;
         free(path);
         free(branch_name);
     };
+    fclose(f);
+    free(active);
+
+    /* resolve the parent of every branch, now that all of them have been read. */
+    _foreach(repo->branches, branch_t*, branch)
+        if (!branch->parent) continue;
+        _foreach_it(repo->branches, branch_t*, parent, j)
+            if (!strcmp(parent->name, branch->parent))
+                branch->base = parent;
+        _endforeach;
+        if (!branch->base) {
+            llog(E_LOGGER_LEVEL_ERROR, "parent branch \'%s\' of \'%s\' not found.\n", \
+                branch->parent, branch->name);
+            exit(EXIT_FAILURE);
+        }
+    _endforeach;
+
+    /* branches written before they were copy-on-write stored their inherited commits as well,
+     *  drop those (the fork point is the same commit on both) so they are read through the
+     *  parent; the ref is rewritten the next time the branch is written. */
+    _foreach(repo->branches, branch_t*, branch)
+        const commit_t* owned = dyna_get(branch->commits, branch->fork - 1), \
+            *inherited = branch->fork > 0 ? branch_commit(branch->base, branch->fork - 1) : 0x0;
+        if (!inherited || !owned || memcmp(owned->hash, inherited->hash, 20) != 0)
+            continue;
+        dyna_t* commits = dyna_create();
+        for (size_t j = branch->fork; j < branch->commits->length; j++)
+            dyna_push(commits, dyna_get(branch->commits, j));
+        dyna_free(branch->commits);
+        branch->commits = commits;
+    _endforeach;
     return repo;
 }
 
+/**
+ * @brief read only the names of the branches from the index of the repository in our cwd (none
+ *  of the branches are read); a worktree reads those of the repository it belongs to.
+ *
+ * @return a dynamic array of the allocated branch names, in the order of the index.
+ */
+dyna_t*
+read_branch_names() {
+    /* a worktree shares the index of the repository. */
+    char path[512] = ".lit/index", *common = read_common_dir();
+    if (common) {
+        snprintf(path, 512, "%s/index", common);
+        free(common);
+    }
+    FILE* f = fopen(path, "r");
+    size_t idx = 0, length = 0;
+    int readonly = 0;
+    if (!f || fscanf(f, "active:%lu\ncount:%lu\nreadonly:%d\n", &idx, &length, &readonly) != 3) {
+        llog(E_LOGGER_LEVEL_ERROR,"fscanf failed; could not read the index of the repository.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* then every name. */
+    dyna_t* names = dyna_create();
+    for (size_t i = 0; i < length; i++) {
+        char* name = calloc(1, 129);
+        size_t j = 0;
+        if (fscanf(f, "%lu:%128[^\n]\n", &j, name) != 2) {
+            free(name);
+            break;
+        }
+        dyna_push(names, name);
+    }
+    fclose(f);
+    return names;
+}
+
+/**
+ * @brief read only the name of the active branch from an index (none of the branches are read).
+ *
+ * @param path the path of the index.
+ * @param readonly pointer to store if the repository is in read-only mode.
+ * @return the allocated name of the active branch.
+ */
+char*
+read_active_branch_name_at(const char* path, bool* readonly) {
+    /* assert on the path and the readonly ptr. */
+    assert(path != 0x0);
+    assert(readonly != 0x0);
+
+    /* open the index for reading. */
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR,"fopen failed; could not open repository file for reading.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* read the current branch index. */
+    size_t idx = 0, length = 0;
+    int _readonly = 0;
+    if (fscanf(f, "active:%lu\ncount:%lu\nreadonly:%d\n", &idx, &length, &_readonly) != 3) {
+        llog(E_LOGGER_LEVEL_ERROR,"fscanf failed; could not read current branch header.\n");
+        fclose(f);
+        exit(EXIT_FAILURE);
+    }
+    *readonly = _readonly != 0;
+
+    /* scan the branch names up to the active one. */
+    char* branch_name = calloc(1, 129);
+    for (size_t i = 0; i < length; i++) {
+        size_t j = 0;
+        if (fscanf(f, "%lu:%128[^\n]\n", &j, branch_name) != 2) break;
+        if (j == idx) {
+            fclose(f);
+            return branch_name;
+        }
+    }
+    llog(E_LOGGER_LEVEL_ERROR,"fscanf failed; could not find the active branch.\n");
+    fclose(f);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief read only the name of the active branch from the index of the repository in our cwd
+ *  (none of the branches are read).
+ *
+ * @param readonly pointer to store if the repository is in read-only mode.
+ * @return the allocated name of the active branch.
+ */
+char*
+read_active_branch_name(bool* readonly) {
+    return read_active_branch_name_at(".lit/index", readonly);
+}
+
+/**
+ * @brief add a branch whose ref has just been written to the index of the repository in our cwd
+ *  (none of the branches are read).
+ *
+ * @param name the name of the branch.
+ */
+void
+index_branch_name(const char* name) {
+    /* assert on the name. */
+    assert(name != 0x0);
+
+    /* the index is written from the names alone, the active branch is kept by its name. */
+    bool readonly = false;
+    char* active = read_active_branch_name(&readonly);
+    dyna_t* names = read_branch_names();
+    dyna_push(names, strdup(name));
+    repository_t repo = { .readonly = readonly, .branches = dyna_create() };
+    _foreach_it(names, char*, _name, i)
+        branch_t* branch = calloc(1, sizeof *branch);
+        branch->name = _name;
+        if (!strcmp(_name, active)) repo.idx = i;
+        dyna_push(repo.branches, branch);
+    _endforeach;
+    write_repository(&repo);
+    _foreach(repo.branches, branch_t*, branch)
+        free(branch->name);
+        free(branch);
+    _endforeach;
+    dyna_free(repo.branches);
+    dyna_free(names);
+    free(active);
+}
+
 /**
  * @brief create a new branch from the current branches HEAD commit.
  *
@@ -267,21 +571,15 @@ create_branch_repository(repository_t* repository, const char* name, const char*
         exit(EXIT_FAILURE);
     }
 
-    /* copy all the commits over to the new branch. */
-    _foreach(from_branch->commits, commit_t*, commit)
-        commit_t* _commit = calloc(1, sizeof *_commit);
-        memcpy(_commit, commit, sizeof *_commit);
-
-        /* keep the sha1 hash on the commit, if we delete a branch
-         *  and the changes aren't kept then we simply just removed
-         *  them as they are just 'cache'. */
-        dyna_push(branch->commits, commit);
-    _endforeach;
+    /* fork from the branch, the commits are inherited (read through the parent) not copied. */
+    branch->parent = strdup(from_branch->name);
+    branch->base = from_branch;
+    branch->fork = branch_length(from_branch);
     branch->head = from_branch->head;
 
-    /* write out the branch and repository. */
-    write_repository(repository);
+    /* write out the branch and then the repository (the index never names a missing ref). */
     write_branch(branch);
+    write_repository(repository);
 }
 
 /**
@@ -315,6 +613,15 @@ delete_branch_repository(repository_t* repository, const char* name) {
         exit(EXIT_FAILURE);
     }
 
+    /* any branch forked from this one takes ownership of the commits it inherited from it. */
+    branch_t* deleted = dyna_get(repository->branches, i);
+    _foreach_it(repository->branches, branch_t*, branch, j)
+        if (branch->base == deleted) {
+            reparent_branch(branch);
+            write_branch(branch);
+        }
+    _endforeach;
+
     /* remove the branch directory. */
     char path[256];
     snprintf(path, 256, ".lit/refs/heads/%s", name);
@@ -391,22 +698,18 @@ switch_branch_repository(repository_t* repository, const char* name) {
      *  heading with this commit. */
     branch_t* current = dyna_get(repository->branches, repository->idx);
     commit_t* ancestor = find_common_ancestor(current , target);
+    transition_t* transition = create_transition();
     if (!ancestor) {
         /* this should NOT happen, warn the user. */
         printf("warning; no ancestor commit was found (branch is unrelated).\n");
-        if (current->commits->length > 0) {
-            /* rollback to the first commit. */
-            rollback_op(current, dyna_get(current->commits, 0));
-            if (current->commits->length > 0)
-                reverse_commit_op(dyna_get(current->commits, 0));
-        }
 
-        /* checkout target branch to its head. */
-        if (target->commits->length > 0) {
-            /* start from clean slate and apply all commits. */
-            for (size_t i = 0; i <= target->head && i < target->commits->length; i++)
-                forward_commit_op(dyna_get(target->commits, i));
-        }
+        /* undo every commit on the current branch up to the head (including the first)... */
+        for (size_t i = current->head + 1; i-- > 0 && branch_length(current) > 0;)
+            reverse_transition(transition, branch_commit(current, i));
+
+        /* then apply all commits on the target branch up to its head, from a clean slate. */
+        for (size_t i = 0; i <= target->head && i < branch_length(target); i++)
+            forward_transition(transition, branch_commit(target, i));
     }
     else {
         /* do a switch, rollback to the ancestor, and then checkout the target commit. */
@@ -416,18 +719,21 @@ switch_branch_repository(repository_t* repository, const char* name) {
         long ancestor_idx = find_index_commit(current, ancestor);
         if (ancestor_idx >= 0 && ancestor_idx < (long) current->head)
             for (size_t i = current->head; i > (size_t)ancestor_idx; i--)
-                reverse_commit_op(dyna_get(current->commits, i));
+                reverse_transition(transition, branch_commit(current, i));
 
         /* checkout to the ancestor commit, then to the target head. */
         long head_idx = find_index_commit(target, ancestor);
         if (head_idx >= 0) {
             /* apply forward commits from the ancestor to the head. */
             for (long i = head_idx + 1; i <= (long) target->head && i < (long)
-                target->commits->length; i++)
-                forward_commit_op(dyna_get(target->commits, i));
+                branch_length(target); i++)
+                forward_transition(transition, branch_commit(target, i));
         }
     }
 
+    /* both halves were only planned, so each path is written (or removed) once. */
+    apply_transition(transition);
+
     /* update the repository. */
     repository->idx = target_idx;
     write_repository(repository);
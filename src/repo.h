@@ -47,6 +47,44 @@ write_repository(const repository_t* repo);
 repository_t*
 read_repository();
 
+/**
+ * @brief read only the name of the active branch from the index of the repository in our cwd
+ *  (none of the branches are read).
+ *
+ * @param readonly pointer to store if the repository is in read-only mode.
+ * @return the allocated name of the active branch.
+ */
+char*
+read_active_branch_name(bool* readonly);
+
+/**
+ * @brief read only the names of the branches from the index of the repository in our cwd (none
+ *  of the branches are read); a worktree reads those of the repository it belongs to.
+ *
+ * @return a dynamic array of the allocated branch names, in the order of the index.
+ */
+dyna_t*
+read_branch_names();
+
+/**
+ * @brief read only the name of the active branch from an index (none of the branches are read).
+ *
+ * @param path the path of the index.
+ * @param readonly pointer to store if the repository is in read-only mode.
+ * @return the allocated name of the active branch.
+ */
+char*
+read_active_branch_name_at(const char* path, bool* readonly);
+
+/**
+ * @brief add a branch whose ref has just been written to the index of the repository in our cwd
+ *  (none of the branches are read).
+ *
+ * @param name the name of the branch.
+ */
+void
+index_branch_name(const char* name);
+
 /**
  * @brief create a new branch from the current branches HEAD commit.
  *
@@ -86,7 +124,8 @@ void
 switch_branch_repository(repository_t* repository, const char* name);
 
 /**
- * @brief find a common commit ancestor using hashes and timestamps by going backwards.
+ * @brief find a common commit ancestor using the fork points of both branches, and otherwise the
+ *  longest common prefix of both branches.
  *
  * @param branch1 the first branch.
  * @param branch2 the second branch.
@@ -0,0 +1,280 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-21
+ */
+/*!~ @note fork, sigaction, realpath and clock_gettime are posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
+#include "server.h"
+
+/*! @uses fdopen, fgets, fprintf, snprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, free, realpath. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strstr, strcspn, memset. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses errno, EINTR, ECHILD. */
+#include <errno.h>
+
+/*! @uses sigaction, SIGINT, SIGTERM, sig_atomic_t. */
+#include <signal.h>
+
+/*! @uses clock_gettime, CLOCK_MONOTONIC. */
+#include <time.h>
+
+/*! @uses pthread_mutex_t, PTHREAD_PROCESS_SHARED. */
+#include <pthread.h>
+
+/*! @uses stat, S_ISSOCK. */
+#include <sys/stat.h>
+
+/*! @uses socket, bind, listen, accept. */
+#include <sys/socket.h>
+
+/*! @uses sockaddr_un. */
+#include <sys/un.h>
+
+/*! @uses mmap, MAP_SHARED, MAP_ANONYMOUS. */
+#include <sys/mman.h>
+
+/*! @uses waitpid, WNOHANG. */
+#include <sys/wait.h>
+
+/*! @uses fork, close, dup, chdir, unlink, _exit. */
+#include <unistd.h>
+
+/*! @uses serve_upstream, request_t. */
+#include "upstream.h"
+
+/*! @uses shcache_create, shcache_read_stats. */
+#include "shcache.h"
+
+/*! @uses internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_INFO, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * a data structure for the latency of one kind of request served.
+ */
+typedef struct {
+    size_t count, failed; /* requests served, and how many of them failed. */
+    double total, max; /* total and maximum latency in milliseconds. */
+} latency_t;
+
+/**
+ * a data structure for the metrics of a server, shared by the process of every request.
+ */
+typedef struct {
+    pthread_mutex_t lock; /* process shared lock on the metrics. */
+    latency_t upload, receive, other; /* latency of each kind of request. */
+} metrics_t;
+
+/* the metrics of the server, and if it was interrupted. */
+internal metrics_t* metrics = 0x0;
+internal volatile sig_atomic_t stopping = 0;
+
+/**
+ * @brief stop accepting connections once interrupted.
+ *
+ * @param signal the signal received.
+ */
+internal void
+stop_server(int signal) {
+    (void) signal;
+    stopping = 1;
+}
+
+/**
+ * @brief get the milliseconds elapsed since a point in time.
+ *
+ * @param start the point in time (monotonic).
+ * @return the milliseconds elapsed.
+ */
+internal double
+elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) * 1e3 + \
+        (double) (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+/**
+ * @brief record the latency of a request in the shared metrics.
+ *
+ * @param request the request served ('upload' or 'receive', anything else if it was malformed).
+ * @param served if the request was served successfully.
+ * @param ms the latency of the request in milliseconds.
+ */
+internal void
+record_latency(const char* request, bool served, double ms) {
+    pthread_mutex_lock(&metrics->lock);
+    latency_t* latency = !strcmp(request, "upload") ? &metrics->upload : \
+        !strcmp(request, "receive") ? &metrics->receive : &metrics->other;
+    latency->count++;
+    latency->failed += served ? 0 : 1;
+    latency->total += ms;
+    if (ms > latency->max) latency->max = ms;
+    pthread_mutex_unlock(&metrics->lock);
+}
+
+/**
+ * @brief serve a single connection (in its own process); the repository it names, then its
+ *  request.
+ *
+ * @param fd the descriptor of the connection.
+ * @param root the absolute path of the directory holding the repositories.
+ * @param start when the connection was accepted.
+ * @return true if the request was served successfully.
+ */
+internal bool
+serve_connection(int fd, const char* root, const struct timespec* start) {
+    FILE* in = fdopen(fd, "r"), *out = fdopen(dup(fd), "w");
+    if (!in || !out) {
+        llog(E_LOGGER_LEVEL_ERROR, "fdopen failed; could not open the connection streams.\n");
+        return false;
+    }
+
+    /* the repository has to be under the root, and has to exist. */
+    char line[512] = {0}, name[257] = {0}, path[1024];
+    bool found = fgets(line, sizeof line, in) && sscanf(line, "repository %256[^\n]", name) == 1 \
+        && name[0] != '/' && !strstr(name, "..");
+    snprintf(path, 1024, "%s/%s", root, name);
+    found = found && chdir(path) == 0 && access(".lit/index", F_OK) == 0;
+    request_t request = {0};
+    bool served = false;
+    if (!found) {
+        fprintf(out, "reject no repository \'%s\' is hosted here.\n", name);
+        fflush(out);
+    }
+    else
+        served = serve_upstream(in, out, true, &request);
+    fclose(out);
+    fclose(in);
+
+    /* one line per request, and the totals for the summary. */
+    double ms = elapsed_ms(start);
+    record_latency(request.request, served, ms);
+    if (!found)
+        llog(E_LOGGER_LEVEL_INFO, "unknown repository \'%s\' in %.2f ms (failed).\n", name, ms);
+    else
+        llog(E_LOGGER_LEVEL_INFO, "%s \'%s\' of \'%s\'; %lu commit(s) in %.2f ms%s.\n", \
+            request.request, request.branch, name, request.commits, ms, served ? "" : " (failed)");
+    return served;
+}
+
+/**
+ * @brief log the summary of one kind of request.
+ *
+ * @param kind the kind of request.
+ * @param latency the latency of the requests.
+ */
+internal void
+log_latency(const char* kind, const latency_t* latency) {
+    if (latency->count == 0)
+        return;
+    llog(E_LOGGER_LEVEL_INFO, "\t%-8s %lu request(s), %lu failed, %.2f ms mean, %.2f ms max.\n", \
+        kind, latency->count, latency->failed, latency->total / (double) latency->count, \
+        latency->max);
+}
+
+/**
+ * @brief host every repository under a root directory on a unix socket, until interrupted; each
+ *  connection names its repository ('<socket>:<repository>' on the client) and is served in its
+ *  own process, under a shared lock on the repository while sending and an exclusive one while
+ *  receiving. sent objects are kept in a cache shared by every process, and the latency of each
+ *  request is logged (and summarized when the server stops).
+ *
+ * @param root the directory holding the repositories.
+ * @param socket_path the path of the unix socket to listen on.
+ * @param cache_size the memory cap of the shared object cache in bytes.
+ * @return 0 once the server was stopped, -1 if it could not be started.
+ */
+int
+run_server(const char* root, const char* socket_path, size_t cache_size) {
+    /* assert on the root and the socket. */
+    assert(root != 0x0);
+    assert(socket_path != 0x0);
+    char* absolute = realpath(root, 0x0);
+    if (!absolute) {
+        llog(E_LOGGER_LEVEL_ERROR, "\'%s\' does not exist.\n", root);
+        return -1;
+    }
+
+    /* the cache and the metrics are mapped before any request is forked, so all of them share. */
+    metrics = mmap(0x0, sizeof *metrics, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (metrics == MAP_FAILED || !shcache_create(cache_size)) {
+        llog(E_LOGGER_LEVEL_ERROR, "mmap failed; could not allocate the server metrics.\n");
+        free(absolute);
+        return -1;
+    }
+    memset(metrics, 0, sizeof *metrics);
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&metrics->lock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    /* replace a socket left behind by a server that was killed. */
+    struct stat st;
+    if (stat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(socket_path);
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    snprintf(address.sun_path, sizeof address.sun_path, "%s", socket_path);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr*) &address, sizeof address) != 0 || \
+        listen(listener, SERVER_BACKLOG) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "bind failed; could not listen on \'%s\'.\n", socket_path);
+        free(absolute);
+        return -1;
+    }
+
+    /* interrupting stops accepting (accept is not restarted), then the requests are waited for. */
+    struct sigaction action = { .sa_handler = stop_server };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, 0x0);
+    sigaction(SIGTERM, &action, 0x0);
+    llog(E_LOGGER_LEVEL_INFO, "serving the repositories under \'%s\' on \'%s\'.\n", absolute, \
+        socket_path);
+    fflush(stdout);
+    while (!stopping) {
+        int fd = accept(listener, 0x0, 0x0);
+        while (waitpid(-1, 0x0, WNOHANG) > 0);
+        if (fd < 0)
+            continue;
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            bool served = serve_connection(fd, absolute, &start);
+            fflush(stdout);
+            _exit(served ? 0 : 1);
+        }
+        if (pid < 0)
+            llog(E_LOGGER_LEVEL_ERROR, "fork failed; could not serve a connection.\n");
+        close(fd);
+    }
+    close(listener);
+    unlink(socket_path);
+    while (waitpid(-1, 0x0, 0) > 0 || errno == EINTR);
+
+    /* the summary of every request served, and of the object cache. */
+    shcache_stats_t stats;
+    shcache_read_stats(&stats);
+    llog(E_LOGGER_LEVEL_INFO, "served %lu request(s).\n", \
+        metrics->upload.count + metrics->receive.count + metrics->other.count);
+    log_latency("upload", &metrics->upload);
+    log_latency("receive", &metrics->receive);
+    log_latency("other", &metrics->other);
+    llog(E_LOGGER_LEVEL_INFO, "\tcache    %lu hit(s), %lu miss(es), %lu eviction(s), %lu of %lu " \
+        "slot(s) used.\n", stats.hits, stats.misses, stats.evictions, stats.used, stats.slots);
+    free(absolute);
+    return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-21
+ */
+#ifndef SERVER_H
+#define SERVER_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*!~ @note the default memory cap of the object cache shared by every request of a server. */
+#define SERVER_CACHE_SIZE (64ul << 20)
+
+/*!~ @note the number of connections a server queues before it accepts them. */
+#define SERVER_BACKLOG 64
+
+/**
+ * @brief host every repository under a root directory on a unix socket, until interrupted; each
+ *  connection names its repository ('<socket>:<repository>' on the client) and is served in its
+ *  own process, under a shared lock on the repository while sending and an exclusive one while
+ *  receiving. sent objects are kept in a cache shared by every process, and the latency of each
+ *  request is logged (and summarized when the server stops).
+ *
+ * @param root the directory holding the repositories.
+ * @param socket_path the path of the unix socket to listen on.
+ * @param cache_size the memory cap of the shared object cache in bytes.
+ * @return 0 once the server was stopped, -1 if it could not be started.
+ */
+int
+run_server(const char* root, const char* socket_path, size_t cache_size);
+#endif /* SERVER_H */
@@ -0,0 +1,124 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-23
+ */
+#include "shallow.h"
+
+/*! @uses FILE, fopen, fclose, fscanf, fprintf, snprintf, rename. */
+#include <stdio.h>
+
+/*! @uses free. */
+#include <stdlib.h>
+
+/*! @uses memcpy, memcmp, strcmp. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses access, F_OK. */
+#include <unistd.h>
+
+/*! @uses strtoha. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * @brief read the shallow boundary of the repository in our cwd.
+ *
+ * @param shallow pointer to store the boundary.
+ * @return true if the repository is shallow.
+ */
+bool
+read_shallow(shallow_t* shallow) {
+    /* assert on the boundary. */
+    assert(shallow != 0x0);
+
+    /* a repository without the file has its complete history. */
+    FILE* f = fopen(SHALLOW_PATH, "r");
+    if (!f)
+        return false;
+    char hash[41] = {0};
+    bool shallow_read = fscanf(f, SHALLOW_FORMAT, hash, &shallow->offset) == 2;
+    fclose(f);
+    if (!shallow_read) {
+        llog(E_LOGGER_LEVEL_ERROR, "fscanf failed; could not read the shallow boundary.\n");
+        return false;
+    }
+    unsigned char* _hash = strtoha(hash, 20);
+    memcpy(shallow->base, _hash, 20);
+    free(_hash);
+    return true;
+}
+
+/**
+ * @brief write the shallow boundary of the repository in our cwd.
+ *
+ * @param shallow the boundary to be written.
+ */
+void
+write_shallow(const shallow_t* shallow) {
+    /* assert on the boundary. */
+    assert(shallow != 0x0);
+
+    /* written aside and renamed over, like every other file that is read concurrently. */
+    FILE* f = fopen(SHALLOW_PATH ".tmp", "w");
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open the shallow boundary for writing.\n");
+        exit(EXIT_FAILURE);
+    }
+    char* hash = strsha1(shallow->base);
+    fprintf(f, "base:%s\noffset:%lu\n", hash, shallow->offset);
+    free(hash);
+    fclose(f);
+    rename(SHALLOW_PATH ".tmp", SHALLOW_PATH);
+}
+
+/**
+ * @brief the index in the upstream history of the first commit of a branch; the history of every
+ *  branch that starts at the shallow base is cut at the boundary, every other one is complete.
+ *
+ * @param branch the branch (0x0 if it does not exist).
+ * @return the number of upstream commits before the first commit of the branch.
+ */
+size_t
+shallow_offset(const branch_t* branch) {
+    shallow_t shallow = {0};
+    if (!branch || branch_length(branch) == 0 || !read_shallow(&shallow))
+        return 0;
+    return memcmp(branch_commit(branch, 0)->hash, shallow.base, 20) ? 0 : shallow.offset;
+}
+
+/**
+ * @brief the index in the upstream history of the first commit of a branch, from the refs alone
+ *  (none of the commits are read); see @ref shallow_offset().
+ *
+ * @param name the name of the branch (whose ref may not exist).
+ * @return the number of upstream commits before the first commit of the branch.
+ */
+size_t
+ref_shallow_offset(const char* name) {
+    /* assert on the name. */
+    assert(name != 0x0);
+    shallow_t shallow = {0};
+    char path[256];
+    snprintf(path, 256, ".lit/refs/heads/%s", name);
+    if (access(path, F_OK) != 0 || !read_shallow(&shallow))
+        return 0;
+
+    /* the first commit is owned by the first branch up the parents that does not inherit any. */
+    ref_reader_t* reader = open_ref_reader(name);
+    while (reader->parent && reader->fork > 0) {
+        ref_reader_t* parent = open_ref_reader(reader->parent);
+        close_ref_reader(reader);
+        reader = parent;
+    }
+    const char* first = next_ref_hash(reader);
+    char* base = strsha1(shallow.base);
+    size_t offset = first && !strcmp(first, base) ? shallow.offset : 0;
+    free(base);
+    close_ref_reader(reader);
+    return offset;
+}
@@ -0,0 +1,72 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-23
+ */
+#ifndef SHALLOW_H
+#define SHALLOW_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses sha1_t. */
+#include "hash.h"
+
+/*! @uses branch_t. */
+#include "branch.h"
+
+/*!~ @note the shallow boundary of the object store; the hash of the synthetic base commit that
+ *  holds the full content of the history before it, and the index it stands in for upstream. it
+ *  is kept with the objects so that worktrees share it, clear-cache only collects the commits and
+ *  diffs next to it. */
+#define SHALLOW_PATH ".lit/objects/info/shallow"
+#define SHALLOW_FORMAT "base:%40[0-9a-f]\noffset:%lu\n"
+
+/**
+ * a data structure for the shallow boundary of a repository; the base commit, and how many
+ *  commits of the upstream history come before it (the base is at index <offset> upstream).
+ */
+typedef struct {
+    sha1_t base; /* hash of the synthetic base commit. */
+    size_t offset; /* index of the base in the upstream history. */
+} shallow_t;
+
+/**
+ * @brief read the shallow boundary of the repository in our cwd.
+ *
+ * @param shallow pointer to store the boundary.
+ * @return true if the repository is shallow.
+ */
+bool
+read_shallow(shallow_t* shallow);
+
+/**
+ * @brief write the shallow boundary of the repository in our cwd.
+ *
+ * @param shallow the boundary to be written.
+ */
+void
+write_shallow(const shallow_t* shallow);
+
+/**
+ * @brief the index in the upstream history of the first commit of a branch; the history of every
+ *  branch that starts at the shallow base is cut at the boundary, every other one is complete.
+ *
+ * @param branch the branch (0x0 if it does not exist).
+ * @return the number of upstream commits before the first commit of the branch.
+ */
+size_t
+shallow_offset(const branch_t* branch);
+
+/**
+ * @brief the index in the upstream history of the first commit of a branch, from the refs alone
+ *  (none of the commits are read); see @ref shallow_offset().
+ *
+ * @param name the name of the branch (whose ref may not exist).
+ * @return the number of upstream commits before the first commit of the branch.
+ */
+size_t
+ref_shallow_offset(const char* name);
+#endif /* SHALLOW_H */
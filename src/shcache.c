@@ -0,0 +1,309 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-21
+ */
+/*!~ @note MAP_ANONYMOUS (and the robust mutexes) are not part of -std=c17. */
+#define _DEFAULT_SOURCE
+#include "shcache.h"
+
+/*! @uses memcpy, memset, strlen, strcmp, strncpy. */
+#include <string.h>
+
+/*! @uses calloc. */
+#include <stdlib.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses pthread_mutex_t, pthread_mutexattr_t, PTHREAD_PROCESS_SHARED, PTHREAD_MUTEX_ROBUST. */
+#include <pthread.h>
+
+/*! @uses EOWNERDEAD. */
+#include <errno.h>
+
+/*! @uses mmap, MAP_SHARED, MAP_ANONYMOUS. */
+#include <sys/mman.h>
+
+/*! @uses crc32. */
+#include "hash.h"
+
+/*! @uses internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * a data structure for a single slot of the shared cache; the key and size of the object, and its
+ *  neighbours in the recency list (its bytes are in the data region, at the same index).
+ */
+typedef struct {
+    unsigned int hash; /* crc32 of the key, compared before the key itself. */
+    long prev, next; /* the more and the less recently used slots (-1 at either end). */
+    size_t size; /* size of the object. */
+    char key[512]; /* absolute path of the object. */
+} shcache_slot_t;
+
+/**
+ * a data structure for an entry of the index of the shared cache; open addressing with linear
+ *  probing on the crc32 of the key, so a lookup touches a few entries rather than every slot.
+ */
+typedef struct {
+    unsigned int hash; /* crc32 of the key of the slot. */
+    long slot; /* index of the slot holding the object (-1 if the entry is empty). */
+} shcache_entry_t;
+
+/**
+ * a data structure for the header of the shared cache, followed by the index, the slots and then
+ *  the data.
+ */
+typedef struct {
+    pthread_mutex_t lock; /* process shared (and robust) lock on the cache. */
+    size_t mask; /* number of entries in the index minus one (a power of two). */
+    long head, tail; /* the most and the least recently used slots (-1 if there are none). */
+    shcache_stats_t stats; /* counters of the cache. */
+} shcache_t;
+
+/* the shared mapping, inherited by every forked process. */
+internal shcache_t* cache = 0x0;
+internal shcache_entry_t* entries = 0x0;
+internal shcache_slot_t* slots = 0x0;
+internal unsigned char* data = 0x0;
+
+/**
+ * @brief empty the index and the recency list (the slots are refilled from the first one), the
+ *  counters are kept.
+ */
+internal void
+shcache_reset(void) {
+    for (size_t i = 0; i <= cache->mask; i++)
+        entries[i].slot = -1;
+    cache->head = cache->tail = -1;
+    cache->stats.used = 0;
+}
+
+/**
+ * @brief create the object cache shared by this process and every process it forks afterwards;
+ *  it holds immutable objects keyed by their absolute path, evicting the least recently used one
+ *  once <memory> bytes are in use.
+ *
+ * @param memory the memory cap of the cache in bytes.
+ * @return true if the cache was created.
+ */
+bool
+shcache_create(size_t memory) {
+    /* assert that there is no cache yet. */
+    assert(cache == 0x0);
+
+    /* one mapping for the header, the index (at most half full), the slots and their data. */
+    size_t count = memory / SHCACHE_SLOT_SIZE > 0 ? memory / SHCACHE_SLOT_SIZE : 1, capacity = 2;
+    while (capacity < count * 2)
+        capacity *= 2;
+    size_t length = sizeof *cache + capacity * sizeof *entries + count * (sizeof *slots + \
+        SHCACHE_SLOT_SIZE);
+    void* region = mmap(0x0, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        llog(E_LOGGER_LEVEL_ERROR, "mmap failed; could not allocate the shared object cache.\n");
+        return false;
+    }
+    cache = region;
+    entries = (shcache_entry_t*) (cache + 1);
+    slots = (shcache_slot_t*) (entries + capacity);
+    data = (unsigned char*) (slots + count);
+    cache->mask = capacity - 1;
+    cache->stats.slots = count;
+    shcache_reset();
+
+    /* the lock is taken by every process sharing the mapping; it is robust, so a process dying
+     *  while holding it (a connection killed mid-copy) does not hang every other one. */
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&cache->lock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    return true;
+}
+
+/**
+ * @brief take the lock on the cache; if its last owner died holding it, the cache may be half
+ *  updated, so it is emptied before the lock is made consistent again.
+ *
+ * @return true if the lock is held.
+ */
+internal bool
+shcache_lock(void) {
+    int result = pthread_mutex_lock(&cache->lock);
+    if (result == EOWNERDEAD) {
+        shcache_reset();
+        pthread_mutex_consistent(&cache->lock);
+        return true;
+    }
+    return result == 0;
+}
+
+/**
+ * @brief find the entry of the index for an object (the lock must be held).
+ *
+ * @param key the absolute path of the object.
+ * @param hash the crc32 of the key.
+ * @return the index of the entry, or -1 if the object is not cached.
+ */
+internal long
+shcache_find(const char* key, unsigned int hash) {
+    for (size_t i = hash & cache->mask; entries[i].slot >= 0; i = (i + 1) & cache->mask)
+        if (entries[i].hash == hash && !strcmp(slots[entries[i].slot].key, key))
+            return (long) i;
+    return -1;
+}
+
+/**
+ * @brief remove an entry from the index, shifting back the entries probed past it so that no
+ *  lookup stops early (the lock must be held).
+ *
+ * @param i the index of the entry.
+ */
+internal void
+shcache_unindex(size_t i) {
+    for (size_t j = i;;) {
+        entries[i].slot = -1;
+        for (;;) {
+            j = (j + 1) & cache->mask;
+            if (entries[j].slot < 0)
+                return;
+
+            /* an entry whose home is cyclically in (i, j] stays where it is. */
+            size_t home = entries[j].hash & cache->mask;
+            if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+                continue;
+            break;
+        }
+        entries[i] = entries[j];
+        i = j;
+    }
+}
+
+/**
+ * @brief unlink a slot from the recency list (the lock must be held).
+ *
+ * @param i the index of the slot.
+ */
+internal void
+shcache_unlink(long i) {
+    if (slots[i].prev >= 0) slots[slots[i].prev].next = slots[i].next;
+    else cache->head = slots[i].next;
+    if (slots[i].next >= 0) slots[slots[i].next].prev = slots[i].prev;
+    else cache->tail = slots[i].prev;
+}
+
+/**
+ * @brief link a slot at the front of the recency list, as the most recently used (the lock must be
+ *  held).
+ *
+ * @param i the index of the slot.
+ */
+internal void
+shcache_link(long i) {
+    slots[i].prev = -1;
+    slots[i].next = cache->head;
+    if (cache->head >= 0) slots[cache->head].prev = i;
+    else cache->tail = i;
+    cache->head = i;
+}
+
+/**
+ * @brief copy an object out of the shared cache.
+ *
+ * @param key the absolute path of the object.
+ * @param size pointer to store the size of the object.
+ * @return the allocated bytes of the object, or 0x0 if it is not cached (or there is no cache).
+ */
+unsigned char*
+shcache_get(const char* key, size_t* size) {
+    /* assert on the key and the size. */
+    assert(key != 0x0);
+    assert(size != 0x0);
+    if (!cache)
+        return 0x0;
+
+    /* copy the bytes out under the lock, the slot can be evicted right after. */
+    unsigned int hash = crc32((const unsigned char*) key, strlen(key));
+    unsigned char* copy = 0x0;
+    if (!shcache_lock())
+        return 0x0;
+    long e = shcache_find(key, hash);
+    if (e >= 0) {
+        long i = entries[e].slot;
+        shcache_unlink(i);
+        shcache_link(i);
+        *size = slots[i].size;
+        copy = calloc(1, *size + 1);
+        memcpy(copy, data + (size_t) i * SHCACHE_SLOT_SIZE, *size);
+        cache->stats.hits++;
+    }
+    else
+        cache->stats.misses++;
+    pthread_mutex_unlock(&cache->lock);
+    return copy;
+}
+
+/**
+ * @brief copy an object into the shared cache (if there is one and the object fits a slot).
+ *
+ * @param key the absolute path of the object.
+ * @param bytes the bytes of the object.
+ * @param size the size of the object.
+ */
+void
+shcache_put(const char* key, const unsigned char* bytes, size_t size) {
+    /* assert on the key and the bytes. */
+    assert(key != 0x0);
+    assert(bytes != 0x0);
+    if (!cache || size > SHCACHE_SLOT_SIZE || strlen(key) >= sizeof slots->key)
+        return;
+
+    /* the next unused slot, otherwise the least recently used one (taken out of the index). */
+    unsigned int hash = crc32((const unsigned char*) key, strlen(key));
+    if (!shcache_lock())
+        return;
+    if (shcache_find(key, hash) < 0) {
+        long victim = (long) cache->stats.used;
+        if (cache->stats.used < cache->stats.slots)
+            cache->stats.used++;
+        else {
+            victim = cache->tail;
+            shcache_unindex((size_t) shcache_find(slots[victim].key, slots[victim].hash));
+            shcache_unlink(victim);
+            cache->stats.evictions++;
+        }
+        slots[victim].hash = hash;
+        slots[victim].size = size;
+        strcpy(slots[victim].key, key);
+        memcpy(data + (size_t) victim * SHCACHE_SLOT_SIZE, bytes, size);
+        shcache_link(victim);
+
+        /* then index it, the index is never more than half full. */
+        size_t i = hash & cache->mask;
+        while (entries[i].slot >= 0)
+            i = (i + 1) & cache->mask;
+        entries[i].hash = hash;
+        entries[i].slot = victim;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * @brief read the counters of the shared cache.
+ *
+ * @param stats pointer to store the counters (zeroed if there is no cache).
+ */
+void
+shcache_read_stats(shcache_stats_t* stats) {
+    /* assert on the counters. */
+    assert(stats != 0x0);
+    memset(stats, 0, sizeof *stats);
+    if (!cache || !shcache_lock())
+        return;
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,65 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-21
+ */
+#ifndef SHCACHE_H
+#define SHCACHE_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*!~ @note every cached object takes one slot of this size, so the memory cap divided by it is the
+ *  number of objects held; larger objects are never cached (diffs hold whole files). */
+#define SHCACHE_SLOT_SIZE 16384
+
+/**
+ * a data structure for the counters of the shared object cache.
+ */
+typedef struct {
+    size_t hits, misses; /* lookups that did and did not find the object. */
+    size_t evictions; /* objects evicted to make room for another. */
+    size_t slots, used; /* number of slots, and slots holding an object. */
+} shcache_stats_t;
+
+/**
+ * @brief create the object cache shared by this process and every process it forks afterwards;
+ *  it holds immutable objects keyed by their absolute path, evicting the least recently used one
+ *  once <memory> bytes are in use.
+ *
+ * @param memory the memory cap of the cache in bytes.
+ * @return true if the cache was created.
+ */
+bool
+shcache_create(size_t memory);
+
+/**
+ * @brief copy an object out of the shared cache.
+ *
+ * @param key the absolute path of the object.
+ * @param size pointer to store the size of the object.
+ * @return the allocated bytes of the object, or 0x0 if it is not cached (or there is no cache).
+ */
+unsigned char*
+shcache_get(const char* key, size_t* size);
+
+/**
+ * @brief copy an object into the shared cache (if there is one and the object fits a slot).
+ *
+ * @param key the absolute path of the object.
+ * @param bytes the bytes of the object.
+ * @param size the size of the object.
+ */
+void
+shcache_put(const char* key, const unsigned char* bytes, size_t size);
+
+/**
+ * @brief read the counters of the shared cache.
+ *
+ * @param stats pointer to store the counters (zeroed if there is no cache).
+ */
+void
+shcache_read_stats(shcache_stats_t* stats);
+#endif /* SHCACHE_H */
@@ -0,0 +1,136 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-17
+ */
+#include "sparse.h"
+
+/*! @uses fopen, fprintf, fclose, remove. */
+#include <stdio.h>
+
+/*! @uses free. */
+#include <stdlib.h>
+
+/*! @uses strlen, strncmp. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses pthread_once_t, pthread_once. */
+#include <pthread.h>
+
+/*! @uses bloom_normalize. */
+#include "bloom.h"
+
+/*! @uses freadls, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/* the prefixes of the repository, read once per process. */
+internal dyna_t* prefixes = 0x0;
+internal pthread_once_t prefixes_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief read the sparse checkout prefixes of the repository.
+ *
+ * @return a dynamic array of allocated prefixes (empty if the checkout is not sparse).
+ */
+dyna_t*
+read_sparse() {
+    dyna_t* array = dyna_create();
+    FILE* f = fopen(SPARSE_PATH, "r");
+    if (!f)
+        return array;
+
+    /* every non-empty line is a prefix. */
+    size_t n = 0;
+    char** lines = freadls(f, &n);
+    fclose(f);
+    for (size_t i = 0; i < n; i++) {
+        size_t length = 0;
+        bloom_normalize(lines[i], &length);
+        if (length > 0) dyna_push(array, lines[i]);
+        else free(lines[i]);
+    }
+    free(lines);
+    return array;
+}
+
+/**
+ * @brief read the prefixes of the repository (once).
+ */
+internal void
+load_prefixes(void) {
+    if (!prefixes) prefixes = read_sparse();
+}
+
+/**
+ * @brief write the sparse checkout prefixes of the repository (none to disable it), and use them
+ *  for every following check in this process.
+ *
+ * @param array the array of prefixes.
+ */
+void
+write_sparse(dyna_t* array) {
+    /* assert on the prefixes. */
+    assert(array != 0x0);
+    pthread_once(&prefixes_once, load_prefixes);
+
+    /* no prefixes means the checkout is not sparse. */
+    if (array->length == 0)
+        remove(SPARSE_PATH);
+    else {
+        FILE* f = fopen(SPARSE_PATH, "w");
+        if (!f) {
+            llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open sparse prefixes for writing.\n");
+            exit(EXIT_FAILURE);
+        }
+        _foreach(array, const char*, prefix)
+            fprintf(f, "%s\n", prefix);
+        _endforeach;
+        fclose(f);
+    }
+
+    /* replace the prefixes used by this process. */
+    _foreach(prefixes, char*, prefix)
+        free(prefix);
+    _endforeach;
+    dyna_free(prefixes);
+    prefixes = dyna_create();
+    _foreach(array, const char*, prefix)
+        dyna_push(prefixes, strdup(prefix));
+    _endforeach;
+}
+
+/**
+ * @brief check if a path is checked out; a path is if it is under one of the prefixes, or is one
+ *  of the parent directories of a prefix (the prefixes are read once per process).
+ *
+ * @param path the path to be checked.
+ * @return true if the path is checked out (always, when the checkout is not sparse).
+ */
+bool
+sparse_includes(const char* path) {
+    /* assert on the path. */
+    assert(path != 0x0);
+    pthread_once(&prefixes_once, load_prefixes);
+    if (prefixes->length == 0)
+        return true;
+
+    /* compare on whole path components, either way around. */
+    size_t path_length = 0;
+    path = bloom_normalize(path, &path_length);
+    _foreach(prefixes, const char*, _prefix)
+        size_t prefix_length = 0;
+        const char* prefix = bloom_normalize(_prefix, &prefix_length);
+        size_t shorter = path_length < prefix_length ? path_length : prefix_length;
+        if (strncmp(path, prefix, shorter)) continue;
+        if (path_length == prefix_length || \
+            (path_length > prefix_length && path[prefix_length] == '/') || \
+            (path_length < prefix_length && prefix[path_length] == '/'))
+            return true;
+    _endforeach;
+    return false;
+}
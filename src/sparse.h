@@ -0,0 +1,44 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-17
+ */
+#ifndef SPARSE_H
+#define SPARSE_H
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses dyna_t. */
+#include "dyna.h"
+
+/*!~ @note the path of the sparse checkout prefixes, one per line; when the file does not exist
+ *  every path is checked out. */
+#define SPARSE_PATH ".lit/sparse"
+
+/**
+ * @brief read the sparse checkout prefixes of the repository.
+ *
+ * @return a dynamic array of allocated prefixes (empty if the checkout is not sparse).
+ */
+dyna_t*
+read_sparse();
+
+/**
+ * @brief write the sparse checkout prefixes of the repository (none to disable it), and use them
+ *  for every following check in this process.
+ *
+ * @param prefixes the array of prefixes.
+ */
+void
+write_sparse(dyna_t* prefixes);
+
+/**
+ * @brief check if a path is checked out; a path is if it is under one of the prefixes, or is one
+ *  of the parent directories of a prefix (the prefixes are read once per process).
+ *
+ * @param path the path to be checked.
+ * @return true if the path is checked out (always, when the checkout is not sparse).
+ */
+bool
+sparse_includes(const char* path);
+#endif /* SPARSE_H */
@@ -7,9 +7,12 @@
 /*! @uses assert. */
 #include <assert.h>
 
-/*! @uses exit, calloc. */
+/*! @uses exit, calloc, qsort. */
 #include <stdlib.h>
 
+/*! @uses memchr, memcpy, memmove, strncmp. */
+#include <string.h>
+
 /*! @uses strdup. */
 #include "utl.h"
 
@@ -22,6 +25,11 @@
 /*! @uses log, E_LOGGER_LEVEL_ERROR, E_LOGGER_LEVEL_INFO. */
 #include "log.h"
 
+/*!~ @note the packed refs are one line per tag, sorted by name; '<commit sha1> <branch sha1> <name>',
+ *  so the name starts at a fixed offset and lookups can binary search the file directly. */
+#define PACKED_REFS_PATH ".lit/refs/packed"
+#define PACKED_NAME_OFFSET 82ul
+
 /**
  * @brief create a tag for a commit with a message.
  *
@@ -78,66 +86,463 @@ write_tag(const tag_t* tag) {
 }
 
 /**
- * @brief read tags from the folder '.lit/refs/tags/'
+ * @brief read a loose tag file.
+ *
+ * @param path the path to the tag file.
+ * @return the allocated tag structure, or 0x0 if the file does not exist.
+ */
+internal tag_t*
+read_loose_tag(const char* path) {
+    /* open the file, a missing file is simply not a loose tag. */
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return 0x0;
+
+    /* allocate the tag. */
+    tag_t* tag = calloc(1, sizeof *tag);
+    if (!tag) {
+        llog(E_LOGGER_LEVEL_ERROR, "calloc failed; could not allocate memory for tag.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* read the file information. */
+    tag->name = calloc(1, 1025);
+    char* commit_hash = calloc(1, 41), *branch_hash = calloc(1, 41);
+    int scanned = fscanf(f, "msg:%1024[^\n]\ncommit:%40[^\n]\nbranch:%40[^\n]\n", \
+        tag->name, commit_hash, branch_hash);
+    if (scanned != 3) {
+        llog(E_LOGGER_LEVEL_ERROR, "fscanf failed; could not read tag file \'%s\'\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    /* convert the hashes. */
+    unsigned char *_commit_hash = strtoha(commit_hash, 20), \
+        *_branch_hash = strtoha(branch_hash, 20);
+    free(commit_hash);
+    free(branch_hash);
+
+    /* copy the converted hashes over. */
+    memcpy(tag->commit_hash, _commit_hash, 20);
+    free(_commit_hash);
+    memcpy(tag->branch_hash, _branch_hash, 20);
+    free(_branch_hash);
+    fclose(f);
+    return tag;
+}
+
+/**
+ * @brief read the whole packed refs file into memory.
+ *
+ * @param length pointer to store the length of the file.
+ * @return the allocated contents, or 0x0 if there are no packed refs.
+ */
+internal char*
+read_packed(size_t* length) {
+    /* open the file, and read it in one go. */
+    *length = 0;
+    FILE* f = fopen(PACKED_REFS_PATH, "r");
+    if (!f)
+        return 0x0;
+    fseek(f, 0, SEEK_END);
+    *length = (size_t) ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = calloc(1, *length + 1);
+    if (fread(data, 1, *length, f) != *length) {
+        llog(E_LOGGER_LEVEL_ERROR, "fread failed; could not read packed refs.\n");
+        exit(EXIT_FAILURE);
+    }
+    fclose(f);
+    return data;
+}
+
+/**
+ * @brief parse a single line of the packed refs into a tag.
+ *
+ * @param line the start of the line.
+ * @param length the length of the line (without the newline).
+ * @return the allocated tag structure.
+ */
+internal tag_t*
+parse_packed(const char* line, size_t length) {
+    /* a line is always at least both hashes and the separators. */
+    if (length <= PACKED_NAME_OFFSET || line[40] != ' ' || line[81] != ' ') {
+        llog(E_LOGGER_LEVEL_ERROR, "malformed packed refs; could not read tag.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* allocate the tag. */
+    tag_t* tag = calloc(1, sizeof *tag);
+    if (!tag) {
+        llog(E_LOGGER_LEVEL_ERROR, "calloc failed; could not allocate memory for tag.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* convert the hashes and copy the name. */
+    char hash[41] = {0};
+    memcpy(hash, line, 40);
+    unsigned char* _commit_hash = strtoha(hash, 20);
+    memcpy(hash, line + 41, 40);
+    unsigned char* _branch_hash = strtoha(hash, 20);
+    memcpy(tag->commit_hash, _commit_hash, 20);
+    memcpy(tag->branch_hash, _branch_hash, 20);
+    free(_commit_hash);
+    free(_branch_hash);
+    tag->name = calloc(1, length - PACKED_NAME_OFFSET + 1);
+    memcpy(tag->name, line + PACKED_NAME_OFFSET, length - PACKED_NAME_OFFSET);
+    return tag;
+}
+
+/**
+ * @brief binary search the packed refs for a tag by name.
+ *
+ * @param data the contents of the packed refs.
+ * @param length the length of the contents.
+ * @param name the name of the tag.
+ * @param line_length pointer to store the length of the line found.
+ * @return the start of the line of the tag, or 0x0 if it is not packed.
+ */
+internal const char*
+search_packed(const char* data, size_t length, const char* name, size_t* line_length) {
+    /* the bounds are always at the start of a line; step back from the middle to the start of the
+     *  line it falls in, and compare the name of that line. */
+    size_t low = 0, high = length;
+    while (low < high) {
+        size_t start = low + (high - low) / 2;
+        while (start > low && data[start - 1] != '\n')
+            start--;
+        const char* newline = memchr(data + start, '\n', length - start);
+        size_t end = newline ? (size_t) (newline - data) : length;
+        if (end - start <= PACKED_NAME_OFFSET) {
+            llog(E_LOGGER_LEVEL_ERROR, "malformed packed refs; could not search tags.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        /* compare the name against the name on the line. */
+        size_t name_length = end - start - PACKED_NAME_OFFSET;
+        int cmp = strncmp(name, data + start + PACKED_NAME_OFFSET, name_length);
+        if (cmp == 0 && name[name_length] == '\0') {
+            *line_length = end - start;
+            return data + start;
+        }
+        if (cmp < 0)
+            high = start;
+        else
+            low = end + 1; /* ours sorts after (or has the name on the line as a prefix). */
+    }
+    return 0x0;
+}
+
+/**
+ * @brief read a single tag by name; a loose tag in '.lit/refs/tags/' overrides a packed one, which
+ *  is found with a binary search over the sorted '.lit/refs/packed' file.
+ *
+ * @param name the name of the tag.
+ * @return the allocated tag structure, or 0x0 if the tag does not exist.
+ */
+tag_t*
+read_tag(const char* name) {
+    /* assert on the name. */
+    assert(name != 0x0);
+
+    /* loose tags are checked first. */
+    char path[256];
+    snprintf(path, 256, ".lit/refs/tags/%s", name);
+    tag_t* tag = read_loose_tag(path);
+    if (tag)
+        return tag;
+
+    /* then the packed refs. */
+    size_t length = 0, line_length = 0;
+    char* data = read_packed(&length);
+    if (!data)
+        return 0x0;
+    const char* line = search_packed(data, length, name, &line_length);
+    if (line)
+        tag = parse_packed(line, line_length);
+    free(data);
+    return tag;
+}
+
+/**
+ * @brief compare two tags by name (for sorting).
  *
- * @return a dynamic array of allocated tag structures.
+ * @param a pointer to the first tag ptr.
+ * @param b pointer to the second tag ptr.
+ * @return the comparison of the names.
+ */
+internal int
+compare_tags(const void* a, const void* b) {
+    return strcmp((*(const tag_t**) a)->name, (*(const tag_t**) b)->name);
+}
+
+/**
+ * @brief read every tag in the repository, packed and loose (loose tags override packed ones).
+ *
+ * @return a dynamic array of allocated tag structures, sorted by name.
  */
 dyna_t*
 read_tags() {
-    /* collect all tags in the './lit/refs/tags/' folder. */
-    dyna_t* array = inw_walk(".lit/refs/tags", E_INW_TYPE_NO_RECURSE);
-
-    /* create our tag list. */
+    /* create our tag list, starting with the packed refs (already sorted). */
     dyna_t* new_array = dyna_create();
+    size_t length = 0;
+    char* data = read_packed(&length);
+    for (size_t start = 0; data && start < length;) {
+        const char* newline = memchr(data + start, '\n', length - start);
+        size_t end = newline ? (size_t) (newline - data) : length;
+        if (end > start)
+            dyna_push(new_array, parse_packed(data + start, end - start));
+        start = end + 1;
+    }
+    free(data);
+    size_t packed = new_array->length;
 
-    /* iterate through each inode. */
+    /* collect all loose tags in the './lit/refs/tags/' folder. */
+    dyna_t* array = inw_walk(".lit/refs/tags", E_INW_TYPE_NO_RECURSE);
+    bool unsorted = false;
     _foreach_it(array, inode_t*, node, i)
         /* ignore everything that is not a file. */
         if (node->type != E_INODE_TYPE_FILE)
             continue;
+        tag_t* tag = read_loose_tag(node->path);
+        if (!tag)
+            continue;
 
-        /* allocate and open the file. */
-        tag_t* tag = calloc(1, sizeof *tag);
-        if (!tag) {
-            llog(E_LOGGER_LEVEL_ERROR, "calloc failed; could not allocate memory for tag.\n");
-            exit(EXIT_FAILURE);
+        /* a loose tag replaces the packed tag with the same name. */
+        tag_t** found = packed ? bsearch(&tag, new_array->data, packed, sizeof(tag_t*), \
+            compare_tags) : 0x0;
+        if (found) {
+            free((*found)->name);
+            free(*found);
+            *found = tag;
         }
-        FILE* f = fopen(node->path, "r");
-        if (!f) {
-            llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open file for tag reading.\n");
-            exit(EXIT_FAILURE);
+        else {
+            dyna_push(new_array, tag);
+            unsorted = true;
         }
+    _endforeach;
+    dyna_free(array);
 
-        /* read the file information. */
-        tag->name = calloc(1, 1025);
-        char* commit_hash = calloc(1, 41), *branch_hash = calloc(1, 41);
-        int scanned = fscanf(f, "msg:%1024[^\n]\ncommit:%40[^\n]\nbranch:%40[^\n]\n", \
-            tag->name, commit_hash, branch_hash);
-        if (scanned != 3) {
-            llog(E_LOGGER_LEVEL_ERROR, "fscanf failed; could not read tag file \'%s\'\n", node->path);
-            exit(EXIT_FAILURE);
-        }
+    /* keep the array sorted by name. */
+    if (unsorted)
+        qsort(new_array->data, new_array->length, sizeof(tag_t*), compare_tags);
+    return new_array;
+}
+
+/**
+ * @brief write the packed refs atomically (written to a temporary file, then renamed).
+ *
+ * @param data the contents to be written.
+ * @param length the length of the contents.
+ */
+internal void
+write_packed(const char* data, size_t length) {
+    /* write to the temporary file. */
+    FILE* f = fopen(PACKED_REFS_PATH ".tmp", "w");
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open packed refs for writing.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (length > 0 && fwrite(data, 1, length, f) != length) {
+        llog(E_LOGGER_LEVEL_ERROR, "fwrite failed; could not write packed refs.\n");
+        exit(EXIT_FAILURE);
+    }
+    fclose(f);
+
+    /* then replace the packed refs. */
+    if (rename(PACKED_REFS_PATH ".tmp", PACKED_REFS_PATH) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "rename failed; could not replace packed refs.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief delete a tag by name, both the loose tag and its entry in the packed refs.
+ *
+ * @param name the name of the tag.
+ * @return true if the tag existed.
+ */
+bool
+delete_tag(const char* name) {
+    /* assert on the name. */
+    assert(name != 0x0);
 
-        /* convert the hashes. */
-        unsigned char *_commit_hash = strtoha(commit_hash, 20), \
-            *_branch_hash = strtoha(branch_hash, 20);
+    /* remove the loose tag. */
+    char path[256];
+    snprintf(path, 256, ".lit/refs/tags/%s", name);
+    bool found = remove(path) == 0;
+
+    /* then remove the line from the packed refs (if it is packed). */
+    size_t length = 0, line_length = 0;
+    char* data = read_packed(&length);
+    if (!data)
+        return found;
+    const char* line = search_packed(data, length, name, &line_length);
+    if (line) {
+        size_t start = (size_t) (line - data), end = start + line_length + 1;
+        if (end > length) end = length;
+        memmove(data + start, data + end, length - end);
+        write_packed(data, length - (end - start));
+        found = true;
+    }
+    free(data);
+    return found;
+}
+
+/**
+ * @brief pack every tag into the sorted '.lit/refs/packed' file, and remove the loose tags.
+ *
+ * @return the number of tags packed.
+ */
+size_t
+pack_tags() {
+    /* read every tag (sorted by name), and write them out as lines. */
+    dyna_t* tags = read_tags();
+    size_t length = 0, capacity = 1024;
+    char* data = calloc(1, capacity);
+    _foreach(tags, tag_t*, tag)
+        size_t needed = PACKED_NAME_OFFSET + strlen(tag->name) + 2;
+        while (length + needed > capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+        char* commit_hash = strsha1(tag->commit_hash), *branch_hash = strsha1(tag->branch_hash);
+        length += (size_t) snprintf(data + length, capacity - length, "%s %s %s\n", \
+            commit_hash, branch_hash, tag->name);
         free(commit_hash);
         free(branch_hash);
+    _endforeach;
+    write_packed(data, length);
+    free(data);
+
+    /* the loose tags are now packed. */
+    dyna_t* array = inw_walk(".lit/refs/tags", E_INW_TYPE_NO_RECURSE);
+    _foreach_it(array, inode_t*, node, i)
+        if (node->type == E_INODE_TYPE_FILE)
+            remove(node->path);
+    _endforeach;
+    dyna_free(array);
+    size_t count = tags->length;
+    _foreach(tags, tag_t*, tag)
+        free(tag->name);
+        free(tag);
+    _endforeach;
+    dyna_free(tags);
+    return count;
+}
 
-        /* copy the converted hashes over. */
-        memcpy(tag->commit_hash, _commit_hash, 20);
-        free(_commit_hash);
-        memcpy(tag->branch_hash, _branch_hash, 20);
-        free(_branch_hash);
+/**
+ * @brief index tags by the commit they point to (for decorating commits).
+ *
+ * @param tags the dynamic array of tags to be indexed.
+ * @return a hash map of commit hash strings to dynamic arrays of tags.
+ */
+hmap_t*
+index_tags(dyna_t* tags) {
+    /* assert on the tags. */
+    assert(tags != 0x0);
 
-        /* free and append. */
-        fclose(f);
-        dyna_push(new_array, tag);
+    /* group the tags under the hash of their commit. */
+    hmap_t* index = hmap_create();
+    _foreach(tags, tag_t*, tag)
+        char* hash = strsha1(tag->commit_hash);
+        dyna_t* group = hmap_get(index, hash);
+        if (!group) {
+            group = dyna_create();
+            hmap_put(index, hash, group);
+        }
+        dyna_push(group, tag);
+        free(hash);
     _endforeach;
+    return index;
+}
 
-    /* free and return. */
+/**
+ * @brief add the name of a tag under the hash of its commit.
+ *
+ * @param index hash map of commit hash strings to dynamic arrays of names.
+ * @param hash the hash string of the commit.
+ * @param name the allocated name of the tag (owned by the index).
+ */
+internal void
+index_tag_name(hmap_t* index, const char* hash, char* name) {
+    dyna_t* group = hmap_get(index, hash);
+    if (!group) {
+        group = dyna_create();
+        hmap_put(index, hash, group);
+    }
+    dyna_push(group, name);
+}
+
+/**
+ * @brief index the names of the tags by the commit they point to (for decorating commits); the
+ *  packed refs are read in place, without a tag allocated for any of them, and only the loose
+ *  tags are read one by one (a loose tag overrides the packed one with the same name).
+ *
+ * @return a hash map of commit hash strings to dynamic arrays of allocated tag names.
+ */
+hmap_t*
+index_tag_names() {
+    /* the loose tags first (there are only a few once the refs are packed). */
+    hmap_t* index = hmap_create(), *loose = hmap_create();
+    dyna_t* array = inw_walk(".lit/refs/tags", E_INW_TYPE_NO_RECURSE);
+    _foreach(array, inode_t*, node)
+        if (node->type != E_INODE_TYPE_FILE)
+            continue;
+        tag_t* tag = read_loose_tag(node->path);
+        if (!tag)
+            continue;
+        char* hash = strsha1(tag->commit_hash);
+        hmap_put(loose, tag->name, tag);
+        index_tag_name(index, hash, strdup(tag->name));
+        free(hash);
+    _endforeach;
     dyna_free(array);
-    return new_array;
+
+    /* then every line of the packed refs; the commit hash starts the line, the name ends it. */
+    size_t length = 0;
+    char* data = read_packed(&length), hash[41] = {0};
+    for (size_t start = 0; data && start < length;) {
+        const char* newline = memchr(data + start, '\n', length - start);
+        size_t end = newline ? (size_t) (newline - data) : length;
+        if (end > start && end - start <= PACKED_NAME_OFFSET) {
+            llog(E_LOGGER_LEVEL_ERROR, "malformed packed refs; could not index tags.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (end > start) {
+            char* name = calloc(1, end - start - PACKED_NAME_OFFSET + 1);
+            memcpy(name, data + start + PACKED_NAME_OFFSET, end - start - PACKED_NAME_OFFSET);
+            memcpy(hash, data + start, 40);
+            if (hmap_has(loose, name)) free(name);
+            else index_tag_name(index, hash, name);
+        }
+        start = end + 1;
+    }
+    free(data);
+    _hmap_foreach(loose, entry)
+        tag_t* tag = entry->value;
+        free(tag->name);
+        free(tag);
+    _endforeach;
+    hmap_free(loose);
+    return index;
+}
+
+/**
+ * @brief free an index of tag names returned by @ref index_tag_names().
+ *
+ * @param index the index to be freed.
+ */
+void
+free_tag_names(hmap_t* index) {
+    /* assert on the index. */
+    assert(index != 0x0);
+    _hmap_foreach(index, entry)
+        _foreach(((dyna_t*) entry->value), char*, name)
+            free(name);
+        _endforeach;
+        dyna_free(entry->value);
+    _endforeach;
+    hmap_free(index);
 }
 
 /**
@@ -17,6 +17,9 @@
 /*! @uses sha1_t. */
 #include "hash.h"
 
+/*! @uses hmap_t. */
+#include "hmap.h"
+
 /**
  * a data structure representing a tag used within the version control system; a marker on a certain
  *  commit for the users to use within the command line. for example, if there is a specific
@@ -50,13 +53,67 @@ void
 write_tag(const tag_t* tag);
 
 /**
- * @brief read tags from the folder '.lit/refs/tags/'
+ * @brief read a single tag by name; a loose tag in '.lit/refs/tags/' overrides a packed one, which
+ *  is found with a binary search over the sorted '.lit/refs/packed' file.
  *
- * @return a dynamic array of allocated tag structures.
+ * @param name the name of the tag.
+ * @return the allocated tag structure, or 0x0 if the tag does not exist.
+ */
+tag_t*
+read_tag(const char* name);
+
+/**
+ * @brief read every tag in the repository, packed and loose (loose tags override packed ones).
+ *
+ * @return a dynamic array of allocated tag structures, sorted by name.
  */
 dyna_t*
 read_tags();
 
+/**
+ * @brief delete a tag by name, both the loose tag and its entry in the packed refs.
+ *
+ * @param name the name of the tag.
+ * @return true if the tag existed.
+ */
+bool
+delete_tag(const char* name);
+
+/**
+ * @brief pack every tag into the sorted '.lit/refs/packed' file, and remove the loose tags.
+ *
+ * @return the number of tags packed.
+ */
+size_t
+pack_tags();
+
+/**
+ * @brief index tags by the commit they point to (for decorating commits).
+ *
+ * @param tags the dynamic array of tags to be indexed.
+ * @return a hash map of commit hash strings to dynamic arrays of tags.
+ */
+hmap_t*
+index_tags(dyna_t* tags);
+
+/**
+ * @brief index the names of the tags by the commit they point to (for decorating commits); the
+ *  packed refs are read in place, without a tag allocated for any of them, and only the loose
+ *  tags are read one by one (a loose tag overrides the packed one with the same name).
+ *
+ * @return a hash map of commit hash strings to dynamic arrays of allocated tag names.
+ */
+hmap_t*
+index_tag_names();
+
+/**
+ * @brief free an index of tag names returned by @ref index_tag_names().
+ *
+ * @param index the index to be freed.
+ */
+void
+free_tag_names(hmap_t* index);
+
 /**
  * @brief filter tags based on the branch to a new array.
  *
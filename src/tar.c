@@ -0,0 +1,124 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-16
+ */
+#include "tar.h"
+
+/*! @uses memset, memcpy, strlen, strrchr. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/*! @uses internal. */
+#include "utl.h"
+
+/**
+ * a data structure for the header block of a file in a ustar tar stream,
+ *  @ref[https://pubs.opengroup.org/onlinepubs/9699919799/utilities/pax.html#tag_20_92_13_06].
+ */
+typedef struct {
+    char name[100], mode[8], uid[8], gid[8], size[12], mtime[12], checksum[8], type;
+    char linkname[100], magic[6], version[2], uname[32], gname[32], devmajor[8], devminor[8];
+    char prefix[155], padding[12];
+} tar_header_t;
+
+/**
+ * @brief split a path into the name and prefix fields of a ustar header.
+ *
+ * @param header the header to be filled in.
+ * @param path the path of the file inside the archive.
+ * @return true if the path fits in the header.
+ */
+internal bool
+tar_set_path(tar_header_t* header, const char* path) {
+    size_t length = strlen(path);
+    if (length <= sizeof header->name) {
+        memcpy(header->name, path, length);
+        return true;
+    }
+
+    /* split on the last '/' that leaves a name short enough. */
+    for (const char* split = path + length; split-- > path;) {
+        if (*split != '/') continue;
+        size_t prefix = (size_t) (split - path), name = length - prefix - 1;
+        if (name > sizeof header->name) return false;
+        if (prefix > sizeof header->prefix) continue;
+        memcpy(header->prefix, path, prefix);
+        memcpy(header->name, split + 1, name);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief write a regular file to a POSIX (ustar) tar stream, as its header followed by its lines
+ *  (each ending in a newline) padded to a whole block.
+ *
+ * @param f the stream to be written to.
+ * @param path the path of the file inside the archive.
+ * @param lines the lines of the file.
+ * @param n the number of lines.
+ * @param mtime the modification time of the file.
+ * @return true if the file was written, false if the path is too long for a ustar header.
+ */
+bool
+write_tar_file(FILE* f, const char* path, char** lines, size_t n, time_t mtime) {
+    /* assert on the stream and the path. */
+    assert(f != 0x0);
+    assert(path != 0x0);
+
+    /* the paths in an archive are relative. */
+    while (!strncmp(path, "./", 2)) path += 2;
+    tar_header_t header;
+    memset(&header, 0, sizeof header);
+    if (!tar_set_path(&header, path)) {
+        llog(E_LOGGER_LEVEL_ERROR, "path \'%s\' is too long for a tar header.\n", path);
+        return false;
+    }
+
+    /* fill in the rest of the header, the checksum is computed with its own field as spaces. */
+    size_t size = 0;
+    for (size_t i = 0; i < n; i++)
+        size += strlen(lines[i]) + 1;
+    snprintf(header.mode, sizeof header.mode, "%07o", 0644);
+    snprintf(header.uid, sizeof header.uid, "%07o", 0);
+    snprintf(header.gid, sizeof header.gid, "%07o", 0);
+    snprintf(header.size, sizeof header.size, "%011lo", (unsigned long) size);
+    snprintf(header.mtime, sizeof header.mtime, "%011lo", (unsigned long) mtime);
+    header.type = '0';
+    memcpy(header.magic, "ustar", 6);
+    memcpy(header.version, "00", 2);
+    memset(header.checksum, ' ', sizeof header.checksum);
+    unsigned int checksum = 0;
+    for (size_t i = 0; i < sizeof header; i++)
+        checksum += ((unsigned char*) &header)[i];
+    snprintf(header.checksum, sizeof header.checksum, "%06o", checksum);
+    fwrite(&header, sizeof header, 1, f);
+
+    /* then the content, padded to a whole block. */
+    for (size_t i = 0; i < n; i++) {
+        fputs(lines[i], f);
+        fputc('\n', f);
+    }
+    static const char zeros[TAR_BLOCK_SIZE] = { 0 };
+    if (size % TAR_BLOCK_SIZE)
+        fwrite(zeros, TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE, 1, f);
+    return true;
+}
+
+/**
+ * @brief end a tar stream with its two empty blocks.
+ *
+ * @param f the stream to be written to.
+ */
+void
+finish_tar(FILE* f) {
+    /* assert on the stream. */
+    assert(f != 0x0);
+    static const char zeros[TAR_BLOCK_SIZE * 2] = { 0 };
+    fwrite(zeros, sizeof zeros, 1, f);
+}
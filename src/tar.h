@@ -0,0 +1,42 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-16
+ */
+#ifndef TAR_H
+#define TAR_H
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/*! @uses time_t. */
+#include <time.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*!~ @note the size (in bytes) of a block of a tar stream, every header and every file is padded
+ *  to a whole number of blocks. */
+#define TAR_BLOCK_SIZE 512
+
+/**
+ * @brief write a regular file to a POSIX (ustar) tar stream, as its header followed by its lines
+ *  (each ending in a newline) padded to a whole block.
+ *
+ * @param f the stream to be written to.
+ * @param path the path of the file inside the archive.
+ * @param lines the lines of the file.
+ * @param n the number of lines.
+ * @param mtime the modification time of the file.
+ * @return true if the file was written, false if the path is too long for a ustar header.
+ */
+bool
+write_tar_file(FILE* f, const char* path, char** lines, size_t n, time_t mtime);
+
+/**
+ * @brief end a tar stream with its two empty blocks.
+ *
+ * @param f the stream to be written to.
+ */
+void
+finish_tar(FILE* f);
+#endif /* TAR_H */
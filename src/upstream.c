@@ -0,0 +1,724 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-20
+ */
+/*!~ @note fork, fdopen, readlink and socketpair are posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
+#include "upstream.h"
+
+/*! @uses calloc, free, exit. */
+#include <stdlib.h>
+
+/*! @uses SIZE_MAX. */
+#include <stdint.h>
+
+/*! @uses strcmp, strncmp, strlen, strstr, strrchr, strspn, strcspn, strdup. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses stat, mkdir, S_ISSOCK. */
+#include <sys/stat.h>
+
+/*! @uses socket, socketpair, connect, AF_UNIX, SOCK_STREAM. */
+#include <sys/socket.h>
+
+/*! @uses waitpid, WIFEXITED, WEXITSTATUS. */
+#include <sys/wait.h>
+
+/*! @uses sockaddr_un. */
+#include <sys/un.h>
+
+/*! @uses flock, LOCK_SH, LOCK_EX. */
+#include <sys/file.h>
+
+/*! @uses open, O_CREAT, O_RDWR. */
+#include <fcntl.h>
+
+/*! @uses fork, dup, dup2, close, chdir, execl, readlink, getcwd, access, _exit. */
+#include <unistd.h>
+
+/*! @uses shallow_offset, ref_shallow_offset. */
+#include "shallow.h"
+
+/*! @uses branch_t, branch_length, branch_commit, open_history, read_branch_tail, append_ref. */
+#include "branch.h"
+
+/*! @uses read_active_branch_name, index_branch_name. */
+#include "repo.h"
+
+/*! @uses read_commit, free_commit. */
+#include "commit.h"
+
+/*! @uses diff_t. */
+#include "diff.h"
+
+/*! @uses fopen_object, OBJECTS_PATH. */
+#include "alternates.h"
+
+/*! @uses hmap_t, hmap_put, hmap_has. */
+#include "hmap.h"
+
+/*! @uses crc32, strsha1. */
+#include "hash.h"
+
+/*! @uses shcache_get, shcache_put. */
+#include "shcache.h"
+
+/*! @uses read_common_dir, lock_worktrees, find_checked_out. */
+#include "worktree.h"
+
+/*! @uses MKDIR_MOWNER, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * @brief connect to the upstream at a repository path; a process is started in the repository
+ *  that serves the request over a socket pair.
+ *
+ * @param location the path of the upstream repository.
+ * @return the allocated connection, or 0x0 if the upstream could not be reached.
+ */
+upstream_t*
+connect_upstream(const char* location) {
+    /* assert on the location. */
+    assert(location != 0x0);
+
+    /* '<socket>:<repository>' is a repository hosted by a server, the request is prefixed by
+     *  the repository it is for. */
+    struct stat st;
+    char path[1024];
+    const char* colon = strrchr(location, ':');
+    snprintf(path, 1024, "%.*s", colon ? (int) (colon - location) : 0, location);
+    if (colon && stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        struct sockaddr_un address = { .sun_family = AF_UNIX };
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        strncpy(address.sun_path, path, sizeof address.sun_path - 1);
+        if (fd < 0 || connect(fd, (struct sockaddr*) &address, sizeof address) != 0) {
+            llog(E_LOGGER_LEVEL_ERROR, "connect failed; could not reach the server at \'%s\'.\n", \
+                path);
+            if (fd >= 0) close(fd);
+            return 0x0;
+        }
+        upstream_t* upstream = calloc(1, sizeof *upstream);
+        upstream->in = fdopen(fd, "r");
+        upstream->out = fdopen(dup(fd), "w");
+        fprintf(upstream->out, "repository %s\n", colon + 1);
+        return upstream;
+    }
+
+    /* otherwise the upstream has to be a repository. */
+    snprintf(path, 1024, "%s/.lit/index", location);
+    if (stat(path, &st) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "\'%s\' is not a repository.\n", location);
+        return 0x0;
+    }
+
+    /* the same executable serves the request from within the upstream. */
+    char self[1024] = {0};
+    int fds[2];
+    if (readlink("/proc/self/exe", self, sizeof self - 1) <= 0 || \
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "socketpair failed; could not connect to the upstream.\n");
+        return 0x0;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "fork failed; could not start the upstream.\n");
+        close(fds[0]);
+        close(fds[1]);
+        return 0x0;
+    }
+    if (pid == 0) {
+        /* the socket is the stdin of the upstream, its logs still go to our stdout and stderr. */
+        close(fds[0]);
+        dup2(fds[1], STDIN_FILENO);
+        close(fds[1]);
+        if (chdir(location) == 0)
+            execl(self, "lit", "serve-upstream", (char*) 0x0);
+        _exit(127);
+    }
+    close(fds[1]);
+
+    /* one stream for each direction of the socket. */
+    upstream_t* upstream = calloc(1, sizeof *upstream);
+    upstream->in = fdopen(fds[0], "r");
+    upstream->out = fdopen(dup(fds[0]), "w");
+    upstream->pid = pid;
+    return upstream;
+}
+
+/**
+ * @brief close a connection to an upstream, and wait for the process serving it.
+ *
+ * @param upstream the connection to be closed.
+ * @return true if the upstream served the request successfully.
+ */
+bool
+close_upstream(upstream_t* upstream) {
+    /* assert on the upstream. */
+    assert(upstream != 0x0);
+    fclose(upstream->out);
+    fclose(upstream->in);
+    int status = 0;
+    bool served = true;
+    if (upstream->pid > 0)
+        served = waitpid(upstream->pid, &status, 0) == upstream->pid && WIFEXITED(status) && \
+            WEXITSTATUS(status) == 0;
+    free(upstream);
+    return served;
+}
+
+/**
+ * a data structure for a have of the other side; a commit of its branch and its index in the
+ *  complete history.
+ */
+typedef struct {
+    size_t idx; /* index of the commit in the complete history. */
+    char hash[41]; /* hash string of the commit. */
+} have_t;
+
+/**
+ * @brief check if a branch ref exists in the repository in our cwd.
+ *
+ * @param name the name of the branch.
+ * @return true if the ref exists.
+ */
+internal bool
+has_ref(const char* name) {
+    char path[256];
+    snprintf(path, 256, ".lit/refs/heads/%s", name);
+    return access(path, F_OK) == 0;
+}
+
+/**
+ * @brief free an array of allocated strings.
+ *
+ * @param array the array.
+ */
+internal void
+free_strings(dyna_t* array) {
+    _foreach(array, char*, string)
+        free(string);
+    _endforeach;
+    dyna_free(array);
+}
+
+/**
+ * @brief write an object of the local (or an alternate) store to the pack, prefixed by its path
+ *  within the store, its size and its crc32.
+ *
+ * @param out the stream to write the pack to.
+ * @param path the path of the object ('.lit/objects/...').
+ * @return true if the object was written.
+ */
+internal bool
+write_object(FILE* out, const char* path) {
+    /* objects never change, so the shared cache (of a server) is keyed by the absolute path. */
+    char key[1024], cwd[512];
+    snprintf(key, 1024, "%s/%s", getcwd(cwd, sizeof cwd) ? cwd : ".", path);
+    size_t size = 0;
+    unsigned char* data = shcache_get(key, &size);
+
+    /* otherwise read the whole object. */
+    if (!data) {
+        FILE* f = fopen_object(path);
+        if (!f)
+            return false;
+        fseek(f, 0, SEEK_END);
+        size = (size_t) ftell(f);
+        fseek(f, 0, SEEK_SET);
+        data = calloc(1, size + 1);
+        bool read = fread(data, 1, size, f) == size;
+        fclose(f);
+        if (!read) {
+            free(data);
+            return false;
+        }
+        shcache_put(key, data, size);
+    }
+
+    /* then the header, and the bytes as they are. */
+    fprintf(out, "object %s %lu %u\n", path + strlen(OBJECTS_PATH "/"), size, \
+        crc32(data, (unsigned long) size));
+    fwrite(data, 1, size, out);
+    free(data);
+    return true;
+}
+
+/**
+ * @brief read an object from the pack, and write it into the local store unless one of the stores
+ *  already holds it.
+ *
+ * @param in the stream to read the pack from.
+ * @param name the path of the object within the store.
+ * @param size the size of the object.
+ * @param crc the crc32 of the object.
+ * @return true if the object was read intact.
+ */
+internal bool
+read_object(FILE* in, const char* name, size_t size, ucrc32_t crc) {
+    /* only commits and diffs are ever sent, and never outside of the store. */
+    if ((strncmp(name, "commits/", 8) && strncmp(name, "diffs/", 6)) || strstr(name, ".."))
+        return false;
+    unsigned char* data = calloc(1, size + 1);
+    if (fread(data, 1, size, in) != size || crc32(data, (unsigned long) size) != crc) {
+        free(data);
+        return false;
+    }
+
+    /* write it through a temporary file, so that a reader never sees a partial object. */
+    char path[512], temporary[520];
+    snprintf(path, 512, OBJECTS_PATH "/%s", name);
+    FILE* f = fopen_object(path);
+    if (f) {
+        fclose(f);
+        free(data);
+        return true;
+    }
+    char* slash = strrchr(path, '/');
+    *slash = '\0';
+    mkdir(path, MKDIR_MOWNER);
+    *slash = '/';
+    snprintf(temporary, 520, "%s.tmp", path);
+    f = fopen(temporary, "wb");
+    bool written = f && fwrite(data, 1, size, f) == size;
+    if (f) fclose(f);
+    written = written && rename(temporary, path) == 0;
+    free(data);
+    return written;
+}
+
+/**
+ * @brief write a pack; the commits after the ones the other side has, each followed by the
+ *  objects of its diffs that were not written yet.
+ *
+ * @param out the stream to write the pack to.
+ * @param hashes the hash strings of the commits to be sent, oldest first.
+ * @param common the number of commits of the complete history the other side has.
+ * @param length the number of commits of the complete history.
+ * @param sent pointer to store the number of commits sent.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the pack is incomplete (if it is).
+ * @return true if the pack was written.
+ */
+internal bool
+write_pack(FILE* out, dyna_t* hashes, size_t common, size_t length, size_t* sent, char* reason) {
+    *sent = 0;
+    fprintf(out, "common %lu %lu\n", common, length);
+    hmap_t* written = hmap_create();
+    bool complete = true;
+    _foreach(hashes, const char*, hash)
+        char path[256];
+        snprintf(path, 256, OBJECTS_PATH "/commits/%.2s/%.38s", hash, hash + 2);
+        fprintf(out, "commit %s\n", hash);
+        if (!(complete = write_object(out, path)))
+            break;
+        commit_t* commit = read_commit(path);
+        _foreach(commit->changes, const diff_t*, change)
+            char name[16], object[256];
+            snprintf(name, 16, "%04u", change->crc);
+            snprintf(object, 256, OBJECTS_PATH "/diffs/%.2s/%s", name, name + 2);
+            if (!complete || hmap_has(written, object)) continue;
+            hmap_put(written, object, 0x0);
+            complete = write_object(out, object);
+        _endforeach;
+        free_commit(commit);
+        (*sent)++;
+    _endforeach;
+    hmap_free(written);
+    fprintf(out, complete ? "end\n" : "abort\n");
+    fflush(out);
+    if (!complete)
+        snprintf(reason, UPSTREAM_REASON_SIZE, "an object could not be read.");
+    return complete;
+}
+
+/**
+ * @brief send a branch to the other side; the haves of the other side are read to find the
+ *  commits they share, then only the commits after them (and their diffs) are written as one
+ *  packed stream. the history is walked newest first straight from the refs, down to the newest
+ *  commit they share, so only the commits that are sent are read.
+ *
+ * @param in the stream to read the haves from.
+ * @param out the stream to write the pack to.
+ * @param name the name of the branch to be sent (its ref may not exist on this side).
+ * @param sent pointer to store the number of commits sent.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why nothing was sent (if it was not).
+ * @return true if the other side is up to date or the pack was written.
+ */
+bool
+send_branch(FILE* in, FILE* out, const char* name, size_t* sent, char* reason) {
+    /* assert on the streams, the name, the count and the reason. */
+    assert(in != 0x0 && out != 0x0);
+    assert(name != 0x0);
+    assert(sent != 0x0 && reason != 0x0);
+    *sent = 0;
+
+    /* every have first (there are only a few, spaced out exponentially), and the lowest index. */
+    dyna_t* haves = dyna_create();
+    size_t their_length = 0, lowest = SIZE_MAX;
+    bool done = false;
+    char line[256];
+    while (!done && fgets(line, sizeof line, in)) {
+        have_t have = {0};
+        if (sscanf(line, "have %lu %40s", &have.idx, have.hash) == 2) {
+            have_t* _have = calloc(1, sizeof *_have);
+            *_have = have;
+            dyna_push(haves, _have);
+            if (have.idx < lowest) lowest = have.idx;
+        }
+        else if (sscanf(line, "done %lu", &their_length) == 1)
+            done = true;
+        else if (!strncmp(line, "reject ", 7)) {
+            snprintf(reason, UPSTREAM_REASON_SIZE, "%s", line + 7);
+            reason[strcspn(reason, "\n")] = '\0';
+            free_strings(haves);
+            return false;
+        }
+    }
+    if (!done) {
+        snprintf(reason, UPSTREAM_REASON_SIZE, "the connection was closed during negotiation.");
+        free_strings(haves);
+        return false;
+    }
+
+    /* the last commit we share is the newest have that is at the same index on our side; the
+     *  indices are those of the complete history, which a shallow branch starts <offset> into.
+     *  the commits after it are kept (newest first), they are the ones sent; below the oldest
+     *  have nothing can be shared, and the branch is rejected anyway. */
+    bool exists = has_ref(name);
+    size_t offset = exists ? ref_shallow_offset(name) : 0;
+    history_t* history = exists ? open_history(name, 0) : 0x0;
+    size_t length = history ? history->length + offset : 0, i = 0;
+    long shared = -1;
+    dyna_t* after = dyna_create();
+    for (const char* hash; history && shared < 0 && (hash = next_history(history, &i));) {
+        size_t idx = i + offset;
+        _foreach(haves, const have_t*, have)
+            if (have->idx == idx && (offset == 0 || idx > offset) && !strcmp(have->hash, hash))
+                shared = (long) idx;
+        _endforeach;
+        if (shared >= 0 || (haves->length > 0 && idx <= lowest))
+            break;
+        dyna_push(after, strdup(hash));
+    }
+    if (history) close_history(history);
+    free_strings(haves);
+
+    /* only a fast-forward is sent, the other side cannot have commits that we do not. */
+    size_t common = (size_t) (shared + 1);
+    if (!exists)
+        snprintf(reason, UPSTREAM_REASON_SIZE, "the branch does not exist.");
+    else if (common < their_length)
+        snprintf(reason, UPSTREAM_REASON_SIZE, "not a fast-forward, %lu commit(s) are " \
+            "not on the sending side.", their_length - common);
+    else if (offset > 0 && common <= offset)
+        snprintf(reason, UPSTREAM_REASON_SIZE, "the history before the shallow boundary " \
+            "(%lu commit(s)) is not on the sending side.", offset + 1);
+    if (!exists || common < their_length || (offset > 0 && common <= offset)) {
+        fprintf(out, "reject %s\n", reason);
+        fflush(out);
+        free_strings(after);
+        return false;
+    }
+
+    /* then the pack, oldest first. */
+    dyna_t* hashes = dyna_create();
+    for (size_t k = after->length; k > 0; k--)
+        dyna_push(hashes, dyna_get(after, k - 1));
+    dyna_free(after);
+    bool written = write_pack(out, hashes, common, length, sent, reason);
+    free_strings(hashes);
+    return written;
+}
+
+/**
+ * @brief write the pack of a branch; every commit after the ones the other side has, each
+ *  followed by the objects of its diffs that were not written yet.
+ *
+ * @param out the stream to write the pack to.
+ * @param branch the branch to be sent.
+ * @param common the number of commits of the complete history the other side has.
+ * @param sent pointer to store the number of commits sent.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the pack is incomplete (if it is).
+ * @return true if the pack was written.
+ */
+bool
+send_pack(FILE* out, const branch_t* branch, size_t common, size_t* sent, char* reason) {
+    /* assert on the stream, the branch, the count and the reason. */
+    assert(out != 0x0 && branch != 0x0);
+    assert(sent != 0x0 && reason != 0x0);
+    size_t offset = shallow_offset(branch), length = branch_length(branch) + offset;
+    dyna_t* hashes = dyna_create();
+    for (size_t i = common; i < length; i++)
+        dyna_push(hashes, strsha1(branch_commit(branch, i - offset)->hash));
+    bool written = write_pack(out, hashes, common, length, sent, reason);
+    free_strings(hashes);
+    return written;
+}
+
+/**
+ * @brief receive a branch from the other side; the haves of this side are written (spaced out
+ *  exponentially from the tip, walking the refs newest first), then the pack is read, the missing
+ *  objects are written and the hashes of the commits are appended to the ref of the branch (which
+ *  is created if it does not exist).
+ *
+ * @param in the stream to read the pack from.
+ * @param out the stream to write the haves to.
+ * @param name the name of the branch.
+ * @param move_head if the head is moved to the new tip (only if it was at the old tip).
+ * @param result pointer to store how far the branch moved.
+ * @return true if the branch was received (or was already up to date).
+ */
+bool
+receive_branch(FILE* in, FILE* out, const char* name, bool move_head, received_t* result) {
+    /* assert on the streams, the name and the result. */
+    assert(in != 0x0 && out != 0x0);
+    assert(name != 0x0);
+    assert(result != 0x0);
+
+    /* the haves; the tip, then every commit 1, 2, 4, ... before it, down to the first one. the
+     *  synthetic base of a shallow branch is never had by the other side. */
+    size_t offset = ref_shallow_offset(name), length = 0;
+    history_t* history = has_ref(name) ? open_history(name, 0) : 0x0;
+    if (history) {
+        length = history->length;
+        size_t idx = length, step = 1, i = length;
+        while (idx > (offset > 0 ? 1 : 0)) {
+            idx = idx > step ? idx - step : 0;
+            if (offset > 0 && idx == 0) break;
+            const char* hash = 0x0;
+            while (i > idx && (hash = next_history(history, &i)) && i > idx);
+            if (!hash || i != idx) break;
+            fprintf(out, "have %lu %s\n", idx + offset, hash);
+            if (idx + 1 < length) step *= 2;
+        }
+        close_history(history);
+    }
+    fprintf(out, "done %lu\n", length + offset);
+    fflush(out);
+    return receive_pack(in, name, move_head, result);
+}
+
+/**
+ * @brief read the pack of a branch; the missing objects are written, then the hashes of the
+ *  commits are appended to the ref of the branch (which is created if it does not exist). the
+ *  pack has to start right after the last commit of the branch.
+ *
+ * @param in the stream to read the pack from.
+ * @param name the name of the branch.
+ * @param move_head if the head is moved to the new tip (only if it was at the old tip).
+ * @param result pointer to store how far the branch moved.
+ * @return true if the branch was received.
+ */
+bool
+receive_pack(FILE* in, const char* name, bool move_head, received_t* result) {
+    /* assert on the stream, the name and the result. */
+    assert(in != 0x0);
+    assert(name != 0x0);
+    assert(result != 0x0);
+    memset(result, 0, sizeof *result);
+
+    /* only the length and the head of the branch, none of its hashes. */
+    bool exists = has_ref(name);
+    size_t length = 0, head = 0, offset = ref_shallow_offset(name);
+    if (exists) {
+        branch_tail_t* tail = read_branch_tail(name, 0, 0);
+        length = tail->length;
+        head = tail->head;
+        free_branch_tail(tail);
+    }
+
+    /* the reply; where the commits start, or why they will not be sent. */
+    char line[512] = {0};
+    size_t common = 0, their_length = 0;
+    if (!fgets(line, sizeof line, in) || !strncmp(line, "reject ", 7) || \
+        sscanf(line, "common %lu %lu", &common, &their_length) != 2 || common != length + offset) {
+        snprintf(result->reason, UPSTREAM_REASON_SIZE, "%s", !strncmp(line, "reject ", 7) ? \
+            line + 7 : "the negotiation failed.");
+        result->reason[strcspn(result->reason, "\n")] = '\0';
+        return false;
+    }
+
+    /* read the pack, writing each object that is missing; the hashes go into the ref as they
+     *  are, so each has to name a commit that is now in one of the stores. */
+    dyna_t* hashes = dyna_create();
+    bool complete = false;
+    while (fgets(line, sizeof line, in)) {
+        char object[257] = {0};
+        size_t size = 0;
+        ucrc32_t crc = 0;
+        if (!strncmp(line, "commit ", 7)) {
+            line[strcspn(line, "\n")] = '\0';
+            dyna_push(hashes, strdup(line + 7));
+        }
+        else if (sscanf(line, "object %256s %lu %u", object, &size, &crc) == 3) {
+            if (!read_object(in, object, size, crc)) break;
+        }
+        else {
+            complete = !strcmp(line, "end\n");
+            break;
+        }
+    }
+    _foreach(hashes, const char*, hash)
+        char path[256];
+        snprintf(path, 256, OBJECTS_PATH "/commits/%.2s/%.38s", hash, hash + 2);
+        FILE* f = strlen(hash) == 40 && strspn(hash, "0123456789abcdef") == 40 ? \
+            fopen_object(path) : 0x0;
+        if (f) fclose(f);
+        complete = complete && f != 0x0;
+    _endforeach;
+    if (!complete || hashes->length != their_length - common) {
+        snprintf(result->reason, UPSTREAM_REASON_SIZE, "the pack was incomplete or corrupt.");
+        free_strings(hashes);
+        return false;
+    }
+
+    /* the head only follows the tip if it was at the old one (and the caller wants it to). */
+    result->created = !exists;
+    result->old_length = length;
+    result->old_head = head;
+    result->received = hashes->length;
+    if (move_head && (length == 0 || head == length - 1) && result->received > 0) {
+        head = length + result->received - 1;
+        result->moved = true;
+    }
+
+    /* append the hashes to the ref, creating it (and adding it to the index) if needed. */
+    if (result->received > 0 || result->created)
+        append_ref(name, hashes, head);
+    if (result->created)
+        index_branch_name(name);
+    free_strings(hashes);
+    return true;
+}
+
+/*!~ @note the descriptor of the lock once it has been taken (it is never closed). */
+internal int upstream_lock = -1;
+
+/**
+ * @brief take the lock on the repository in our cwd for serving a request; shared while sending,
+ *  exclusive while receiving. it is held until the process exits, and taking it again only
+ *  changes its mode.
+ *
+ * @param exclusive if the lock is exclusive.
+ */
+void
+lock_upstream(bool exclusive) {
+    /* every worktree locks the shared '.lit', the same descriptor is kept for the process (a
+     *  second descriptor would wait on the first). */
+    if (upstream_lock < 0) {
+        char* common = read_common_dir(), path[512];
+        snprintf(path, 512, "%s/" UPSTREAM_LOCK_NAME, common ? common : ".lit");
+        free(common);
+        upstream_lock = open(path, O_CREAT | O_RDWR, 0644);
+    }
+    if (upstream_lock < 0 || flock(upstream_lock, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "flock failed; could not lock the repository.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief serve a single upstream request of another repository in our cwd; read the request, lock
+ *  the repository, then send or receive the branch straight from its ref (no branch is read).
+ *
+ * @param in the stream to read the request from.
+ * @param out the stream to write the replies to.
+ * @param bare if the repository is only hosted (the head of every branch follows its tip, and no
+ *  branch is checked out).
+ * @param request pointer to store the request that was served.
+ * @return true if the request was served successfully.
+ */
+bool
+serve_upstream(FILE* in, FILE* out, bool bare, request_t* request) {
+    /* assert on the streams and the request. */
+    assert(in != 0x0 && out != 0x0);
+    assert(request != 0x0);
+    memset(request, 0, sizeof *request);
+
+    /* the request, and the branch it is for. */
+    char line[512];
+    if (!fgets(line, sizeof line, in) || sscanf(line, UPSTREAM_PROTOCOL " %15s %128[^\n]", \
+        request->request, request->branch) != 2) {
+        llog(E_LOGGER_LEVEL_ERROR, "malformed upstream request.\n");
+        return false;
+    }
+    bool upload = !strcmp(request->request, "upload");
+    if (!upload && strcmp(request->request, "receive")) {
+        llog(E_LOGGER_LEVEL_ERROR, "unknown upstream request \'%s\'.\n", request->request);
+        return false;
+    }
+
+    /* any number of requests send at once, but only one receives (and nothing sends meanwhile). */
+    lock_upstream(!upload);
+
+    /* sending never changes the repository. */
+    if (upload) {
+        char reason[UPSTREAM_REASON_SIZE] = {0};
+        return send_branch(in, out, request->branch, &request->commits, reason);
+    }
+
+    /* a read-only repository rejects before the negotiation, so nothing is sent. */
+    bool readonly = false;
+    char* active = read_active_branch_name(&readonly);
+    if (readonly) {
+        fprintf(out, "reject the upstream is read-only.\n");
+        fflush(out);
+        free(active);
+        return false;
+    }
+
+    /* the working tree of the upstream is never touched, so a branch checked out in it (or in
+     *  any of its worktrees) is refused; its head and working tree would be left behind, and the
+     *  next commit there would undo what was received. */
+    char* where = 0x0;
+    if (!bare) {
+        lock_worktrees();
+        where = find_checked_out(request->branch);
+    }
+    if (!bare && (!strcmp(active, request->branch) || where)) {
+        fprintf(out, "reject the branch is checked out.\n");
+        fflush(out);
+        free(where);
+        free(active);
+        return false;
+    }
+    free(active);
+    received_t result;
+    bool received = receive_branch(in, out, request->branch, true, &result);
+    if (received)
+        fprintf(out, "ok %lu %d\n", result.received, result.moved ? 1 : 0);
+    else
+        fprintf(out, "reject %s\n", result.reason);
+    fflush(out);
+    request->commits = result.received;
+    return received;
+}
+
+/**
+ * @brief serve a single upstream request of another repository in our cwd over a socket; the
+ *  requests are read from and the replies written to the same descriptor, which is closed
+ *  afterwards.
+ *
+ * @param fd the descriptor of the socket.
+ * @return true if the request was served successfully.
+ */
+bool
+serve_upstream_fd(int fd) {
+    /* one stream for each direction of the socket. */
+    FILE* in = fdopen(fd, "r"), *out = fdopen(dup(fd), "w");
+    if (!in || !out) {
+        llog(E_LOGGER_LEVEL_ERROR, "fdopen failed; could not open the upstream streams.\n");
+        if (in) fclose(in);
+        return false;
+    }
+    request_t request;
+    bool served = serve_upstream(in, out, false, &request);
+    fclose(out);
+    fclose(in);
+    return served;
+}
@@ -0,0 +1,175 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-20
+ */
+#ifndef UPSTREAM_H
+#define UPSTREAM_H
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses pid_t. */
+#include <sys/types.h>
+
+/*! @uses branch_t. */
+#include "branch.h"
+
+/*!~ @note the first line of every upstream request, followed by the request ('upload' to fetch a
+ *  branch from the upstream, 'receive' to send one to it) and the name of the branch. */
+#define UPSTREAM_PROTOCOL "lit-upstream 1"
+
+/*!~ @note the size of the reason given when either side rejects a request. */
+#define UPSTREAM_REASON_SIZE 256
+
+/*!~ @note the lock on a repository taken while serving a request (shared while sending), and
+ *  while a worktree writes the shared index; it is in '.lit', or the shared '.lit' of a worktree. */
+#define UPSTREAM_LOCK_NAME "upstream.lock"
+
+/**
+ * a data structure for a connection to an upstream; the streams to read its replies from and to
+ *  write requests to, and the process serving it (for an upstream that is a repository path).
+ */
+typedef struct {
+    FILE* in, *out; /* streams from and to the upstream. */
+    pid_t pid; /* process serving the upstream (0 for a server). */
+} upstream_t;
+
+/**
+ * a data structure for an upstream request that was served; what was requested, for which branch,
+ *  and how many commits were sent or received.
+ */
+typedef struct {
+    char request[16]; /* 'upload' or 'receive'. */
+    char branch[129]; /* name of the branch. */
+    size_t commits; /* number of commits sent or received. */
+} request_t;
+
+/**
+ * a data structure for the result of receiving a branch; how far the branch moved.
+ */
+typedef struct {
+    size_t received; /* number of commits received. */
+    size_t old_length, old_head; /* length and head of the branch before receiving. */
+    bool created; /* if the branch did not exist before receiving. */
+    bool moved; /* if the head was moved to the new tip. */
+    char reason[UPSTREAM_REASON_SIZE]; /* why the branch was not received (if it was not). */
+} received_t;
+
+/**
+ * @brief take the lock on the repository in our cwd for serving a request; shared while sending,
+ *  exclusive while receiving. it is held until the process exits, and taking it again only
+ *  changes its mode.
+ *
+ * @param exclusive if the lock is exclusive.
+ */
+void
+lock_upstream(bool exclusive);
+
+/**
+ * @brief connect to the upstream at a repository path; a process is started in the repository
+ *  that serves the request over a socket pair. '<socket>:<repository>' connects to a repository
+ *  hosted by a server instead.
+ *
+ * @param location the path of the upstream repository (or its server socket and name).
+ * @return the allocated connection, or 0x0 if the upstream could not be reached.
+ */
+upstream_t*
+connect_upstream(const char* location);
+
+/**
+ * @brief close a connection to an upstream, and wait for the process serving it.
+ *
+ * @param upstream the connection to be closed.
+ * @return true if the upstream served the request successfully.
+ */
+bool
+close_upstream(upstream_t* upstream);
+
+/**
+ * @brief send a branch to the other side; the haves of the other side are read to find the
+ *  commits they share, then only the commits after them (and their diffs) are written as one
+ *  packed stream. the history is walked newest first straight from the refs, down to the newest
+ *  commit they share, so only the commits that are sent are read.
+ *
+ * @param in the stream to read the haves from.
+ * @param out the stream to write the pack to.
+ * @param name the name of the branch to be sent (its ref may not exist on this side).
+ * @param sent pointer to store the number of commits sent.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why nothing was sent (if it was not).
+ * @return true if the other side is up to date or the pack was written.
+ */
+bool
+send_branch(FILE* in, FILE* out, const char* name, size_t* sent, char* reason);
+
+/**
+ * @brief write the pack of a branch; every commit after the ones the other side has, each
+ *  followed by the objects of its diffs that were not written yet.
+ *
+ * @param out the stream to write the pack to.
+ * @param branch the branch to be sent.
+ * @param common the number of commits of the complete history the other side has.
+ * @param sent pointer to store the number of commits sent.
+ * @param reason buffer of UPSTREAM_REASON_SIZE to store why the pack is incomplete (if it is).
+ * @return true if the pack was written.
+ */
+bool
+send_pack(FILE* out, const branch_t* branch, size_t common, size_t* sent, char* reason);
+
+/**
+ * @brief receive a branch from the other side; the haves of this side are written (spaced out
+ *  exponentially from the tip, walking the refs newest first), then the pack is read, the missing
+ *  objects are written and the hashes of the commits are appended to the ref of the branch (which
+ *  is created if it does not exist).
+ *
+ * @param in the stream to read the pack from.
+ * @param out the stream to write the haves to.
+ * @param name the name of the branch.
+ * @param move_head if the head is moved to the new tip (only if it was at the old tip).
+ * @param result pointer to store how far the branch moved.
+ * @return true if the branch was received (or was already up to date).
+ */
+bool
+receive_branch(FILE* in, FILE* out, const char* name, bool move_head, received_t* result);
+
+/**
+ * @brief read the pack of a branch; the missing objects are written, then the hashes of the
+ *  commits are appended to the ref of the branch (which is created if it does not exist). the
+ *  pack has to start right after the last commit of the branch.
+ *
+ * @param in the stream to read the pack from.
+ * @param name the name of the branch.
+ * @param move_head if the head is moved to the new tip (only if it was at the old tip).
+ * @param result pointer to store how far the branch moved.
+ * @return true if the branch was received.
+ */
+bool
+receive_pack(FILE* in, const char* name, bool move_head, received_t* result);
+
+/**
+ * @brief serve a single upstream request of another repository in our cwd; read the request, lock
+ *  the repository, then send or receive the branch straight from its ref (no branch is read).
+ *
+ * @param in the stream to read the request from.
+ * @param out the stream to write the replies to.
+ * @param bare if the repository is only hosted (the head of every branch follows its tip, and no
+ *  branch is checked out).
+ * @param request pointer to store the request that was served.
+ * @return true if the request was served successfully.
+ */
+bool
+serve_upstream(FILE* in, FILE* out, bool bare, request_t* request);
+
+/**
+ * @brief serve a single upstream request of another repository in our cwd over a socket; the
+ *  requests are read from and the replies written to the same descriptor, which is closed
+ *  afterwards.
+ *
+ * @param fd the descriptor of the socket.
+ * @return true if the request was served successfully.
+ */
+bool
+serve_upstream_fd(int fd);
+#endif /* UPSTREAM_H */
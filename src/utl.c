@@ -238,15 +238,16 @@ freadls(FILE* fptr, size_t* size) {
         if (i >= j) {
             /* realloc if required. */
             char** _temp = realloc(data, sizeof(char*) * (j + 1024ul));
-            if (!data) {
+            if (!_temp) {
                 llog(E_LOGGER_LEVEL_ERROR,"realloc failed; could not allocate memory for file data.\n");
                 exit(-1);
             }
             data = _temp;
+            j += 1024ul;
         }
 
         /* append to our data. */
-        data[i] = calloc(1, len);
+        data[i] = calloc(1, len + 1);
         strncpy(data[i], buffer, len);
         i++;
     }
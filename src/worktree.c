@@ -0,0 +1,280 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-18
+ */
+/*!~ @note realpath and symlink are posix, and hidden by -std=c17 otherwise. */
+#define _DEFAULT_SOURCE
+#include "worktree.h"
+
+/*! @uses fopen, fprintf, fclose, snprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, free, realpath. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strlen, strrchr. */
+#include <string.h>
+
+/*! @uses assert. */
+#include <assert.h>
+
+/*! @uses mkdir. */
+#include <sys/stat.h>
+
+/*! @uses flock, LOCK_EX. */
+#include <sys/file.h>
+
+/*! @uses open, O_CREAT, O_RDWR. */
+#include <fcntl.h>
+
+/*! @uses symlink, access. */
+#include <unistd.h>
+
+/*! @uses opendir, readdir, closedir. */
+#include <dirent.h>
+
+/*! @uses branch_t. */
+#include "branch.h"
+
+/*! @uses read_active_branch_name_at. */
+#include "repo.h"
+
+/*! @uses freadls, fexistpd, MKDIR_MOWNER, internal. */
+#include "utl.h"
+
+/*! @uses llog, E_LOGGER_LEVEL_ERROR. */
+#include "log.h"
+
+/**
+ * @brief read the shared '.lit' directory of the worktree in our cwd.
+ *
+ * @return the allocated absolute path of the shared '.lit', or 0x0 if the cwd is not a worktree
+ *  (it is the repository itself).
+ */
+char*
+read_common_dir() {
+    FILE* f = fopen(WORKTREE_POINTER_PATH, "r");
+    if (!f)
+        return 0x0;
+    size_t n = 0;
+    char** lines = freadls(f, &n);
+    fclose(f);
+    if (!lines || n == 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "could not read the shared repository of this worktree.\n");
+        exit(EXIT_FAILURE);
+    }
+    char* common = lines[0];
+    for (size_t i = 1; i < n; i++)
+        free(lines[i]);
+    free(lines);
+    return common;
+}
+
+/**
+ * @brief get the shared '.lit' directory, of the worktree or the repository in our cwd.
+ *
+ * @return the allocated absolute path of the shared '.lit'.
+ */
+internal char*
+common_dir() {
+    char* common = read_common_dir();
+    if (common)
+        return common;
+    common = realpath(".lit", 0x0);
+    if (!common) {
+        llog(E_LOGGER_LEVEL_ERROR, "realpath failed; could not resolve the \'.lit\' directory.\n");
+        exit(EXIT_FAILURE);
+    }
+    return common;
+}
+
+/**
+ * @brief take the exclusive lock on checking out branches across every worktree of the
+ *  repository; it is held until the process exits.
+ */
+void
+lock_worktrees() {
+    char* common = common_dir(), path[512];
+    snprintf(path, 512, "%s/%s", common, WORKTREE_LOCK);
+    free(common);
+    int fd = open(path, O_CREAT | O_RDWR, 0644);
+    if (fd < 0 || flock(fd, LOCK_EX) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "flock failed; could not lock the worktrees.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief read the active branch of the worktree at a root.
+ *
+ * @param root the root of the worktree.
+ * @return the allocated worktree, or 0x0 if it has been removed.
+ */
+internal worktree_t*
+read_worktree(const char* root) {
+    char path[512];
+    snprintf(path, 512, "%s/.lit/index", root);
+    if (access(path, R_OK) != 0)
+        return 0x0;
+    worktree_t* worktree = calloc(1, sizeof *worktree);
+    bool readonly = false;
+    worktree->root = strdup(root);
+    worktree->branch = read_active_branch_name_at(path, &readonly);
+    return worktree;
+}
+
+/**
+ * @brief read every worktree of the repository (the repository itself first), skipping the ones
+ *  whose root has been removed.
+ *
+ * @return a dynamic array of allocated worktree_t.
+ */
+dyna_t*
+read_worktrees() {
+    /* the root of the repository is the parent of its '.lit'. */
+    dyna_t* worktrees = dyna_create();
+    char* common = common_dir(), path[512];
+    *strrchr(common, '/') = '\0';
+    worktree_t* main = read_worktree(common);
+    if (main) dyna_push(worktrees, main);
+
+    /* then every registered worktree. */
+    snprintf(path, 512, "%s/.lit/%s", common, WORKTREE_REGISTRY);
+    free(common);
+    DIR* dir = opendir(path);
+    if (!dir)
+        return worktrees;
+    for (struct dirent* entry; (entry = readdir(dir));) {
+        if (entry->d_name[0] == '.') continue;
+        char file[1024];
+        snprintf(file, 1024, "%s/%s", path, entry->d_name);
+        FILE* f = fopen(file, "r");
+        if (!f) continue;
+        size_t n = 0;
+        char** lines = freadls(f, &n);
+        fclose(f);
+        worktree_t* worktree = n > 0 ? read_worktree(lines[0]) : 0x0;
+        if (worktree) dyna_push(worktrees, worktree);
+        if (lines) ffreels(lines, n);
+    }
+    closedir(dir);
+    return worktrees;
+}
+
+/**
+ * @brief free a worktree returned by @ref read_worktrees().
+ *
+ * @param worktree the worktree to be freed.
+ */
+void
+free_worktree(worktree_t* worktree) {
+    /* assert on the worktree. */
+    assert(worktree != 0x0);
+    free(worktree->root);
+    free(worktree->branch);
+    free(worktree);
+}
+
+/**
+ * @brief find the root of another worktree (not the one in our cwd) that has a branch checked out.
+ *
+ * @param branch_name the name of the branch.
+ * @return the allocated root of the worktree, or 0x0 if no other worktree has the branch.
+ */
+char*
+find_checked_out(const char* branch_name) {
+    /* assert on the branch name. */
+    assert(branch_name != 0x0);
+    char* self = realpath(".", 0x0), *found = 0x0;
+    dyna_t* worktrees = read_worktrees();
+    _foreach(worktrees, worktree_t*, worktree)
+        char* root = realpath(worktree->root, 0x0);
+        if (!found && root && strcmp(root, self) && !strcmp(worktree->branch, branch_name))
+            found = strdup(worktree->root);
+        free(root);
+        free_worktree(worktree);
+    _endforeach;
+    dyna_free(worktrees);
+    free(self);
+    return found;
+}
+
+/**
+ * @brief create a worktree at an empty directory sharing the objects and refs of the repository
+ *  in our cwd, with its own index (active branch) and shelf; the working tree is written at the
+ *  head of the branch.
+ *
+ * @param root the root directory of the worktree (created if it does not exist).
+ * @param branches the array of branches of the repository.
+ * @param idx the index of the branch to be checked out in the worktree.
+ * @return true if the worktree was created.
+ */
+bool
+create_worktree(const char* root, dyna_t* branches, size_t idx) {
+    /* assert on the root and the branches. */
+    assert(root != 0x0);
+    assert(branches != 0x0);
+
+    /* the objects and refs are shared, everything else in '.lit' belongs to the worktree. */
+    char* common = common_dir(), path[1024], target[1024];
+    snprintf(path, 1024, "%s/.lit", root);
+    if (mkdir(path, MKDIR_MOWNER) != 0) {
+        llog(E_LOGGER_LEVEL_ERROR, "mkdir failed; could not create \'%s\'.\n", path);
+        free(common);
+        return false;
+    }
+    snprintf(path, 1024, "%s/%s", root, WORKTREE_POINTER_PATH);
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not write \'%s\'.\n", path);
+        free(common);
+        return false;
+    }
+    fprintf(f, "%s\n", common);
+    fclose(f);
+    const char* shared[] = { "objects", "refs" };
+    for (size_t i = 0; i < 2; i++) {
+        snprintf(path, 1024, "%s/.lit/%s", root, shared[i]);
+        snprintf(target, 1024, "%s/%s", common, shared[i]);
+        if (symlink(target, path) != 0) {
+            llog(E_LOGGER_LEVEL_ERROR, "symlink failed; could not share \'%s\'.\n", target);
+            free(common);
+            return false;
+        }
+    }
+
+    /* the index of the worktree, with the branch checked out. */
+    snprintf(path, 1024, "%s/.lit/index", root);
+    f = fopen(path, "w");
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not open index file for writing.\n");
+        free(common);
+        return false;
+    }
+    fprintf(f, "active:%lu\ncount:%lu\nreadonly:0\n", idx, branches->length);
+    _foreach_it(branches, const branch_t*, branch, i)
+        fprintf(f, "%lu:%s\n", i, branch->name);
+    _endforeach;
+    fclose(f);
+
+    /* register it with the repository, under the first free name. */
+    char* absolute = realpath(root, 0x0);
+    const char* name = strrchr(absolute, '/') ? strrchr(absolute, '/') + 1 : absolute;
+    snprintf(path, 1024, "%s/%s", common, WORKTREE_REGISTRY);
+    mkdir(path, MKDIR_MOWNER);
+    snprintf(path, 1024, "%s/%s/%s", common, WORKTREE_REGISTRY, name);
+    for (size_t i = 1; access(path, F_OK) == 0; i++)
+        snprintf(path, 1024, "%s/%s/%s-%lu", common, WORKTREE_REGISTRY, name, i);
+    f = fopen(path, "w");
+    if (!f) {
+        llog(E_LOGGER_LEVEL_ERROR, "fopen failed; could not register the worktree.\n");
+        free(absolute);
+        free(common);
+        return false;
+    }
+    fprintf(f, "%s\n", absolute);
+    fclose(f);
+    free(absolute);
+    free(common);
+    return true;
+}
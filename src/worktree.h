@@ -0,0 +1,85 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-01-18
+ */
+#ifndef WORKTREE_H
+#define WORKTREE_H
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses dyna_t. */
+#include "dyna.h"
+
+/*!~ @note the pointer file of a worktree, holding the absolute path of the '.lit' directory of
+ *  the repository it shares its objects and refs with. */
+#define WORKTREE_POINTER_PATH ".lit/commondir"
+
+/*!~ @note the directory (within the shared '.lit') where every worktree is registered, one file
+ *  per worktree holding the absolute path of its root, and the lock taken while checking out. */
+#define WORKTREE_REGISTRY "worktrees"
+#define WORKTREE_LOCK "worktrees.lock"
+
+/**
+ * a data structure for a worktree of a repository; its root and its active branch.
+ */
+typedef struct {
+    char* root; /* absolute path of the root of the worktree. */
+    char* branch; /* name of the active branch of the worktree. */
+} worktree_t;
+
+/**
+ * @brief read the shared '.lit' directory of the worktree in our cwd.
+ *
+ * @return the allocated absolute path of the shared '.lit', or 0x0 if the cwd is not a worktree
+ *  (it is the repository itself).
+ */
+char*
+read_common_dir();
+
+/**
+ * @brief take the exclusive lock on checking out branches across every worktree of the
+ *  repository; it is held until the process exits.
+ */
+void
+lock_worktrees();
+
+/**
+ * @brief read every worktree of the repository (the repository itself first), skipping the ones
+ *  whose root has been removed.
+ *
+ * @return a dynamic array of allocated worktree_t.
+ */
+dyna_t*
+read_worktrees();
+
+/**
+ * @brief free a worktree returned by @ref read_worktrees().
+ *
+ * @param worktree the worktree to be freed.
+ */
+void
+free_worktree(worktree_t* worktree);
+
+/**
+ * @brief find the root of another worktree (not the one in our cwd) that has a branch checked out.
+ *
+ * @param branch_name the name of the branch.
+ * @return the allocated root of the worktree, or 0x0 if no other worktree has the branch.
+ */
+char*
+find_checked_out(const char* branch_name);
+
+/**
+ * @brief create a worktree at an empty directory sharing the objects and refs of the repository
+ *  in our cwd, with its own index (active branch) and shelf; the working tree is written at the
+ *  head of the branch.
+ *
+ * @param root the root directory of the worktree (created if it does not exist).
+ * @param branches the array of branches of the repository.
+ * @param idx the index of the branch to be checked out in the worktree.
+ * @return true if the worktree was created.
+ */
+bool
+create_worktree(const char* root, dyna_t* branches, size_t idx);
+#endif /* WORKTREE_H */